@@ -0,0 +1,36 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+// Per instance, locations 2 to 5 hold the columns of the model matrix
+layout(location = 2) in mat4 i_Model;
+layout(location = 6) in vec4 i_Color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+	gl_Position = u_ViewProjection * i_Model * position;
+	v_TexCoord = texCoord;
+	v_Color = i_Color;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * v_Color;
+}
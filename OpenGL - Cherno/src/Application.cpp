@@ -6,24 +6,312 @@
 #include "VertexArray.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "GLStateCache.h"
+#include "GLDebug.h"
+#include "RenderThread.h"
+#include "Framebuffer.h"
+#include "FramePacer.h"
+#include "GPUProfiler.h"
+#include "Profiler.h"
+#include "BufferUpload.h"
+#include "VertexFormatCache.h"
+#include "MeshImporter.h"
+#include "MeshFile.h"
+#include "TextureLoader.h"
+#include "Culling.h"
+
+#include "tests/Test.h"
+#include "tests/TestTexture2D.h"
+#include "tests/TestBatchRenderer.h"
+#include "tests/TestRenderQueue.h"
+#include "tests/TestInstancing.h"
+#include "tests/TestMultiDrawIndirect.h"
+#include "tests/TestParallelRecording.h"
+#include "tests/TestSpatialIndex.h"
+#include "tests/TestMeshOptimizer.h"
+#include "tests/TestMeshImporter.h"
+#include "tests/TestAsyncTextures.h"
 
 // CPP libraries
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <string>
 
 // Graphics libraries
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 
 #include "provided/imgui/imgui.h"
 #include "provided/imgui/imgui_impl_glfw.h"
 #include "provided/imgui/imgui_impl_opengl3.h"
 
-int main(void)
+// The render thread draws ImGui while the main thread builds the next frame, so it
+// gets its own copy of the draw lists
+static ImDrawData* CloneDrawData(const ImDrawData* source)
+{
+	ImDrawData* copy = IM_NEW(ImDrawData)();
+	*copy = *source;
+	// Texture updates are done up front with UpdateTextures
+	copy->Textures = nullptr;
+	for (int i = 0; i < copy->CmdLists.Size; i++)
+		copy->CmdLists[i] = source->CmdLists[i]->CloneOutput();
+	return copy;
+}
+
+static void DestroyDrawData(ImDrawData* drawData)
+{
+	for (ImDrawList* drawList : drawData->CmdLists)
+		IM_DELETE(drawList);
+	IM_DELETE(drawData);
+}
+
+static bool HasPendingTextureUpdates(const ImDrawData* drawData)
+{
+	if (!drawData->Textures)
+		return false;
+
+	for (ImTextureData* texture : *drawData->Textures)
+	{
+		if (texture->Status != ImTextureStatus_OK)
+			return true;
+	}
+	return false;
+}
+
+static void UpdateTextures(const ImDrawData* drawData)
+{
+	for (ImTextureData* texture : *drawData->Textures)
+	{
+		if (texture->Status != ImTextureStatus_OK)
+			ImGui_ImplOpenGL3_UpdateTexture(texture);
+	}
+}
+
+static void PrintFrameStatistics(std::vector<float> frameTimes)
+{
+	if (frameTimes.empty())
+		return;
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	float total = 0.0f;
+	for (float frameTime : frameTimes)
+		total += frameTime;
+
+	auto percentile = [&](float p) { return frameTimes[(size_t)(p * (frameTimes.size() - 1))]; };
+	float average = total / frameTimes.size();
+
+	std::cout << "Frames: " << frameTimes.size() << std::endl;
+	std::cout << "Frame time (ms): min " << frameTimes.front() << ", avg " << average << ", median " << percentile(0.5f)
+		<< ", p95 " << percentile(0.95f) << ", p99 " << percentile(0.99f) << ", max " << frameTimes.back() << std::endl;
+	std::cout << "Average FPS: " << 1000.0f / average << std::endl;
+}
+
+// Per-pass GPU times, a frame or more behind the CPU
+static void DrawGPUProfiler()
+{
+	ImGui::Begin("GPU Profiler");
+
+	bool enabled = GPUProfiler::IsEnabled();
+	if (ImGui::Checkbox("Enabled", &enabled))
+		GPUProfiler::SetEnabled(enabled);
+	ImGui::SameLine();
+	ImGui::Text("Dropped frames: %u", GPUProfiler::GetDroppedFrames());
+
+	std::vector<GPUProfiler::Result> results = GPUProfiler::GetResults();
+	if (!results.empty() && ImGui::BeginTable("Passes", 3, ImGuiTableFlags_Borders))
+	{
+		ImGui::TableSetupColumn("Pass");
+		ImGui::TableSetupColumn("GPU (ms)");
+		ImGui::TableSetupColumn("Average (ms)");
+		ImGui::TableHeadersRow();
+
+		for (const GPUProfiler::Result& result : results)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			// Nested scopes are indented under their parent
+			ImGui::Text("%*s%s", result.Depth * 2, "", result.Name.c_str());
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", result.TimeMs);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", result.AverageMs);
+		}
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
+
+// Culling counts of the last rendered frame, over every test that culls, in the corner of the window
+static void DrawCullingOverlay()
+{
+	Culling::Stats stats = Culling::GetStats();
+	if (stats.Tested == 0)
+		return;
+
+	ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 10.0f, 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+	ImGui::SetNextWindowBgAlpha(0.35f);
+	ImGui::Begin("Culling", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+		ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove);
+	ImGui::Text("Culling (%s)", Culling::GetInstructionSet());
+	ImGui::Text("Submitted: %u", stats.Visible);
+	ImGui::Text("Culled:    %u", stats.GetCulled());
+	ImGui::End();
+}
+
+static void GLFWErrorCallback(int error, const char* description)
+{
+	std::cout << "GLFW error " << error << ": " << description << std::endl;
+}
+
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    // --render-thread moves all GL work to a dedicated thread
+    // --headless renders offscreen without a window or display, uncapped. The GL functions
+    // are loaded through GLX, so it needs a libglvnd libGL or a GLEW built with GLEW_EGL
+    // --frames N exits after N frames and prints frame time statistics
+    // --test NAME starts the named test instead of the menu
+    // --present vsync|uncapped|fixed|low-latency picks the frame pacing, --fps N the fixed rate
+    // --trace FILE writes a Chrome trace of the last CPU profiler events on exit
+    // --gl-debug turns on GL debug output in release builds, --gl-debug-sync makes it
+    // synchronous so errors point at the exact call, --gl-check N sets the glGetError
+    // sampling interval used when debug output is not supported
+    // --upload SubData|Orphan|MapInvalidate skips the startup upload benchmark and
+    // forces that buffer upload strategy
+    // --import-benchmark [FILE...] times the mesh importer on the files, or on large
+    // generated ones, and exits without opening a window
+    // --convert-mesh IN OUT [ATTRIBUTES] converts an OBJ or glTF file to a mesh file with
+    // the comma separated attributes (position,texcoord by default, what the Mesh Importer
+    // test draws) and exits
+    // --mesh-benchmark [FILE...] compares importing the files with loading them as mesh files
+    bool useRenderThread = false;
+    bool headless = false;
+    bool presentModeSet = false;
+    PresentMode presentMode = PresentMode::VSync;
+    float targetRate = 60.0f;
+    int frameLimit = 0;
+    const char* startTest = nullptr;
+    const char* tracePath = nullptr;
+#ifdef _DEBUG
+    bool glDebug = true;
+#else
+    bool glDebug = false;
+#endif
+    bool glDebugSync = false;
+    unsigned int glCheckInterval = 64;
+    bool uploadStrategySet = false;
+    UploadStrategy uploadStrategy = UploadStrategy::SubData;
+    bool importBenchmark = false;
+    std::vector<std::string> importFiles;
+    const char* convertInput = nullptr;
+    const char* convertOutput = nullptr;
+    std::vector<MeshImporter::Attribute> convertAttributes = { MeshImporter::Attribute::Position, MeshImporter::Attribute::TexCoord };
+    bool meshBenchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--render-thread") == 0)
+            useRenderThread = true;
+        else if (std::strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frameLimit = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--test") == 0 && i + 1 < argc)
+            startTest = argv[++i];
+        else if (std::strcmp(argv[i], "--present") == 0 && i + 1 < argc)
+        {
+            presentModeSet = FramePacer::ParseMode(argv[++i], presentMode);
+            if (!presentModeSet)
+                std::cout << "Unknown present mode: " << argv[i] << std::endl;
+        }
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            char* end;
+            float rate = std::strtof(argv[++i], &end);
+            if (end != argv[i] && *end == 0 && std::isfinite(rate) && rate >= 1.0f)
+                targetRate = rate;
+            else
+                std::cout << "Invalid frame rate: " << argv[i] << std::endl;
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-debug") == 0)
+            glDebug = true;
+        else if (std::strcmp(argv[i], "--gl-debug-sync") == 0)
+            glDebug = glDebugSync = true;
+        else if (std::strcmp(argv[i], "--gl-check") == 0 && i + 1 < argc)
+            glCheckInterval = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--upload") == 0 && i + 1 < argc)
+        {
+            uploadStrategySet = BufferUpload::ParseStrategy(argv[++i], uploadStrategy);
+            if (!uploadStrategySet)
+                std::cout << "Unknown upload strategy: " << argv[i] << std::endl;
+        }
+        else if (std::strcmp(argv[i], "--import-benchmark") == 0)
+        {
+            importBenchmark = true;
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                importFiles.push_back(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--convert-mesh") == 0 && i + 2 < argc)
+        {
+            convertInput = argv[++i];
+            convertOutput = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                convertAttributes.clear();
+                std::string list = argv[++i];
+                for (size_t start = 0; start <= list.size();)
+                {
+                    size_t end = std::min(list.find(',', start), list.size());
+                    MeshImporter::Attribute attribute;
+                    if (MeshImporter::ParseAttribute(list.substr(start, end - start).c_str(), attribute))
+                        convertAttributes.push_back(attribute);
+                    else
+                        std::cout << "Unknown attribute: " << list.substr(start, end - start) << std::endl;
+                    start = end + 1;
+                }
+            }
+        }
+        else if (std::strcmp(argv[i], "--mesh-benchmark") == 0)
+        {
+            meshBenchmark = true;
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                importFiles.push_back(argv[++i]);
+        }
+    }
+
+    // Headless runs have to end on their own and measure throughput
+    if (headless && frameLimit <= 0)
+        frameLimit = 1000;
+    if (headless && !presentModeSet)
+        presentMode = PresentMode::Uncapped;
+
+    Profiler::SetThreadName("Main");
+
+    if (importBenchmark)
+    {
+        MeshImporter::Benchmark(importFiles);
+        return 0;
+    }
+    if (meshBenchmark)
+    {
+        MeshFile::Benchmark(importFiles);
+        return 0;
+    }
+    if (convertInput)
+        return MeshFile::Convert(convertInput, convertOutput, convertAttributes) ? 0 : 1;
+    glfwSetErrorCallback(GLFWErrorCallback);
+
+    // The null platform needs no display server, the context then comes from EGL or OSMesa
+    if (headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
     /* Initialize the library */
     if (!glfwInit())
         return -1;
@@ -32,9 +320,24 @@ int main(void)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	if (glDebug)
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+
+	if (headless)
+	{
+		// Surfaceless EGL uses the GPU driver if there is one, OSMesa is always software
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	}
 
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(960, 540, "Learning OpenGL", NULL, NULL);
+    if (!window && headless)
+    {
+        std::cout << "EGL context creation failed, trying OSMesa" << std::endl;
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        window = glfwCreateWindow(960, 540, "Learning OpenGL", NULL, NULL);
+    }
     if (!window)
     {
         glfwTerminate();
@@ -43,13 +346,31 @@ int main(void)
 
     glfwMakeContextCurrent(window);
 
-	glfwSwapInterval(1); // Enable vsync
-    if (glewInit() != GLEW_OK)
-        std::cout << "Error initializing GLEW!" << std::endl;
+    // GLEW built for GLX loads the GL functions before it asks for the GLX display,
+    // which an EGL or OSMesa context does not have. Only the GLX extensions are missing then.
+    GLenum glewError = glewInit();
+    if (glewError == GLEW_ERROR_NO_GLX_DISPLAY && headless)
+        glewError = GLEW_OK;
+    if (glewError != GLEW_OK)
+    {
+        std::cout << "Error initializing GLEW: " << glewGetErrorString(glewError) << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    if (glDebug)
+        GLDebug::Init(glDebugSync, glCheckInterval);
+    GLStateCache::Invalidate();
     
     // OpenGL version print
 	std::cout << glGetString(GL_VERSION) << std::endl;
 
+    // Which way of updating buffers is fastest differs wildly between drivers
+    if (uploadStrategySet)
+        BufferUpload::SetDefaultStrategy(uploadStrategy);
+    else
+        BufferUpload::Benchmark();
+
 	// Setup ImGui context
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -61,106 +382,239 @@ int main(void)
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui::StyleColorsDark();
 
+	// Created up front so the render thread never has to do it in the middle of a frame
+	ImGui_ImplOpenGL3_CreateDeviceObjects();
+
 	// We scope so that destructor are called before glfwTerminate and we don't get the "invalid context" errors
     {
-        float positions[] = {
-              -50.0f, -50.0f, 0.0f, 0.0f,
-               50.0f, -50.0f, 1.0f, 0.0f,
-			   50.0f,  50.0f, 1.0f, 1.0f,
-			  -50.0f,  50.0f, 0.0f, 1.0f,
-
-			   50.0f,  50.0f,  0.0f, 0.0f,
-			   150.0f, 50.0f,  1.0f, 0.0f,
-			   150.0f, 150.0f, 1.0f, 1.0f,
-			   50.0f,  150.0f, 0.0f, 1.0f,
-        };
-
-        // Define an index array
-        unsigned int indices[] = {
-            0, 1, 2, 2, 3, 0,
-			4, 5, 6, 6, 7, 4
-        };
-
         GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
         GLCall(glEnable(GL_BLEND));
 
-		// Create a vertex array object
-		VertexArray va;
-
-		// Create a vertex buffer and layout
-        VertexBuffer vb(positions, 8 * 4 * sizeof(float));
-		VertexBufferLayout layout;
-		layout.Push<float>(2);
-		layout.Push<float>(2);
-		va.AddBuffer(vb, layout);
-
-        // Create an index buffer
-        IndexBuffer ib(indices, 12);
-
-		// TODO: Move to perspective - Create a projection matrix
-        glm::mat4 proj = glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f);
-        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0));
-
-		// Create and bind a shader
-        Shader shader("OpenGL - Cherno/res/shaders/Basic.shader");
-		shader.Bind();
-		glm::vec4 color(0.8f, 0.3f, 0.8f, 1.0f);
-        shader.SetUniform4f("u_Color", color);
+        // There is no default framebuffer to draw into without a window
+        std::unique_ptr<Framebuffer> offscreen;
+        if (headless)
+        {
+            offscreen = std::make_unique<Framebuffer>(960, 540);
+            offscreen->Bind();
+        }
 
-		Texture texture("OpenGL - Cherno/res/textures/wood.jpg");
-		texture.Bind();
-		shader.SetUniform1i("u_Texture", 0);
+		// Sets the swap interval with the first frame, and must outlive the render thread
+		FramePacer framePacer(presentMode, targetRate);
 
+		// From here on only the render thread touches GL
+		RenderThread renderThread(window, useRenderThread);
+		renderThread.SetPresentCallback([&framePacer]() { framePacer.OnPresent(); });
 		Renderer renderer;
 
-        float r = 0.0f;
-        float increment = 0.05f;
-		glm::vec3 translationA(200, 200, 0);
+		test::Test* currentTest = nullptr;
+		test::TestMenu* testMenu = new test::TestMenu(currentTest, renderThread);
+		currentTest = testMenu;
+
+		testMenu->RegisterTest<test::TestTexture2D>("2D Texture");
+		testMenu->RegisterTest<test::TestBatchRenderer>("Batch Renderer 2D");
+		testMenu->RegisterTest<test::TestRenderQueue>("Render Queue");
+		testMenu->RegisterTest<test::TestInstancing>("Instancing");
+		testMenu->RegisterTest<test::TestMultiDrawIndirect>("Multi-Draw Indirect");
+		testMenu->RegisterTest<test::TestParallelRecording>("Parallel Recording");
+		testMenu->RegisterTest<test::TestSpatialIndex>("Spatial Index");
+		testMenu->RegisterTest<test::TestMeshOptimizer>("Mesh Optimizer");
+		testMenu->RegisterTest<test::TestMeshImporter>("Mesh Importer");
+		testMenu->RegisterTest<test::TestAsyncTextures>("Async Textures");
+
+		if (startTest && !testMenu->StartTest(startTest))
+			std::cout << "Unknown test: " << startTest << std::endl;
+
+		// The first frames include shader compilation and driver warm up
+		const int warmupFrames = 10;
+		std::vector<float> frameTimes;
+		frameTimes.reserve(frameLimit > 0 ? frameLimit : 0);
+		int frame = 0;
+
+        float lastFrameTime = (float)glfwGetTime();
+        uint64_t sceneFence = 0;
 
         /* Loop until the user closes the window */
-        while (!glfwWindowShouldClose(window))
+        while (!glfwWindowShouldClose(window) && (frameLimit <= 0 || frame < frameLimit + warmupFrames))
         {
-            /* Render here */
-            renderer.Clear();
+            float time = (float)glfwGetTime();
+            float deltaTime = time - lastFrameTime;
+            lastFrameTime = time;
+            Profiler::BeginFrame();
+
+            // The render thread may still be drawing the last frame's scene from the test state
+            {
+                PROFILE_SCOPE("WaitForFence");
+                renderThread.WaitForFence(sceneFence);
+            }
 
+			// Start the ImGui frame
+			ImGui_ImplOpenGL3_NewFrame();
 			ImGui_ImplGlfw_NewFrame();
+			ImGui::NewFrame();
 
-            shader.Bind();
-            color.r = r;
-			shader.SetUniform4f("u_Color", color);
-
-            { 
-			    glm::mat4 model = glm::translate(glm::mat4(1.0f), translationA);
-			    glm::mat4 mvp = proj * view * model;
-			    shader.SetUniformMat4f("u_MVP", mvp);
-                renderer.Draw(va, ib, shader);
+            if (currentTest)
+            {
+                {
+                    PROFILE_SCOPE("OnUpdate");
+                    currentTest->OnUpdate(deltaTime);
+                }
+
+                ImGui::Begin("Test");
+                if (currentTest != testMenu && ImGui::Button("<-"))
+                {
+                    renderThread.Call([&]() { delete currentTest; });
+                    currentTest = testMenu;
+                }
+                {
+                    PROFILE_SCOPE("OnImGuiRender");
+                    currentTest->OnImGuiRender();
+                }
+                ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+                ImGui::Text("GL binds: %u requested, %u skipped", GLStateCache::GetStats().Calls, GLStateCache::GetStats().Skipped);
+
+                // Unsynchronized mapping is left out, it is never safe as the default
+                const UploadStrategy uploadStrategies[] = { UploadStrategy::SubData, UploadStrategy::Orphan, UploadStrategy::MapInvalidate };
+                const char* uploadNames[] = { "SubData", "Orphan", "Map invalidate" };
+                int upload = 0;
+                for (int i = 0; i < IM_ARRAYSIZE(uploadStrategies); i++)
+                {
+                    if (uploadStrategies[i] == BufferUpload::GetDefaultStrategy())
+                        upload = i;
+                }
+                if (ImGui::Combo("Buffer upload", &upload, uploadNames, IM_ARRAYSIZE(uploadNames)))
+                    BufferUpload::SetDefaultStrategy(uploadStrategies[upload]);
+
+                const char* modeNames[] = { "VSync", "Uncapped", "Fixed rate", "Low latency" };
+                int mode = (int)framePacer.GetMode();
+                if (ImGui::Combo("Present mode", &mode, modeNames, IM_ARRAYSIZE(modeNames)))
+                    framePacer.SetMode((PresentMode)mode);
+                if (framePacer.GetMode() == PresentMode::FixedRate)
+                {
+                    float rate = framePacer.GetTargetRate();
+                    if (ImGui::SliderFloat("Target FPS", &rate, 10.0f, 240.0f, "%.0f"))
+                        framePacer.SetTargetRate(rate);
+                }
+
+                FramePacer::LatencyStats latency = framePacer.GetLatencyStats();
+                std::vector<float> latencyHistory;
+                framePacer.GetLatencyHistory(latencyHistory);
+                ImGui::Text("Input to present: %.2f ms (avg %.2f, max %.2f)", latency.LastMs, latency.AverageMs, latency.MaxMs);
+                if (!latencyHistory.empty())
+                    ImGui::PlotLines("##Latency", latencyHistory.data(), (int)latencyHistory.size(), 0, nullptr, 0.0f, latency.MaxMs * 1.2f, ImVec2(0.0f, 40.0f));
+                ImGui::End();
             }
 
-            if (r > 1.0f)
-                increment = -0.05f;
-            else if (r < 0.0f)
-                increment = 0.05f;
+            DrawGPUProfiler();
+            DrawCullingOverlay();
+            Profiler::OnImGuiRender();
 
-            r += increment;
+            {
+                PROFILE_SCOPE("ImGui::Render");
+                ImGui::Render();
+            }
 
-			// Start the ImGui frame
-			ImGui_ImplOpenGL3_NewFrame();
-			ImGui_ImplGlfw_NewFrame();
-			ImGui::NewFrame();
+            framePacer.RecordFrame(renderThread);
+
+            /* Render here */
+            test::Test* frameTest = currentTest;
+            renderThread.Record([&renderer, frameTest]() {
+                GPUProfiler::BeginFrame();
+                {
+                    GPU_PROFILE_SCOPE("Clear");
+                    GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+                    renderer.Clear();
+                }
+
+                GLStateCache::ResetStats();
+                {
+                    GPU_PROFILE_SCOPE("Texture uploads");
+                    TextureLoader::Update();
+                }
+                if (frameTest)
+                {
+                    PROFILE_SCOPE("OnRender");
+                    GPU_PROFILE_SCOPE("Scene");
+                    frameTest->OnRender();
+                }
+                Culling::EndFrame();
+            });
+            sceneFence = renderThread.InsertFence();
 
-			// ImGui UI code
-			ImGui::SliderFloat3("float", &translationA.x, 0.0f, 500.0f);
-			ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-            
 			// Render the ImGui frame
-			ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            if (renderThread.IsThreaded())
+            {
+                // The next NewFrame reuses ImGui's draw lists while this frame is still being drawn
+                ImDrawData* drawData = ImGui::GetDrawData();
+                if (HasPendingTextureUpdates(drawData))
+                    renderThread.Call([drawData]() { UpdateTextures(drawData); });
+
+                ImDrawData* drawDataCopy = CloneDrawData(drawData);
+                renderThread.Record([drawDataCopy]() {
+                    PROFILE_SCOPE("ImGui_ImplOpenGL3_RenderDrawData");
+                    GPU_PROFILE_SCOPE("ImGui");
+                    ImGui_ImplOpenGL3_RenderDrawData(drawDataCopy);
+                    DestroyDrawData(drawDataCopy);
+                });
+            }
+            else
+            {
+                renderThread.Record([]() {
+                    PROFILE_SCOPE("ImGui_ImplOpenGL3_RenderDrawData");
+                    GPU_PROFILE_SCOPE("ImGui");
+                    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                });
+            }
+            // The backend binds its own program, buffers and textures
+            renderThread.Record([]() {
+                GLStateCache::Invalidate();
+                GPUProfiler::EndFrame();
+            });
+
+            // Nothing presents an offscreen frame, so wait for it to make frame times mean something
+            if (headless)
+                renderThread.Record([]() { GLCall(glFinish()); });
+
+            /* Swap front and back buffers, on the render thread */
+            {
+                PROFILE_SCOPE("SubmitFrame");
+                renderThread.SubmitFrame();
+            }
 
-            /* Swap front and back buffers */
-            GLCall(glfwSwapBuffers(window));
+            /* Poll for and process events, as late as the pacing allows */
+            {
+                PROFILE_SCOPE("Throttle");
+                framePacer.Throttle();
+            }
+            {
+                PROFILE_SCOPE("glfwPollEvents");
+                glfwPollEvents();
+            }
+            framePacer.OnInputPolled();
+
+            if (frameLimit > 0 && frame++ >= warmupFrames)
+                frameTimes.push_back(((float)glfwGetTime() - time) * 1000.0f);
+        }
+
+        renderThread.Call([&]() {
+            if (currentTest != testMenu)
+                delete testMenu;
+            delete currentTest;
+            offscreen.reset();
+            GPUProfiler::Shutdown();
+            VertexFormatCache::Shutdown();
+            TextureLoader::Shutdown();
+        });
+
+        if (tracePath && !Profiler::WriteChromeTrace(tracePath))
+            std::cout << "Failed to write trace to " << tracePath << std::endl;
+
+        if (frameLimit > 0)
+        {
+            PrintFrameStatistics(frameTimes);
 
-            /* Poll for and process events */
-            glfwPollEvents();
+            FramePacer::LatencyStats latency = framePacer.GetLatencyStats();
+            std::cout << "Input to present (ms, last " << FramePacer::HistorySize << " frames): avg " << latency.AverageMs
+                << ", max " << latency.MaxMs << std::endl;
         }
     }
 
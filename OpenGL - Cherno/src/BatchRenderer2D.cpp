@@ -0,0 +1,177 @@
+#include "BatchRenderer2D.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+#include "Profiler.h"
+
+BatchRenderer2D::BatchRenderer2D(unsigned int maxQuads)
+	: m_MaxQuads(maxQuads), m_MaxVertices(maxQuads * 4), m_MaxIndices(maxQuads * 6),
+	 m_TextureSlotCount(s_MaxTextureSlots), m_VertexBufferBase(nullptr), m_VertexBufferPtr(nullptr), m_QuadIndexCount(0),
+	 m_TextureSlotIndex(1), m_ViewProjection(1.0f)
+{
+	// The shader samples from 32 units, but never use more than the driver exposes
+	int maxTextureUnits;
+	GLCall(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureUnits));
+	m_TextureSlotCount = std::min((unsigned int)maxTextureUnits, s_MaxTextureSlots);
+
+	m_VertexArray = std::make_unique<VertexArray>();
+	// Room for a few full batches per frame before a region runs out and wraps early
+	m_VertexStream = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, 4 * m_MaxVertices * (unsigned int)sizeof(QuadVertex),
+		(unsigned int)sizeof(QuadVertex));
+
+	constexpr VertexBufferLayout layout = QuadVertex::GetLayout();
+	m_VertexArray->AddBuffer(*m_VertexStream, layout);
+
+	// Every quad uses the same index pattern, so the index buffer never changes.
+	// Up to 16384 quads the indices fit in 16 bits and the buffer narrows to those.
+	std::vector<unsigned int> indices(m_MaxIndices);
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < m_MaxIndices; i += 6)
+	{
+		indices[i + 0] = offset + 0;
+		indices[i + 1] = offset + 1;
+		indices[i + 2] = offset + 2;
+
+		indices[i + 3] = offset + 2;
+		indices[i + 4] = offset + 3;
+		indices[i + 5] = offset + 0;
+
+		offset += 4;
+	}
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), m_MaxIndices);
+
+	// Slot 0 is a 1x1 white texture so colored and textured quads share a batch
+	m_WhiteTexture = std::make_unique<Texture>(1, 1);
+	unsigned int white = 0xffffffff;
+	m_WhiteTexture->SetData(&white, sizeof(unsigned int));
+
+	int samplers[s_MaxTextureSlots];
+	for (unsigned int i = 0; i < s_MaxTextureSlots; i++)
+		samplers[i] = i;
+
+	m_Shader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Batch.shader");
+	m_Shader->Bind();
+	m_Shader->SetUniform1iv("u_Textures", s_MaxTextureSlots, samplers);
+
+	m_TextureSlots.fill(nullptr);
+	m_TextureSlots[0] = m_WhiteTexture.get();
+}
+
+BatchRenderer2D::~BatchRenderer2D()
+{
+}
+
+void BatchRenderer2D::BeginScene(const glm::mat4& viewProjection)
+{
+	m_ViewProjection = viewProjection;
+
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4f("u_ViewProjection", m_ViewProjection);
+
+	StartBatch();
+}
+
+void BatchRenderer2D::EndScene()
+{
+	Flush();
+	m_VertexStream->EndFrame();
+	m_Stats.StreamStalls = m_VertexStream->GetStallCount();
+}
+
+void BatchRenderer2D::StartBatch()
+{
+	m_VertexBufferBase = (QuadVertex*)m_VertexStream->Map(m_MaxVertices * (unsigned int)sizeof(QuadVertex));
+	m_VertexBufferPtr = m_VertexBufferBase;
+	m_QuadIndexCount = 0;
+	m_TextureSlotIndex = 1;
+}
+
+void BatchRenderer2D::Flush()
+{
+	PROFILE_SCOPE("BatchRenderer2D::Flush");
+
+	// The batch is already in place, this only tells the stream buffer how much was used
+	unsigned int dataSize = (unsigned int)((unsigned char*)m_VertexBufferPtr - (unsigned char*)m_VertexBufferBase);
+	unsigned int baseVertex = m_VertexStream->Unmap(dataSize) / (unsigned int)sizeof(QuadVertex);
+	m_VertexBufferBase = m_VertexBufferPtr = nullptr;
+
+	if (m_QuadIndexCount == 0)
+		return;
+
+	for (unsigned int i = 0; i < m_TextureSlotIndex; i++)
+		m_TextureSlots[i]->Bind(i);
+
+	m_Shader->Bind();
+	m_VertexArray->Bind();
+	m_IndexBuffer->Bind();
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, m_QuadIndexCount, m_IndexBuffer->GetType(), nullptr, baseVertex));
+
+	m_Stats.DrawCalls++;
+	m_Stats.TextureSlotsUsed = std::max(m_Stats.TextureSlotsUsed, m_TextureSlotIndex);
+}
+
+void BatchRenderer2D::NextBatch()
+{
+	Flush();
+	StartBatch();
+}
+
+float BatchRenderer2D::GetTextureIndex(const Texture& texture)
+{
+	for (unsigned int i = 1; i < m_TextureSlotIndex; i++)
+	{
+		if (m_TextureSlots[i] == &texture)
+			return (float)i;
+	}
+
+	if (m_TextureSlotIndex >= m_TextureSlotCount)
+		NextBatch();
+
+	m_TextureSlots[m_TextureSlotIndex] = &texture;
+	return (float)m_TextureSlotIndex++;
+}
+
+void BatchRenderer2D::PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex)
+{
+	const glm::vec2 corners[4] = {
+		{ 0.0f, 0.0f },
+		{ 1.0f, 0.0f },
+		{ 1.0f, 1.0f },
+		{ 0.0f, 1.0f }
+	};
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		m_VertexBufferPtr->Position = { position.x + corners[i].x * size.x, position.y + corners[i].y * size.y, 0.0f };
+		m_VertexBufferPtr->Color = color;
+		m_VertexBufferPtr->TexCoord = corners[i];
+		m_VertexBufferPtr->TexIndex = texIndex;
+		m_VertexBufferPtr++;
+	}
+
+	m_QuadIndexCount += 6;
+	m_Stats.QuadCount++;
+}
+
+void BatchRenderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+	if (m_QuadIndexCount >= m_MaxIndices)
+		NextBatch();
+
+	PushQuad(position, size, color, 0.0f);
+}
+
+void BatchRenderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint)
+{
+	if (m_QuadIndexCount >= m_MaxIndices)
+		NextBatch();
+
+	float texIndex = GetTextureIndex(texture);
+	PushQuad(position, size, tint, texIndex);
+}
+
+void BatchRenderer2D::ResetStats()
+{
+	m_Stats = Stats();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+#include "StreamBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+struct QuadVertex
+{
+	glm::vec3 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+	float TexIndex;
+
+	static constexpr VertexBufferLayout GetLayout()
+	{
+		return VertexBufferLayout::Create<decltype(Position), decltype(Color), decltype(TexCoord), decltype(TexIndex)>();
+	}
+};
+
+static_assert(QuadVertex::GetLayout().Matches(sizeof(QuadVertex), { offsetof(QuadVertex, Position), offsetof(QuadVertex, Color),
+	offsetof(QuadVertex, TexCoord), offsetof(QuadVertex, TexIndex) }), "QuadVertex layout does not match the struct");
+
+// Accumulates quads into a streaming vertex buffer and draws them with as few
+// glDrawElements calls as possible. A batch is flushed when it reaches the quad
+// limit or when every texture slot is taken. Quads are written straight into the
+// stream buffer, each batch drawn from its own offset with a base vertex.
+class BatchRenderer2D
+{
+public:
+	struct Stats
+	{
+		unsigned int DrawCalls = 0;
+		unsigned int QuadCount = 0;
+		unsigned int TextureSlotsUsed = 0;
+		unsigned int StreamStalls = 0;
+	};
+
+private:
+	static const unsigned int s_MaxTextureSlots = 32;
+
+	unsigned int m_MaxQuads;
+	unsigned int m_MaxVertices;
+	unsigned int m_MaxIndices;
+	unsigned int m_TextureSlotCount;
+
+	std::unique_ptr<VertexArray> m_VertexArray;
+	std::unique_ptr<StreamBuffer> m_VertexStream;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	std::unique_ptr<Shader> m_Shader;
+	std::unique_ptr<Texture> m_WhiteTexture;
+
+	// Both point into the mapped stream buffer while a batch is open
+	QuadVertex* m_VertexBufferBase;
+	QuadVertex* m_VertexBufferPtr;
+	unsigned int m_QuadIndexCount;
+
+	std::array<const Texture*, s_MaxTextureSlots> m_TextureSlots;
+	unsigned int m_TextureSlotIndex;
+
+	glm::mat4 m_ViewProjection;
+	Stats m_Stats;
+
+	void StartBatch();
+	void Flush();
+	void NextBatch();
+
+	float GetTextureIndex(const Texture& texture);
+	void PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex);
+
+public:
+	BatchRenderer2D(unsigned int maxQuads = 10000);
+	~BatchRenderer2D();
+
+	void BeginScene(const glm::mat4& viewProjection);
+	void EndScene();
+
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+
+	void ResetStats();
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline unsigned int GetTextureSlotCount() const { return m_TextureSlotCount; }
+};
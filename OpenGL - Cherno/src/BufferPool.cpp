@@ -0,0 +1,119 @@
+#include "BufferPool.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+BufferPool::BufferPool(unsigned int target, unsigned int elementSize, unsigned int blockSize, BufferUsage usage)
+	: m_Target(target), m_ElementSize(elementSize), m_BlockElements(std::max(blockSize / elementSize, 1u)), m_Usage(usage),
+	 m_TotalAllocations(0), m_TotalFrees(0), m_FailedAllocations(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+	for (Block& block : m_Blocks)
+	{
+		GLStateCache::OnDeleteBuffer(block.RendererID);
+		GLCall(glDeleteBuffers(1, &block.RendererID));
+	}
+}
+
+void BufferPool::AddBlock(unsigned int elementCount)
+{
+	Block block;
+	block.ElementCount = elementCount;
+	block.Allocator = std::make_unique<OffsetAllocator>(elementCount);
+
+	GLCall(glGenBuffers(1, &block.RendererID));
+	GLStateCache::BindBuffer(m_Target, block.RendererID);
+	GLCall(glBufferData(m_Target, (GLsizeiptr)elementCount * m_ElementSize, nullptr, BufferUpload::GetUsageEnum(m_Usage)));
+
+	m_Blocks.push_back(std::move(block));
+}
+
+BufferPool::Allocation BufferPool::Allocate(unsigned int count)
+{
+	Allocation allocation;
+	if (count == 0)
+		return allocation;
+
+	// Earlier blocks first, so meshes pack into as few buffers as possible
+	for (unsigned int i = 0; i < m_Blocks.size() && !allocation.IsValid(); i++)
+	{
+		OffsetAllocator::Allocation range = m_Blocks[i].Allocator->Allocate(count);
+		if (range.IsValid())
+		{
+			allocation.Block = i;
+			allocation.Range = range;
+		}
+	}
+
+	if (!allocation.IsValid())
+	{
+		AddBlock(std::max(count, m_BlockElements));
+		allocation.Block = (unsigned int)m_Blocks.size() - 1;
+		allocation.Range = m_Blocks.back().Allocator->Allocate(count);
+		if (!allocation.Range.IsValid())
+		{
+			m_FailedAllocations++;
+			return Allocation();
+		}
+	}
+
+	allocation.Offset = allocation.Range.Offset;
+	allocation.Count = count;
+	m_TotalAllocations++;
+	return allocation;
+}
+
+void BufferPool::Free(const Allocation& allocation)
+{
+	if (!allocation.IsValid())
+		return;
+
+	m_Blocks[allocation.Block].Allocator->Free(allocation.Range);
+	m_TotalFrees++;
+}
+
+void BufferPool::SetData(const Allocation& allocation, unsigned int offset, const void* data, unsigned int count,
+	UploadStrategy strategy)
+{
+	ASSERT(allocation.IsValid() && offset + count <= allocation.Count);
+
+	if (strategy == UploadStrategy::Default)
+		strategy = BufferUpload::GetDefaultStrategy();
+	if (strategy == UploadStrategy::Orphan)
+		strategy = UploadStrategy::SubData;
+
+	const Block& block = m_Blocks[allocation.Block];
+	GLStateCache::BindBuffer(m_Target, block.RendererID);
+	BufferUpload::Upload(m_Target, block.ElementCount * m_ElementSize, m_Usage, strategy,
+		(allocation.Offset + offset) * m_ElementSize, data, count * m_ElementSize);
+}
+
+void BufferPool::Bind(unsigned int block) const
+{
+	GLStateCache::BindBuffer(m_Target, m_Blocks[block].RendererID);
+}
+
+BufferPool::Stats BufferPool::GetStats() const
+{
+	Stats stats;
+	stats.Blocks = (unsigned int)m_Blocks.size();
+	stats.TotalAllocations = m_TotalAllocations;
+	stats.TotalFrees = m_TotalFrees;
+	stats.FailedAllocations = m_FailedAllocations;
+
+	for (const Block& block : m_Blocks)
+	{
+		OffsetAllocator::Stats blockStats = block.Allocator->GetStats();
+		stats.Allocations += blockStats.Allocations;
+		stats.CapacityBytes += (size_t)blockStats.Size * m_ElementSize;
+		stats.UsedBytes += (size_t)(blockStats.Size - blockStats.FreeSpace) * m_ElementSize;
+		stats.LargestFreeBytes = std::max(stats.LargestFreeBytes, (size_t)blockStats.LargestFree * m_ElementSize);
+		stats.FreeRanges += blockStats.FreeRanges;
+	}
+	return stats;
+}
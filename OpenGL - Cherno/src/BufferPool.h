@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "BufferUpload.h"
+#include "OffsetAllocator.h"
+
+// A few big GL buffers that many meshes share. Ranges are handed out in elements
+// of a fixed size, the vertex stride for vertex data or the index size for index
+// data, so an allocation's offset is directly usable as base vertex or first index.
+// Meshes in the same block share one buffer object, one VAO can draw them all
+// and consecutive draws need no rebinding. A new block is added whenever an
+// allocation fits in none of the existing ones.
+//
+// VertexBuffer and IndexBuffer can be created as views into a pool.
+class BufferPool
+{
+public:
+	struct Allocation
+	{
+		unsigned int Block = ~0u;
+		// In elements from the start of the block
+		unsigned int Offset = 0;
+		unsigned int Count = 0;
+		OffsetAllocator::Allocation Range;
+
+		inline bool IsValid() const { return Block != ~0u; }
+	};
+
+	struct Stats
+	{
+		unsigned int Blocks = 0;
+		unsigned int Allocations = 0;
+		unsigned int TotalAllocations = 0;
+		unsigned int TotalFrees = 0;
+		unsigned int FailedAllocations = 0;
+		size_t CapacityBytes = 0;
+		size_t UsedBytes = 0;
+		size_t LargestFreeBytes = 0;
+		unsigned int FreeRanges = 0;
+
+		// 0 when all free space is one range, towards 1 the more it is scattered
+		inline float GetFragmentation() const
+		{
+			size_t freeBytes = CapacityBytes - UsedBytes;
+			return freeBytes ? 1.0f - (float)LargestFreeBytes / (float)freeBytes : 0.0f;
+		}
+	};
+
+private:
+	struct Block
+	{
+		unsigned int RendererID;
+		unsigned int ElementCount;
+		std::unique_ptr<OffsetAllocator> Allocator;
+	};
+
+	unsigned int m_Target;
+	unsigned int m_ElementSize;
+	unsigned int m_BlockElements;
+	BufferUsage m_Usage;
+	std::vector<Block> m_Blocks;
+
+	unsigned int m_TotalAllocations;
+	unsigned int m_TotalFrees;
+	unsigned int m_FailedAllocations;
+
+	void AddBlock(unsigned int elementCount);
+
+public:
+	// blockSize is in bytes, allocations bigger than that get a block of their own
+	BufferPool(unsigned int target, unsigned int elementSize, unsigned int blockSize = 16 * 1024 * 1024,
+		BufferUsage usage = BufferUsage::Static);
+	~BufferPool();
+
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	Allocation Allocate(unsigned int count);
+	void Free(const Allocation& allocation);
+
+	// offset and count are in elements, relative to the allocation. Orphaning would
+	// throw away every other range in the block, so that strategy uploads with
+	// glBufferSubData instead.
+	void SetData(const Allocation& allocation, unsigned int offset, const void* data, unsigned int count,
+		UploadStrategy strategy = UploadStrategy::Default);
+
+	void Bind(unsigned int block) const;
+
+	Stats GetStats() const;
+
+	inline unsigned int GetTarget() const { return m_Target; }
+	inline unsigned int GetElementSize() const { return m_ElementSize; }
+	inline unsigned int GetBlockCount() const { return (unsigned int)m_Blocks.size(); }
+	inline unsigned int GetRendererID(unsigned int block) const { return m_Blocks[block].RendererID; }
+};
@@ -0,0 +1,192 @@
+#include "BufferUpload.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "Renderer.h"
+#include "Profiler.h"
+
+std::atomic<UploadStrategy> BufferUpload::s_DefaultStrategy(UploadStrategy::SubData);
+
+static const char* s_StrategyNames[] = { "SubData", "Orphan", "MapUnsynchronized", "MapInvalidate" };
+
+void BufferUpload::Upload(unsigned int target, unsigned int bufferSize, BufferUsage usage, UploadStrategy strategy,
+	unsigned int offset, const void* data, unsigned int size)
+{
+	ASSERT(offset + size <= bufferSize);
+	if (size == 0)
+		return;
+
+	if (strategy == UploadStrategy::Default)
+		strategy = s_DefaultStrategy;
+
+	switch (strategy)
+	{
+	case UploadStrategy::Orphan:
+		// Dropping the rest of the buffer is only expected when refilling it from the start
+		if (offset == 0)
+		{
+			GLCall(glBufferData(target, bufferSize, nullptr, GetUsageEnum(usage)));
+		}
+		break;
+	case UploadStrategy::MapUnsynchronized:
+	case UploadStrategy::MapInvalidate:
+	{
+		GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		if (strategy == UploadStrategy::MapUnsynchronized)
+			access |= GL_MAP_UNSYNCHRONIZED_BIT;
+
+		void* mapped;
+		GLCall(mapped = glMapBufferRange(target, offset, size, access));
+		if (mapped)
+		{
+			std::memcpy(mapped, data, size);
+			GLboolean intact;
+			GLCall(intact = glUnmapBuffer(target));
+			if (intact)
+				return;
+		}
+		// Mapping failed or the storage got lost while mapped, copy the plain way
+		break;
+	}
+	default:
+		break;
+	}
+
+	GLCall(glBufferSubData(target, offset, size, data));
+}
+
+std::vector<BufferUpload::BenchmarkResult> BufferUpload::Benchmark(unsigned int uploadSize, unsigned int iterations)
+{
+	PROFILE_SCOPE("BufferUpload::Benchmark");
+
+	ASSERT(uploadSize >= sizeof(unsigned int));
+
+	// The copy and read targets keep the GLStateCache bindings untouched. Every
+	// timed upload is copied to its own slot, to check afterwards that the GPU
+	// read what was written and not an earlier or half written upload.
+	unsigned int buffers[2];
+	GLCall(glGenBuffers(2, buffers));
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, buffers[0]));
+	GLCall(glBufferData(GL_COPY_READ_BUFFER, uploadSize, nullptr, GL_DYNAMIC_DRAW));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)uploadSize * iterations, nullptr, GL_STATIC_COPY));
+
+	std::vector<unsigned char> data(uploadSize);
+	for (unsigned int i = 0; i < uploadSize; i++)
+		data[i] = (unsigned char)i;
+	std::vector<unsigned char> copies((size_t)uploadSize * iterations);
+
+	std::vector<BenchmarkResult> results;
+	for (int s = 0; s < (int)UploadStrategy::Count; s++)
+	{
+		UploadStrategy strategy = (UploadStrategy)s;
+
+		// A GPU copy out of the buffer after every upload makes each one race a pending
+		// read. Each upload starts with its own number, so the copies tell them apart.
+		auto uploadAndRead = [&](unsigned int upload) {
+			std::memcpy(data.data(), &upload, sizeof(upload));
+			Upload(GL_COPY_READ_BUFFER, uploadSize, BufferUsage::Dynamic, strategy, 0, data.data(), uploadSize);
+			GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, (GLintptr)upload * uploadSize, uploadSize));
+		};
+
+		for (unsigned int i = 0; i < 4; i++)
+			uploadAndRead(0);
+		GLCall(glFinish());
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < iterations; i++)
+			uploadAndRead(i);
+		GLCall(glFinish());
+		std::chrono::duration<float, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		BenchmarkResult result;
+		result.Strategy = strategy;
+		result.MicrosecondsPerUpload = elapsed.count() / iterations;
+		result.MegabytesPerSecond = (float)uploadSize / (1024.0f * 1024.0f) / (result.MicrosecondsPerUpload * 1e-6f);
+
+		GLCall(glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)copies.size(), copies.data()));
+		result.Intact = true;
+		for (unsigned int i = 0; i < iterations && result.Intact; i++)
+		{
+			std::memcpy(data.data(), &i, sizeof(i));
+			result.Intact = std::memcmp(&copies[(size_t)i * uploadSize], data.data(), uploadSize) == 0;
+		}
+		results.push_back(result);
+	}
+
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	GLCall(glDeleteBuffers(2, buffers));
+
+	// Unsynchronized mapping wins by never waiting, which is exactly what makes it
+	// unsafe for buffers that do not track the GPU reads themselves
+	const BenchmarkResult* fastest = nullptr;
+	for (const BenchmarkResult& result : results)
+	{
+		if (!result.Intact || !CanBeDefault(result.Strategy))
+			continue;
+		if (!fastest || result.MicrosecondsPerUpload < fastest->MicrosecondsPerUpload)
+			fastest = &result;
+	}
+	SetDefaultStrategy(fastest ? fastest->Strategy : UploadStrategy::SubData);
+
+	std::cout << "Buffer upload benchmark (" << uploadSize / 1024 << " KB x " << iterations << ")" << std::endl;
+	std::cout << std::left << std::setw(20) << "Strategy" << std::right << std::setw(12) << "us/upload" << std::setw(12) << "MB/s" << std::endl;
+	for (const BenchmarkResult& result : results)
+	{
+		std::cout << std::left << std::setw(20) << GetStrategyName(result.Strategy) << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << result.MicrosecondsPerUpload << std::setw(12) << result.MegabytesPerSecond
+			<< (!result.Intact ? "  corrupted" : &result == fastest ? "  <- default" : "") << std::endl;
+	}
+	std::cout.unsetf(std::ios_base::floatfield);
+
+	return results;
+}
+
+bool BufferUpload::CanBeDefault(UploadStrategy strategy)
+{
+	return strategy < UploadStrategy::Count && strategy != UploadStrategy::MapUnsynchronized;
+}
+
+void BufferUpload::SetDefaultStrategy(UploadStrategy strategy)
+{
+	if (!CanBeDefault(strategy))
+	{
+		std::cout << GetStrategyName(strategy) << " is only for buffers that ask for it, not a default" << std::endl;
+		return;
+	}
+	s_DefaultStrategy = strategy;
+}
+
+unsigned int BufferUpload::GetUsageEnum(BufferUsage usage)
+{
+	switch (usage)
+	{
+	case BufferUsage::Static: return GL_STATIC_DRAW;
+	case BufferUsage::Stream: return GL_STREAM_DRAW;
+	default: return GL_DYNAMIC_DRAW;
+	}
+}
+
+const char* BufferUpload::GetStrategyName(UploadStrategy strategy)
+{
+	if (strategy == UploadStrategy::Default)
+		strategy = s_DefaultStrategy;
+	return s_StrategyNames[(int)strategy];
+}
+
+bool BufferUpload::ParseStrategy(const char* name, UploadStrategy& strategy)
+{
+	for (int i = 0; i < (int)UploadStrategy::Count; i++)
+	{
+		if (std::strcmp(name, s_StrategyNames[i]) == 0)
+		{
+			strategy = (UploadStrategy)i;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+enum class BufferUsage
+{
+	Static, Dynamic, Stream
+};
+
+// How SetData on a buffer gets its bytes to GL. Which one is fastest depends
+// heavily on the driver, so Benchmark measures them once at startup.
+//   SubData            glBufferSubData, the driver copies and may stall or rename
+//   Orphan             glBufferData(nullptr) first, so the GPU keeps the old storage.
+//                      Only used for updates starting at offset 0, and everything
+//                      past the written range is lost
+//   MapUnsynchronized  glMapBufferRange without any sync, the caller makes sure the
+//                      GPU is not reading the range any more. Never the default,
+//                      a buffer has to ask for it with its own strategy
+//   MapInvalidate      glMapBufferRange invalidating only the written range
+enum class UploadStrategy
+{
+	SubData = 0, Orphan, MapUnsynchronized, MapInvalidate, Count,
+	// Follow BufferUpload::GetDefaultStrategy
+	Default
+};
+
+class BufferUpload
+{
+public:
+	struct BenchmarkResult
+	{
+		UploadStrategy Strategy;
+		float MicrosecondsPerUpload;
+		float MegabytesPerSecond;
+		// Every upload reached the GPU read that followed it
+		bool Intact;
+	};
+
+private:
+	static std::atomic<UploadStrategy> s_DefaultStrategy;
+
+public:
+	// Writes size bytes at offset into the buffer bound to target through GL_*_DRAW
+	// usage matching usage. bufferSize is the whole allocation, needed to orphan it.
+	static void Upload(unsigned int target, unsigned int bufferSize, BufferUsage usage, UploadStrategy strategy,
+		unsigned int offset, const void* data, unsigned int size);
+
+	// Times every strategy on updates of uploadSize bytes that the GPU reads right
+	// after and checks each read got its upload. The fastest intact strategy that
+	// may be the default becomes it. Needs a current GL context.
+	static std::vector<BenchmarkResult> Benchmark(unsigned int uploadSize = 256 * 1024, unsigned int iterations = 64);
+
+	static unsigned int GetUsageEnum(BufferUsage usage);
+	static const char* GetStrategyName(UploadStrategy strategy);
+	static bool ParseStrategy(const char* name, UploadStrategy& strategy);
+
+	// False for strategies that are only safe on buffers whose GPU reads are tracked
+	static bool CanBeDefault(UploadStrategy strategy);
+	// Can be changed from any thread, buffers pick it up on their next SetData.
+	// Strategies that cannot be the default are refused.
+	static void SetDefaultStrategy(UploadStrategy strategy);
+	static inline UploadStrategy GetDefaultStrategy() { return s_DefaultStrategy; }
+};
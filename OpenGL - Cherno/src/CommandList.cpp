@@ -0,0 +1,56 @@
+#include "CommandList.h"
+
+#include <algorithm>
+
+CommandList::CommandList()
+	: m_CurrentBlock(0), m_Offset(0)
+{
+}
+
+CommandList::~CommandList()
+{
+	Clear();
+}
+
+void* CommandList::Allocate(size_t size, size_t alignment)
+{
+	while (m_CurrentBlock < m_Blocks.size())
+	{
+		Block& block = m_Blocks[m_CurrentBlock];
+		size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= block.Size)
+		{
+			m_Offset = offset + size;
+			return block.Memory.get() + offset;
+		}
+
+		m_CurrentBlock++;
+		m_Offset = 0;
+	}
+
+	// Oversized commands get a block of their own
+	Block block;
+	block.Size = std::max(s_BlockSize, size + alignment);
+	block.Memory.reset(new unsigned char[block.Size]);
+	m_Blocks.push_back(std::move(block));
+	m_CurrentBlock = m_Blocks.size() - 1;
+	m_Offset = 0;
+
+	return Allocate(size, alignment);
+}
+
+void CommandList::Execute()
+{
+	for (const Command& command : m_Commands)
+		command.Execute(command.Data);
+}
+
+void CommandList::Clear()
+{
+	for (const Command& command : m_Commands)
+		command.Destroy(command.Data);
+
+	m_Commands.clear();
+	m_CurrentBlock = 0;
+	m_Offset = 0;
+}
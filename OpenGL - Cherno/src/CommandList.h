@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Records callables into a linear arena and runs them later in order. Memory
+// blocks are kept between frames, so recording stops allocating once the list
+// has grown to its steady state size (captured containers still allocate).
+class CommandList
+{
+private:
+	struct Command
+	{
+		void (*Execute)(void*);
+		void (*Destroy)(void*);
+		void* Data;
+	};
+
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> Memory;
+		size_t Size;
+	};
+
+	static const size_t s_BlockSize = 64 * 1024;
+
+	std::vector<Block> m_Blocks;
+	std::vector<Command> m_Commands;
+	size_t m_CurrentBlock;
+	size_t m_Offset;
+
+	void* Allocate(size_t size, size_t alignment);
+
+public:
+	CommandList();
+	~CommandList();
+
+	CommandList(const CommandList&) = delete;
+	CommandList& operator=(const CommandList&) = delete;
+
+	template<typename F>
+	void Record(F&& function)
+	{
+		typedef typename std::decay<F>::type Function;
+
+		void* data = Allocate(sizeof(Function), alignof(Function));
+		new (data) Function(std::forward<F>(function));
+
+		m_Commands.push_back({
+			[](void* data) { (*(Function*)data)(); },
+			[](void* data) { ((Function*)data)->~Function(); },
+			data
+		});
+	}
+
+	// Runs every command in recording order, the list keeps them until Clear
+	void Execute();
+	void Clear();
+
+	inline size_t GetCommandCount() const { return m_Commands.size(); }
+	inline bool IsEmpty() const { return m_Commands.empty(); }
+};
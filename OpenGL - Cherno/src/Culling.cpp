@@ -0,0 +1,332 @@
+#include "Culling.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_AVX
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CULLING_SSE
+#endif
+
+bool Culling::s_UseSIMD = true;
+std::atomic<unsigned int> Culling::s_Tested(0);
+std::atomic<unsigned int> Culling::s_Visible(0);
+std::atomic<unsigned int> Culling::s_LastTested(0);
+std::atomic<unsigned int> Culling::s_LastVisible(0);
+
+Frustum::Frustum(const glm::mat4& m)
+{
+	// Gribb/Hartmann: each plane is the last row of the matrix plus or minus another row
+	glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	Planes[0] = row3 + row0; // Left
+	Planes[1] = row3 - row0; // Right
+	Planes[2] = row3 + row1; // Bottom
+	Planes[3] = row3 - row1; // Top
+	Planes[4] = row3 + row2; // Near
+	Planes[5] = row3 - row2; // Far
+
+	// Normalized so plane distances are in world units, which spheres need
+	for (glm::vec4& plane : Planes)
+	{
+		float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.0f)
+			plane = plane / length;
+	}
+}
+
+void AABBList2D::Resize(unsigned int count)
+{
+	CenterX.resize(count); CenterY.resize(count);
+	ExtentX.resize(count); ExtentY.resize(count);
+}
+
+void AABBList2D::Set(unsigned int index, const glm::vec2& min, const glm::vec2& max)
+{
+	CenterX[index] = (min.x + max.x) * 0.5f; CenterY[index] = (min.y + max.y) * 0.5f;
+	ExtentX[index] = (max.x - min.x) * 0.5f; ExtentY[index] = (max.y - min.y) * 0.5f;
+}
+
+void AABBList::Resize(unsigned int count)
+{
+	CenterX.resize(count); CenterY.resize(count); CenterZ.resize(count);
+	ExtentX.resize(count); ExtentY.resize(count); ExtentZ.resize(count);
+}
+
+void AABBList::Set(unsigned int index, const glm::vec3& min, const glm::vec3& max)
+{
+	CenterX[index] = (min.x + max.x) * 0.5f; CenterY[index] = (min.y + max.y) * 0.5f; CenterZ[index] = (min.z + max.z) * 0.5f;
+	ExtentX[index] = (max.x - min.x) * 0.5f; ExtentY[index] = (max.y - min.y) * 0.5f; ExtentZ[index] = (max.z - min.z) * 0.5f;
+}
+
+void SphereList::Resize(unsigned int count)
+{
+	CenterX.resize(count); CenterY.resize(count); CenterZ.resize(count);
+	Radius.resize(count);
+}
+
+void SphereList::Set(unsigned int index, const glm::vec3& center, float radius)
+{
+	CenterX[index] = center.x; CenterY[index] = center.y; CenterZ[index] = center.z;
+	Radius[index] = radius;
+}
+
+namespace {
+
+	// A box is outside when even its corner furthest along the plane normal is behind
+	// the plane: dot(n, c) + d + dot(|n|, e) < 0. A sphere when dot(n, c) + d + r < 0.
+
+	struct Scalar
+	{
+		typedef float Vector;
+		static const unsigned int Width = 1;
+
+		static inline Vector Set(float value) { return value; }
+		static inline Vector Load(const float* data) { return *data; }
+		static inline Vector Add(Vector a, Vector b) { return a + b; }
+		static inline Vector Mul(Vector a, Vector b) { return a * b; }
+		static inline Vector True() { return 1.0f; }
+		static inline Vector AndGreaterEqualZero(Vector mask, Vector value) { return value >= 0.0f ? mask : 0.0f; }
+		static inline unsigned int MoveMask(Vector mask) { return mask != 0.0f ? 1 : 0; }
+	};
+
+#ifdef CULLING_SSE
+	struct SSE
+	{
+		typedef __m128 Vector;
+		static const unsigned int Width = 4;
+
+		static inline Vector Set(float value) { return _mm_set1_ps(value); }
+		static inline Vector Load(const float* data) { return _mm_loadu_ps(data); }
+		static inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+		static inline Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+		static inline Vector True() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+		static inline Vector AndGreaterEqualZero(Vector mask, Vector value) { return _mm_and_ps(mask, _mm_cmpge_ps(value, _mm_setzero_ps())); }
+		static inline unsigned int MoveMask(Vector mask) { return (unsigned int)_mm_movemask_ps(mask); }
+	};
+#endif
+
+#ifdef CULLING_AVX
+	struct AVX
+	{
+		typedef __m256 Vector;
+		static const unsigned int Width = 8;
+
+		static inline Vector Set(float value) { return _mm256_set1_ps(value); }
+		static inline Vector Load(const float* data) { return _mm256_loadu_ps(data); }
+		static inline Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+		static inline Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+		static inline Vector True() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+		static inline Vector AndGreaterEqualZero(Vector mask, Vector value) { return _mm256_and_ps(mask, _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_GE_OQ)); }
+		static inline unsigned int MoveMask(Vector mask) { return (unsigned int)_mm256_movemask_ps(mask); }
+	};
+#endif
+
+	// Appends the lanes set in mask without branching on them
+	template<typename S>
+	inline unsigned int AppendVisible(unsigned int mask, unsigned int first, unsigned int* visible, unsigned int count)
+	{
+		for (unsigned int lane = 0; lane < S::Width; lane++)
+		{
+			visible[count] = first + lane;
+			count += (mask >> lane) & 1;
+		}
+		return count;
+	}
+
+	template<typename S>
+	unsigned int CullAABBs2DKernel(const Frustum& frustum, const AABBList2D& bounds, unsigned int& i, unsigned int end, unsigned int* visible)
+	{
+		typename S::Vector a[6], b[6], d[6], absA[6], absB[6];
+		for (int p = 0; p < 6; p++)
+		{
+			const glm::vec4& plane = frustum.Planes[p];
+			a[p] = S::Set(plane.x); b[p] = S::Set(plane.y); d[p] = S::Set(plane.w);
+			absA[p] = S::Set(std::fabs(plane.x)); absB[p] = S::Set(std::fabs(plane.y));
+		}
+
+		unsigned int count = 0;
+		for (; i + S::Width <= end; i += S::Width)
+		{
+			typename S::Vector cx = S::Load(&bounds.CenterX[i]), cy = S::Load(&bounds.CenterY[i]);
+			typename S::Vector ex = S::Load(&bounds.ExtentX[i]), ey = S::Load(&bounds.ExtentY[i]);
+
+			typename S::Vector inside = S::True();
+			for (int p = 0; p < 6; p++)
+			{
+				typename S::Vector distance = S::Add(S::Add(S::Mul(a[p], cx), S::Mul(b[p], cy)), d[p]);
+				distance = S::Add(distance, S::Add(S::Mul(absA[p], ex), S::Mul(absB[p], ey)));
+				inside = S::AndGreaterEqualZero(inside, distance);
+			}
+
+			count = AppendVisible<S>(S::MoveMask(inside), i, visible, count);
+		}
+		return count;
+	}
+
+	template<typename S>
+	unsigned int CullAABBsKernel(const Frustum& frustum, const AABBList& bounds, unsigned int& i, unsigned int end, unsigned int* visible)
+	{
+		typename S::Vector a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+		for (int p = 0; p < 6; p++)
+		{
+			const glm::vec4& plane = frustum.Planes[p];
+			a[p] = S::Set(plane.x); b[p] = S::Set(plane.y); c[p] = S::Set(plane.z); d[p] = S::Set(plane.w);
+			absA[p] = S::Set(std::fabs(plane.x)); absB[p] = S::Set(std::fabs(plane.y)); absC[p] = S::Set(std::fabs(plane.z));
+		}
+
+		unsigned int count = 0;
+		for (; i + S::Width <= end; i += S::Width)
+		{
+			typename S::Vector cx = S::Load(&bounds.CenterX[i]), cy = S::Load(&bounds.CenterY[i]), cz = S::Load(&bounds.CenterZ[i]);
+			typename S::Vector ex = S::Load(&bounds.ExtentX[i]), ey = S::Load(&bounds.ExtentY[i]), ez = S::Load(&bounds.ExtentZ[i]);
+
+			typename S::Vector inside = S::True();
+			for (int p = 0; p < 6; p++)
+			{
+				typename S::Vector distance = S::Add(S::Add(S::Mul(a[p], cx), S::Mul(b[p], cy)), S::Add(S::Mul(c[p], cz), d[p]));
+				distance = S::Add(distance, S::Add(S::Add(S::Mul(absA[p], ex), S::Mul(absB[p], ey)), S::Mul(absC[p], ez)));
+				inside = S::AndGreaterEqualZero(inside, distance);
+			}
+
+			count = AppendVisible<S>(S::MoveMask(inside), i, visible, count);
+		}
+		return count;
+	}
+
+	template<typename S>
+	unsigned int CullSpheresKernel(const Frustum& frustum, const SphereList& spheres, unsigned int& i, unsigned int end, unsigned int* visible)
+	{
+		typename S::Vector a[6], b[6], c[6], d[6];
+		for (int p = 0; p < 6; p++)
+		{
+			const glm::vec4& plane = frustum.Planes[p];
+			a[p] = S::Set(plane.x); b[p] = S::Set(plane.y); c[p] = S::Set(plane.z); d[p] = S::Set(plane.w);
+		}
+
+		unsigned int count = 0;
+		for (; i + S::Width <= end; i += S::Width)
+		{
+			typename S::Vector cx = S::Load(&spheres.CenterX[i]), cy = S::Load(&spheres.CenterY[i]), cz = S::Load(&spheres.CenterZ[i]);
+			typename S::Vector r = S::Load(&spheres.Radius[i]);
+
+			typename S::Vector inside = S::True();
+			for (int p = 0; p < 6; p++)
+			{
+				typename S::Vector distance = S::Add(S::Add(S::Mul(a[p], cx), S::Mul(b[p], cy)), S::Add(S::Mul(c[p], cz), d[p]));
+				inside = S::AndGreaterEqualZero(inside, S::Add(distance, r));
+			}
+
+			count = AppendVisible<S>(S::MoveMask(inside), i, visible, count);
+		}
+		return count;
+	}
+
+}
+
+// Each kernel advances i past the objects it handled, so the widest one runs
+// first and narrower ones pick up the remainder
+#if defined(CULLING_AVX)
+#define CULLING_DISPATCH(kernel, frustum, list, i, end, visible, count) \
+	if (s_UseSIMD) { count += kernel<AVX>(frustum, list, i, end, visible + count); count += kernel<SSE>(frustum, list, i, end, visible + count); } \
+	count += kernel<Scalar>(frustum, list, i, end, visible + count)
+#elif defined(CULLING_SSE)
+#define CULLING_DISPATCH(kernel, frustum, list, i, end, visible, count) \
+	if (s_UseSIMD) { count += kernel<SSE>(frustum, list, i, end, visible + count); } \
+	count += kernel<Scalar>(frustum, list, i, end, visible + count)
+#else
+#define CULLING_DISPATCH(kernel, frustum, list, i, end, visible, count) \
+	count += kernel<Scalar>(frustum, list, i, end, visible + count)
+#endif
+
+unsigned int Culling::CullAABBs2D(const Frustum& frustum, const AABBList2D& bounds, unsigned int begin, unsigned int end, unsigned int* visible)
+{
+	unsigned int i = begin;
+	unsigned int count = 0;
+	CULLING_DISPATCH(CullAABBs2DKernel, frustum, bounds, i, end, visible, count);
+	s_Tested.fetch_add(end - begin, std::memory_order_relaxed);
+	s_Visible.fetch_add(count, std::memory_order_relaxed);
+	return count;
+}
+
+unsigned int Culling::CullAABBs(const Frustum& frustum, const AABBList& bounds, unsigned int begin, unsigned int end, unsigned int* visible)
+{
+	unsigned int i = begin;
+	unsigned int count = 0;
+	CULLING_DISPATCH(CullAABBsKernel, frustum, bounds, i, end, visible, count);
+	s_Tested.fetch_add(end - begin, std::memory_order_relaxed);
+	s_Visible.fetch_add(count, std::memory_order_relaxed);
+	return count;
+}
+
+unsigned int Culling::CullSpheres(const Frustum& frustum, const SphereList& spheres, unsigned int begin, unsigned int end, unsigned int* visible)
+{
+	unsigned int i = begin;
+	unsigned int count = 0;
+	CULLING_DISPATCH(CullSpheresKernel, frustum, spheres, i, end, visible, count);
+	s_Tested.fetch_add(end - begin, std::memory_order_relaxed);
+	s_Visible.fetch_add(count, std::memory_order_relaxed);
+	return count;
+}
+
+bool Culling::IsVisible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max)
+{
+	glm::vec3 center = (min + max) * 0.5f;
+	glm::vec3 extent = (max - min) * 0.5f;
+
+	bool visible = true;
+	for (const glm::vec4& plane : frustum.Planes)
+	{
+		float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		distance += std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+		if (distance < 0.0f)
+		{
+			visible = false;
+			break;
+		}
+	}
+
+	s_Tested.fetch_add(1, std::memory_order_relaxed);
+	if (visible)
+		s_Visible.fetch_add(1, std::memory_order_relaxed);
+	return visible;
+}
+
+Culling::Stats Culling::GetStats()
+{
+	Stats stats;
+	stats.Tested = s_LastTested.load(std::memory_order_relaxed);
+	stats.Visible = s_LastVisible.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void Culling::EndFrame()
+{
+	s_LastTested.store(s_Tested.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	s_LastVisible.store(s_Visible.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void Culling::SetUseSIMD(bool useSIMD)
+{
+	s_UseSIMD = useSIMD;
+}
+
+const char* Culling::GetInstructionSet()
+{
+	if (!s_UseSIMD)
+		return "Scalar";
+#if defined(CULLING_AVX)
+	return "AVX";
+#elif defined(CULLING_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Planes of a view-projection frustum, pointing inwards and normalized
+struct Frustum
+{
+	glm::vec4 Planes[6];
+
+	Frustum(const glm::mat4& viewProjection);
+};
+
+// Bounds are kept as structures of arrays so one SSE/AVX instruction tests
+// four or eight objects against a plane at a time.
+struct AABBList2D
+{
+	std::vector<float> CenterX, CenterY;
+	std::vector<float> ExtentX, ExtentY;
+
+	void Resize(unsigned int count);
+	void Set(unsigned int index, const glm::vec2& min, const glm::vec2& max);
+	inline unsigned int GetCount() const { return (unsigned int)CenterX.size(); }
+};
+
+struct AABBList
+{
+	std::vector<float> CenterX, CenterY, CenterZ;
+	std::vector<float> ExtentX, ExtentY, ExtentZ;
+
+	void Resize(unsigned int count);
+	void Set(unsigned int index, const glm::vec3& min, const glm::vec3& max);
+	inline unsigned int GetCount() const { return (unsigned int)CenterX.size(); }
+};
+
+struct SphereList
+{
+	std::vector<float> CenterX, CenterY, CenterZ;
+	std::vector<float> Radius;
+
+	void Resize(unsigned int count);
+	void Set(unsigned int index, const glm::vec3& center, float radius);
+	inline unsigned int GetCount() const { return (unsigned int)CenterX.size(); }
+};
+
+// Tests bounds in [begin, end) against a frustum and writes the indices of the
+// visible ones to visible, which needs room for end - begin entries. Returns the
+// number of visible indices. Uses AVX when the build targets it, SSE otherwise,
+// and plain C++ on other architectures or when SIMD is turned off.
+class Culling
+{
+public:
+	struct Stats
+	{
+		unsigned int Tested = 0;
+		unsigned int Visible = 0;
+
+		inline unsigned int GetCulled() const { return Tested - Visible; }
+	};
+
+private:
+	static bool s_UseSIMD;
+	// Counted from any thread that culls
+	static std::atomic<unsigned int> s_Tested;
+	static std::atomic<unsigned int> s_Visible;
+	static std::atomic<unsigned int> s_LastTested;
+	static std::atomic<unsigned int> s_LastVisible;
+
+public:
+	static unsigned int CullAABBs2D(const Frustum& frustum, const AABBList2D& bounds, unsigned int begin, unsigned int end, unsigned int* visible);
+	static unsigned int CullAABBs(const Frustum& frustum, const AABBList& bounds, unsigned int begin, unsigned int end, unsigned int* visible);
+	static unsigned int CullSpheres(const Frustum& frustum, const SphereList& spheres, unsigned int begin, unsigned int end, unsigned int* visible);
+	// One box at a time, for culling while submitting
+	static bool IsVisible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max);
+
+	// Objects tested and found visible by the functions above between the last two
+	// EndFrame calls, so a frame in progress never shows half counted
+	static Stats GetStats();
+	static void EndFrame();
+
+	static void SetUseSIMD(bool useSIMD);
+	static inline bool GetUseSIMD() { return s_UseSIMD; }
+	static const char* GetInstructionSet();
+};
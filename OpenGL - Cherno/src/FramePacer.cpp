@@ -0,0 +1,227 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "Renderer.h"
+#include "RenderThread.h"
+
+#include "GLFW/glfw3.h"
+
+FramePacer::FramePacer(PresentMode mode, float targetRate)
+	: m_Mode(mode), m_TargetRate(60.0f), m_NextFrameTime(0.0), m_InputTime(glfwGetTime()),
+	  m_PresentMode(mode), m_SwapInterval(-1), m_FrameInputTime(m_InputTime), m_ClockOffset(0.0),
+	  m_PresentCount(0), m_PreviousFence(nullptr), m_NextPresent(0),
+	  m_HistoryIndex(0), m_HistoryCount(0)
+{
+	std::memset(m_History, 0, sizeof(m_History));
+	SetTargetRate(targetRate);
+
+	for (PendingPresent& present : m_Presents)
+	{
+		GLCall(glGenQueries(1, &present.Query));
+		present.InputTime = 0.0;
+		present.Pending = false;
+	}
+
+	CalibrateClock();
+}
+
+FramePacer::~FramePacer()
+{
+	if (m_PreviousFence)
+	{
+		GLCall(glDeleteSync(m_PreviousFence));
+	}
+
+	for (PendingPresent& present : m_Presents)
+	{
+		GLCall(glDeleteQueries(1, &present.Query));
+	}
+}
+
+void FramePacer::CalibrateClock()
+{
+	// GPU timestamps are in nanoseconds on their own clock
+	GLint64 gpuTime;
+	GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuTime));
+	m_ClockOffset = glfwGetTime() - gpuTime * 1e-9;
+}
+
+void FramePacer::Throttle()
+{
+	if (m_Mode != PresentMode::FixedRate)
+	{
+		m_NextFrameTime = 0.0;
+		return;
+	}
+
+	double period = 1.0 / m_TargetRate;
+	double now = glfwGetTime();
+
+	// Sleeping is coarse, so sleep most of the way and spin for the rest
+	double remaining = m_NextFrameTime - now;
+	if (remaining > 0.002)
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.002));
+	while ((now = glfwGetTime()) < m_NextFrameTime)
+		std::this_thread::yield();
+
+	// After a long frame start over instead of rushing to catch up
+	m_NextFrameTime = now - m_NextFrameTime > period ? now + period : m_NextFrameTime + period;
+}
+
+void FramePacer::OnInputPolled()
+{
+	m_InputTime = glfwGetTime();
+}
+
+void FramePacer::RecordFrame(RenderThread& renderThread)
+{
+	double inputTime = m_InputTime;
+	PresentMode mode = m_Mode;
+	renderThread.Record([this, inputTime, mode]() {
+		m_FrameInputTime = inputTime;
+		m_PresentMode = mode;
+
+		// The swap interval belongs to the context, so it is set on the GL thread
+		int swapInterval = (mode == PresentMode::VSync || mode == PresentMode::LowLatency) ? 1 : 0;
+		if (swapInterval != m_SwapInterval)
+		{
+			glfwSwapInterval(swapInterval);
+			m_SwapInterval = swapInterval;
+		}
+	});
+}
+
+void FramePacer::ResolvePresent(PendingPresent& present, bool wait)
+{
+	if (!present.Pending)
+		return;
+
+	if (!wait)
+	{
+		GLuint available = 0;
+		GLCall(glGetQueryObjectuiv(present.Query, GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available)
+			return;
+	}
+
+	GLuint64 gpuTime = 0;
+	GLCall(glGetQueryObjectui64v(present.Query, GL_QUERY_RESULT, &gpuTime));
+	present.Pending = false;
+
+	double presentTime = gpuTime * 1e-9 + m_ClockOffset;
+	AddLatency((float)((presentTime - present.InputTime) * 1000.0));
+}
+
+void FramePacer::OnPresent()
+{
+	// Resolve in submission order so the history stays in order
+	for (unsigned int i = 0; i < s_QueryCount; i++)
+		ResolvePresent(m_Presents[(m_NextPresent + i) % s_QueryCount], false);
+
+	// Only blocks if the GPU is a whole ring of frames behind
+	PendingPresent& present = m_Presents[m_NextPresent];
+	ResolvePresent(present, true);
+	GLCall(glQueryCounter(present.Query, GL_TIMESTAMP));
+	present.InputTime = m_FrameInputTime;
+	present.Pending = true;
+	m_NextPresent = (m_NextPresent + 1) % s_QueryCount;
+
+	// Waiting for the previous frame leaves at most this one queued, so input for
+	// the next frame is sampled as late as possible instead of frames ahead
+	GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	if (m_PreviousFence)
+	{
+		if (m_PresentMode == PresentMode::LowLatency)
+		{
+			GLenum result;
+			do
+			{
+				result = glClientWaitSync(m_PreviousFence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+		GLCall(glDeleteSync(m_PreviousFence));
+	}
+	m_PreviousFence = fence;
+
+	// The two clocks drift apart slowly
+	if (++m_PresentCount % 600 == 0)
+		CalibrateClock();
+}
+
+void FramePacer::AddLatency(float latencyMs)
+{
+	std::lock_guard<std::mutex> lock(m_StatsMutex);
+
+	m_History[m_HistoryIndex] = latencyMs;
+	m_HistoryIndex = (m_HistoryIndex + 1) % HistorySize;
+	m_HistoryCount = std::min(m_HistoryCount + 1, HistorySize);
+
+	float total = 0.0f;
+	float maximum = 0.0f;
+	for (unsigned int i = 0; i < m_HistoryCount; i++)
+	{
+		total += m_History[i];
+		maximum = std::max(maximum, m_History[i]);
+	}
+
+	m_Stats.LastMs = latencyMs;
+	m_Stats.AverageMs = total / m_HistoryCount;
+	m_Stats.MaxMs = maximum;
+}
+
+void FramePacer::SetMode(PresentMode mode)
+{
+	m_Mode = mode;
+}
+
+void FramePacer::SetTargetRate(float rate)
+{
+	// Written this way round so NaN ends up at the minimum too
+	m_TargetRate = rate >= 1.0f ? rate : 1.0f;
+}
+
+FramePacer::LatencyStats FramePacer::GetLatencyStats() const
+{
+	std::lock_guard<std::mutex> lock(m_StatsMutex);
+	return m_Stats;
+}
+
+void FramePacer::GetLatencyHistory(std::vector<float>& history) const
+{
+	std::lock_guard<std::mutex> lock(m_StatsMutex);
+
+	history.clear();
+	unsigned int start = (m_HistoryIndex + HistorySize - m_HistoryCount) % HistorySize;
+	for (unsigned int i = 0; i < m_HistoryCount; i++)
+		history.push_back(m_History[(start + i) % HistorySize]);
+}
+
+const char* FramePacer::GetModeName(PresentMode mode)
+{
+	switch (mode)
+	{
+		case PresentMode::VSync:      return "vsync";
+		case PresentMode::Uncapped:   return "uncapped";
+		case PresentMode::FixedRate:  return "fixed";
+		case PresentMode::LowLatency: return "low-latency";
+	}
+	return "unknown";
+}
+
+bool FramePacer::ParseMode(const char* name, PresentMode& mode)
+{
+	const PresentMode modes[] = { PresentMode::VSync, PresentMode::Uncapped, PresentMode::FixedRate, PresentMode::LowLatency };
+	for (PresentMode candidate : modes)
+	{
+		if (std::strcmp(name, GetModeName(candidate)) == 0)
+		{
+			mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
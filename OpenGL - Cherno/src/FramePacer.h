@@ -0,0 +1,102 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+class RenderThread;
+typedef struct __GLsync* GLsync;
+
+enum class PresentMode
+{
+	VSync,      // Swap interval 1, the driver decides how many frames queue up
+	Uncapped,   // Swap interval 0, as fast as possible
+	FixedRate,  // Swap interval 0, the main thread sleeps to hit a target rate
+	LowLatency  // Swap interval 1, and a fence keeps at most one frame queued. With
+	            // the render thread the main thread still records one frame ahead
+};
+
+// Paces the main loop and measures input-to-present latency. Input time is taken
+// when events are polled, present time from a GL_TIMESTAMP query written right
+// after the swap and mapped onto the CPU clock. With vsync that is when the swap
+// was processed, not when the image reached the screen, so it is a lower bound.
+//
+// Throttle, OnInputPolled, SetMode and RecordFrame are called on the main thread,
+// OnPresent on the thread that owns the GL context after every swap. Construct
+// and destroy it while the context is current.
+class FramePacer
+{
+public:
+	struct LatencyStats
+	{
+		float LastMs = 0.0f;
+		float AverageMs = 0.0f;
+		float MaxMs = 0.0f;
+	};
+
+	static const unsigned int HistorySize = 120;
+
+private:
+	struct PendingPresent
+	{
+		unsigned int Query;
+		double InputTime;
+		bool Pending;
+	};
+
+	static const unsigned int s_QueryCount = 8;
+
+	// Main thread
+	PresentMode m_Mode;
+	float m_TargetRate;
+	double m_NextFrameTime;
+	double m_InputTime;
+
+	// GL thread
+	PresentMode m_PresentMode;
+	int m_SwapInterval;
+	double m_FrameInputTime;
+	double m_ClockOffset;
+	unsigned int m_PresentCount;
+	GLsync m_PreviousFence;
+	PendingPresent m_Presents[s_QueryCount];
+	unsigned int m_NextPresent;
+
+	// Shared
+	mutable std::mutex m_StatsMutex;
+	float m_History[HistorySize];
+	unsigned int m_HistoryIndex;
+	unsigned int m_HistoryCount;
+	LatencyStats m_Stats;
+
+	void CalibrateClock();
+	void ResolvePresent(PendingPresent& present, bool wait);
+	void AddLatency(float latencyMs);
+
+public:
+	FramePacer(PresentMode mode = PresentMode::VSync, float targetRate = 60.0f);
+	~FramePacer();
+
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	// Blocks until the next frame is due, only does anything in FixedRate mode
+	void Throttle();
+	void OnInputPolled();
+
+	// Hands the frame's input time and the present mode to the GL thread
+	void RecordFrame(RenderThread& renderThread);
+	void OnPresent();
+
+	void SetMode(PresentMode mode);
+	// Frames per second, at least 1
+	void SetTargetRate(float rate);
+	inline PresentMode GetMode() const { return m_Mode; }
+	inline float GetTargetRate() const { return m_TargetRate; }
+
+	LatencyStats GetLatencyStats() const;
+	// Oldest first
+	void GetLatencyHistory(std::vector<float>& history) const;
+
+	static const char* GetModeName(PresentMode mode);
+	static bool ParseMode(const char* name, PresentMode& mode);
+};
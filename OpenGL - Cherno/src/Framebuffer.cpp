@@ -0,0 +1,43 @@
+#include "Framebuffer.h"
+
+#include "Renderer.h"
+
+Framebuffer::Framebuffer(int width, int height)
+	: m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_Width(width), m_Height(height)
+{
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+	// Nothing samples from the attachments, so renderbuffers are enough
+	GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+	GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+	GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+
+	GLCall(glGenRenderbuffers(1, &m_DepthAttachment));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment));
+	GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+	GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment));
+
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+	ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer()
+{
+	GLCall(glDeleteRenderbuffers(1, &m_DepthAttachment));
+	GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+}
+
+void Framebuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::Unbind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
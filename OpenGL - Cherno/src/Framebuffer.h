@@ -0,0 +1,23 @@
+#pragma once
+
+// Offscreen render target with an RGBA8 color and a depth/stencil renderbuffer,
+// for rendering without a window
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment;
+	unsigned int m_DepthAttachment;
+	int m_Width, m_Height;
+
+public:
+	Framebuffer(int width, int height);
+	~Framebuffer();
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
@@ -0,0 +1,117 @@
+#include "GLDebug.h"
+
+#include <iostream>
+
+#include "Renderer.h"
+
+std::atomic<const GLCallSite*> GLDebug::s_CallSite(nullptr);
+// Check every call until Init knows whether debug output is available
+unsigned int GLDebug::s_SampleInterval = 1;
+unsigned int GLDebug::s_SampleCounter = 0;
+bool GLDebug::s_DebugOutput = false;
+bool GLDebug::s_Synchronous = false;
+
+static const char* GetSourceName(GLenum source)
+{
+	switch (source)
+	{
+		case GL_DEBUG_SOURCE_API:             return "API";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "Window system";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY:     return "Third party";
+		case GL_DEBUG_SOURCE_APPLICATION:     return "Application";
+		default:                              return "Other";
+	}
+}
+
+static const char* GetTypeName(GLenum type)
+{
+	switch (type)
+	{
+		case GL_DEBUG_TYPE_ERROR:               return "Error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "Undefined behavior";
+		case GL_DEBUG_TYPE_PORTABILITY:         return "Portability";
+		case GL_DEBUG_TYPE_PERFORMANCE:         return "Performance";
+		default:                                return "Other";
+	}
+}
+
+static void GLAPIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum /*severity*/,
+	GLsizei /*length*/, const GLchar* message, const void* userParam)
+{
+	const GLCallSite* site = *(const std::atomic<const GLCallSite*>*)userParam;
+
+	std::cout << "[OpenGL " << GetTypeName(type) << "] (" << GetSourceName(source) << " " << id << ") " << message << std::endl;
+	if (site)
+	{
+		std::cout << "    " << (GLDebug::IsSynchronous() ? "at " : "near ") << site->Function
+			<< " " << site->File << ":" << site->Line << std::endl;
+	}
+
+	// Only a synchronous message is raised on the stack of the failing call
+	if (type == GL_DEBUG_TYPE_ERROR && GLDebug::IsSynchronous())
+	{
+		ASSERT(false);
+	}
+}
+
+bool GLDebug::Init(bool synchronous, unsigned int sampleInterval)
+{
+	s_Synchronous = synchronous;
+
+	GLint flags = 0;
+	GLCall(glGetIntegerv(GL_CONTEXT_FLAGS, &flags));
+	if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT))
+		std::cout << "Not a debug context, the driver may not report everything" << std::endl;
+
+	if (GLEW_VERSION_4_3 || GLEW_KHR_debug)
+	{
+		GLCall(glEnable(GL_DEBUG_OUTPUT));
+		if (synchronous)
+		{
+			GLCall(glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS));
+		}
+		GLCall(glDebugMessageCallback(DebugMessageCallback, &s_CallSite));
+		// Notifications are chatty (buffer placement and the like) and rarely useful
+		GLCall(glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE));
+		s_DebugOutput = true;
+	}
+	else if (GLEW_ARB_debug_output)
+	{
+		if (synchronous)
+		{
+			GLCall(glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB));
+		}
+		GLCall(glDebugMessageCallbackARB(DebugMessageCallback, &s_CallSite));
+		s_DebugOutput = true;
+	}
+
+	s_SampleInterval = s_DebugOutput ? 0 : sampleInterval;
+	s_SampleCounter = 0;
+
+	std::cout << "GL errors: " << (s_DebugOutput ? (synchronous ? "synchronous debug output" : "asynchronous debug output")
+		: "glGetError sampling") << std::endl;
+	return s_DebugOutput;
+}
+
+void GLDebug::CheckError()
+{
+	s_SampleCounter = 0;
+
+	bool failed = false;
+	while (GLenum error = glGetError())
+	{
+		const GLCallSite* site = s_CallSite.load(std::memory_order_relaxed);
+		std::cout << "[OpenGL Error] (" << error << ") at or before " << (site ? site->Function : "?")
+			<< " " << (site ? site->File : "?") << ":" << (site ? site->Line : 0) << std::endl;
+		failed = true;
+	}
+	ASSERT(!failed);
+}
+
+void GLDebug::SetSampleInterval(unsigned int interval)
+{
+	s_SampleInterval = interval;
+	s_SampleCounter = 0;
+}
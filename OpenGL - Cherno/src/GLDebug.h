@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+
+struct GLCallSite
+{
+	const char* Function;
+	const char* File;
+	int Line;
+};
+
+// GL error reporting for GLCall. With KHR_debug (or ARB_debug_output) the driver
+// reports errors through a callback and GLCall only remembers its call site, one
+// atomic store. Asynchronous output is the default and costs nothing on the GL
+// thread, but the reported site is just the last GLCall issued before the
+// message arrived. Synchronous output reports the exact site at some cost.
+//
+// Without debug output, glGetError is checked on one in every SampleInterval
+// calls, and an error is reported as happening at or before that site.
+class GLDebug
+{
+private:
+	static std::atomic<const GLCallSite*> s_CallSite;
+	static unsigned int s_SampleInterval;
+	static unsigned int s_SampleCounter;
+	static bool s_DebugOutput;
+	static bool s_Synchronous;
+
+	static void CheckError();
+
+public:
+	// Needs a current context, ideally created with GLFW_OPENGL_DEBUG_CONTEXT.
+	// Returns false when neither extension is there and sampling is used instead.
+	static bool Init(bool synchronous, unsigned int sampleInterval);
+
+	static inline void SetCallSite(const GLCallSite* site)
+	{
+		s_CallSite.store(site, std::memory_order_relaxed);
+	}
+
+	static inline void SampleError()
+	{
+		if (s_SampleInterval != 0 && ++s_SampleCounter >= s_SampleInterval)
+			CheckError();
+	}
+
+	static void SetSampleInterval(unsigned int interval);
+	static inline unsigned int GetSampleInterval() { return s_SampleInterval; }
+	static inline bool IsDebugOutputEnabled() { return s_DebugOutput; }
+	static inline bool IsSynchronous() { return s_Synchronous; }
+};
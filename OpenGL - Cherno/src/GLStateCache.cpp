@@ -0,0 +1,175 @@
+#include "GLStateCache.h"
+
+#include "Renderer.h"
+
+unsigned int GLStateCache::s_Program = GLStateCache::s_Unknown;
+unsigned int GLStateCache::s_VertexArray = GLStateCache::s_Unknown;
+unsigned int GLStateCache::s_Buffers[GLStateCache::BufferSlotCount];
+GLStateCache::VertexBufferBinding GLStateCache::s_VertexBuffers[GLStateCache::MaxVertexBufferBindings];
+unsigned int GLStateCache::s_ActiveTextureUnit = GLStateCache::s_Unknown;
+unsigned int GLStateCache::s_Textures[GLStateCache::MaxTextureUnits];
+GLStateCache::Stats GLStateCache::s_Stats;
+
+int GLStateCache::GetBufferSlot(unsigned int target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:			return ArrayBufferSlot;
+	case GL_ELEMENT_ARRAY_BUFFER:	return ElementArrayBufferSlot;
+	case GL_DRAW_INDIRECT_BUFFER:	return DrawIndirectBufferSlot;
+	}
+	return -1;
+}
+
+void GLStateCache::ForgetVertexArrayBindings()
+{
+	s_Buffers[ElementArrayBufferSlot] = s_Unknown;
+	for (VertexBufferBinding& binding : s_VertexBuffers)
+		binding.Buffer = s_Unknown;
+}
+
+bool GLStateCache::Update(unsigned int& cached, unsigned int value)
+{
+	s_Stats.Calls++;
+	if (cached == value)
+	{
+		s_Stats.Skipped++;
+		return false;
+	}
+
+	cached = value;
+	return true;
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+	if (Update(s_Program, program))
+	{
+		GLCall(glUseProgram(program));
+	}
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+	if (Update(s_VertexArray, vertexArray))
+	{
+		GLCall(glBindVertexArray(vertexArray));
+		// The element and vertex buffer bindings belong to the vertex array we just switched to
+		ForgetVertexArrayBindings();
+	}
+}
+
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	int slot = GetBufferSlot(target);
+	if (slot < 0)
+	{
+		s_Stats.Calls++;
+		GLCall(glBindBuffer(target, buffer));
+		return;
+	}
+
+	if (Update(s_Buffers[slot], buffer))
+	{
+		GLCall(glBindBuffer(target, buffer));
+	}
+}
+
+void GLStateCache::BindVertexBuffer(unsigned int binding, unsigned int buffer, intptr_t offset, unsigned int stride)
+{
+	ASSERT(binding < MaxVertexBufferBindings);
+	s_Stats.Calls++;
+
+	VertexBufferBinding& cached = s_VertexBuffers[binding];
+	if (cached.Buffer == buffer && cached.Offset == offset && cached.Stride == stride)
+	{
+		s_Stats.Skipped++;
+		return;
+	}
+
+	cached = { buffer, offset, stride };
+	GLCall(glBindVertexBuffer(binding, buffer, offset, stride));
+}
+
+void GLStateCache::ActiveTexture(unsigned int unit)
+{
+	if (Update(s_ActiveTextureUnit, unit))
+	{
+		GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+	}
+}
+
+void GLStateCache::BindTexture(unsigned int unit, unsigned int texture)
+{
+	ASSERT(unit < MaxTextureUnits);
+
+	if (Update(s_Textures[unit], texture))
+	{
+		ActiveTexture(unit);
+		GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+	}
+}
+
+void GLStateCache::BindTextureForEdit(unsigned int unit, unsigned int texture)
+{
+	ActiveTexture(unit);
+	BindTexture(unit, texture);
+}
+
+void GLStateCache::OnDeleteProgram(unsigned int program)
+{
+	// A program in use is only flagged for deletion, so its binding is not reset
+	if (s_Program == program)
+		s_Program = s_Unknown;
+}
+
+void GLStateCache::OnDeleteVertexArray(unsigned int vertexArray)
+{
+	if (s_VertexArray == vertexArray)
+	{
+		s_VertexArray = 0;
+		ForgetVertexArrayBindings();
+	}
+}
+
+void GLStateCache::OnDeleteBuffer(unsigned int buffer)
+{
+	for (unsigned int& bound : s_Buffers)
+	{
+		if (bound == buffer)
+			bound = 0;
+	}
+	// Only the bound vertex array loses its binding, others keep a dangling one
+	for (VertexBufferBinding& binding : s_VertexBuffers)
+	{
+		if (binding.Buffer == buffer)
+			binding.Buffer = s_Unknown;
+	}
+}
+
+void GLStateCache::OnDeleteTexture(unsigned int texture)
+{
+	for (unsigned int& bound : s_Textures)
+	{
+		if (bound == texture)
+			bound = 0;
+	}
+}
+
+void GLStateCache::Invalidate()
+{
+	s_Program = s_Unknown;
+	s_VertexArray = s_Unknown;
+	for (unsigned int& bound : s_Buffers)
+		bound = s_Unknown;
+	for (VertexBufferBinding& binding : s_VertexBuffers)
+		binding.Buffer = s_Unknown;
+	s_ActiveTextureUnit = s_Unknown;
+	for (unsigned int& bound : s_Textures)
+		bound = s_Unknown;
+}
+
+void GLStateCache::ResetStats()
+{
+	s_Stats = Stats();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+// Shadow copy of the GL binding state so redundant binds never reach the driver.
+// All GL binding in the renderer goes through here. Code that touches GL state
+// behind its back (e.g. the ImGui OpenGL3 backend) must call Invalidate afterwards.
+// The cache mirrors a single context, must only be used from the thread that
+// owns it and needs an Invalidate once that context is current.
+class GLStateCache
+{
+public:
+	struct Stats
+	{
+		unsigned int Calls = 0;
+		unsigned int Skipped = 0;
+	};
+
+	static const unsigned int MaxTextureUnits = 32;
+	static const unsigned int MaxVertexBufferBindings = 16;
+
+private:
+	enum BufferSlot
+	{
+		ArrayBufferSlot = 0, ElementArrayBufferSlot, DrawIndirectBufferSlot, BufferSlotCount
+	};
+
+	struct VertexBufferBinding
+	{
+		unsigned int Buffer;
+		intptr_t Offset;
+		unsigned int Stride;
+	};
+
+	static const unsigned int s_Unknown = ~0u;
+
+	static unsigned int s_Program;
+	static unsigned int s_VertexArray;
+	static unsigned int s_Buffers[BufferSlotCount];
+	// Vertex buffer bindings belong to the bound vertex array like the element buffer
+	static VertexBufferBinding s_VertexBuffers[MaxVertexBufferBindings];
+	static unsigned int s_ActiveTextureUnit;
+	static unsigned int s_Textures[MaxTextureUnits];
+	static Stats s_Stats;
+
+	static int GetBufferSlot(unsigned int target);
+	static void ForgetVertexArrayBindings();
+	static bool Update(unsigned int& cached, unsigned int value);
+
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+	static void BindVertexBuffer(unsigned int binding, unsigned int buffer, intptr_t offset, unsigned int stride);
+	static void ActiveTexture(unsigned int unit);
+	static void BindTexture(unsigned int unit, unsigned int texture);
+	// For editing a texture: GL edits the one bound on the active unit, so the
+	// unit is selected even when the texture is already bound there
+	static void BindTextureForEdit(unsigned int unit, unsigned int texture);
+
+	// Deleting a bound object resets its binding to 0 in GL, keep the cache in sync
+	static void OnDeleteProgram(unsigned int program);
+	static void OnDeleteVertexArray(unsigned int vertexArray);
+	static void OnDeleteBuffer(unsigned int buffer);
+	static void OnDeleteTexture(unsigned int texture);
+
+	// Forget everything, the next bind of each kind always reaches GL
+	static void Invalidate();
+
+	static void ResetStats();
+	static inline const Stats& GetStats() { return s_Stats; }
+};
@@ -0,0 +1,162 @@
+#include "GPUProfiler.h"
+
+#include "Renderer.h"
+
+GPUProfiler::Frame GPUProfiler::s_Frames[GPUProfiler::s_FrameCount];
+unsigned int GPUProfiler::s_FrameIndex = 0;
+std::vector<unsigned int> GPUProfiler::s_ScopeStack;
+std::atomic<bool> GPUProfiler::s_Enabled(true);
+bool GPUProfiler::s_FrameActive = false;
+std::atomic<unsigned int> GPUProfiler::s_DroppedFrames(0);
+
+std::mutex GPUProfiler::s_ResultsMutex;
+std::vector<GPUProfiler::Result> GPUProfiler::s_Results;
+
+void GPUProfiler::Shutdown()
+{
+	for (Frame& frame : s_Frames)
+	{
+		if (!frame.Queries.empty())
+		{
+			GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+		}
+
+		frame = Frame();
+	}
+	s_ScopeStack.clear();
+	s_FrameActive = false;
+}
+
+unsigned int GPUProfiler::WriteTimestamp(Frame& frame)
+{
+	// Query objects are kept per frame slot and only ever grow
+	if (frame.QueryCount == frame.Queries.size())
+	{
+		unsigned int query;
+		GLCall(glGenQueries(1, &query));
+		frame.Queries.push_back(query);
+	}
+
+	unsigned int index = frame.QueryCount++;
+	GLCall(glQueryCounter(frame.Queries[index], GL_TIMESTAMP));
+	return index;
+}
+
+bool GPUProfiler::Resolve(Frame& frame)
+{
+	// Timestamps complete in order, so the last one being available means all are
+	GLuint available = 0;
+	GLCall(glGetQueryObjectuiv(frame.Queries[frame.QueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+		return false;
+
+	std::vector<GLuint64> timestamps(frame.QueryCount);
+	for (unsigned int i = 0; i < frame.QueryCount; i++)
+	{
+		GLCall(glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &timestamps[i]));
+	}
+
+	std::lock_guard<std::mutex> lock(s_ResultsMutex);
+
+	std::vector<Result> results;
+	results.reserve(frame.Scopes.size());
+	for (unsigned int i = 0; i < (unsigned int)frame.Scopes.size(); i++)
+	{
+		const Scope& scope = frame.Scopes[i];
+		float timeMs = (float)((timestamps[scope.EndQuery] - timestamps[scope.BeginQuery]) * 1e-6);
+
+		// Smooth against the previous frame when the scope layout did not change
+		float averageMs = timeMs;
+		if (i < s_Results.size() && s_Results[i].Depth == scope.Depth && s_Results[i].Name == scope.Name)
+			averageMs = s_Results[i].AverageMs * 0.95f + timeMs * 0.05f;
+
+		results.push_back({ scope.Name, scope.Depth, timeMs, averageMs });
+	}
+	s_Results.swap(results);
+	return true;
+}
+
+void GPUProfiler::BeginFrame()
+{
+	if (!s_Enabled)
+		return;
+
+	Frame& frame = s_Frames[s_FrameIndex];
+	if (frame.Pending)
+	{
+		if (!Resolve(frame))
+			s_DroppedFrames++;
+		frame.Pending = false;
+	}
+
+	frame.QueryCount = 0;
+	frame.Scopes.clear();
+	s_ScopeStack.clear();
+	s_FrameActive = true;
+
+	BeginScope("Frame");
+}
+
+void GPUProfiler::EndFrame()
+{
+	if (!s_FrameActive)
+		return;
+
+	EndScope();
+	ASSERT(s_ScopeStack.empty());
+	s_FrameActive = false;
+
+	s_Frames[s_FrameIndex].Pending = true;
+	s_FrameIndex = (s_FrameIndex + 1) % s_FrameCount;
+
+	// Pick up older frames that finished since, oldest first and without waiting
+	for (unsigned int i = 0; i + 1 < s_FrameCount; i++)
+	{
+		Frame& frame = s_Frames[(s_FrameIndex + i) % s_FrameCount];
+		if (frame.Pending && Resolve(frame))
+			frame.Pending = false;
+	}
+}
+
+void GPUProfiler::BeginScope(const char* name)
+{
+	if (!s_FrameActive)
+		return;
+
+	Frame& frame = s_Frames[s_FrameIndex];
+	Scope scope;
+	scope.Name = name;
+	scope.Depth = (unsigned int)s_ScopeStack.size();
+	scope.BeginQuery = WriteTimestamp(frame);
+	scope.EndQuery = scope.BeginQuery;
+
+	s_ScopeStack.push_back((unsigned int)frame.Scopes.size());
+	frame.Scopes.push_back(scope);
+}
+
+void GPUProfiler::EndScope()
+{
+	if (!s_FrameActive)
+		return;
+
+	ASSERT(!s_ScopeStack.empty());
+	Frame& frame = s_Frames[s_FrameIndex];
+	frame.Scopes[s_ScopeStack.back()].EndQuery = WriteTimestamp(frame);
+	s_ScopeStack.pop_back();
+}
+
+std::vector<GPUProfiler::Result> GPUProfiler::GetResults()
+{
+	std::lock_guard<std::mutex> lock(s_ResultsMutex);
+	return s_Results;
+}
+
+unsigned int GPUProfiler::GetDroppedFrames()
+{
+	return s_DroppedFrames;
+}
+
+void GPUProfiler::SetEnabled(bool enabled)
+{
+	s_Enabled = enabled;
+}
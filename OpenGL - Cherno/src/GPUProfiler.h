@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Times GPU work per scope with GL_TIMESTAMP queries. A timestamp is written at
+// the start and end of every scope, which unlike GL_TIME_ELAPSED allows nesting.
+// Each frame gets its own set of queries from a ring and is read back a few
+// frames later, only once the results are available, so the CPU never waits on
+// the GPU. Frames whose results are still not in when their slot comes round
+// again are dropped.
+//
+// Everything but GetResults and SetEnabled must be called on the thread that owns
+// the GL context. Scope names must outlive the frame, string literals are fine.
+class GPUProfiler
+{
+public:
+	struct Result
+	{
+		std::string Name;
+		unsigned int Depth;
+		float TimeMs;
+		float AverageMs;
+	};
+
+private:
+	struct Scope
+	{
+		const char* Name;
+		unsigned int Depth;
+		unsigned int BeginQuery;
+		unsigned int EndQuery;
+	};
+
+	struct Frame
+	{
+		std::vector<unsigned int> Queries;
+		unsigned int QueryCount = 0;
+		std::vector<Scope> Scopes;
+		bool Pending = false;
+	};
+
+	static const unsigned int s_FrameCount = 4;
+
+	static Frame s_Frames[s_FrameCount];
+	static unsigned int s_FrameIndex;
+	static std::vector<unsigned int> s_ScopeStack;
+	static std::atomic<bool> s_Enabled;
+	static bool s_FrameActive;
+	static std::atomic<unsigned int> s_DroppedFrames;
+
+	static std::mutex s_ResultsMutex;
+	static std::vector<Result> s_Results;
+
+	static unsigned int WriteTimestamp(Frame& frame);
+	static bool Resolve(Frame& frame);
+
+public:
+	static void Shutdown();
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	static void BeginScope(const char* name);
+	static void EndScope();
+
+	// Results of the latest frame that was read back, in scope order
+	static std::vector<Result> GetResults();
+	static unsigned int GetDroppedFrames();
+
+	static void SetEnabled(bool enabled);
+	static inline bool IsEnabled() { return s_Enabled; }
+};
+
+class GPUProfileScope
+{
+public:
+	GPUProfileScope(const char* name) { GPUProfiler::BeginScope(name); }
+	~GPUProfileScope() { GPUProfiler::EndScope(); }
+};
+
+#define GPU_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GPU_PROFILE_CONCAT(a, b) GPU_PROFILE_CONCAT_IMPL(a, b)
+#define GPU_PROFILE_SCOPE(name) GPUProfileScope GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
@@ -1,28 +1,195 @@
 #include "IndexBuffer.h"
 
+#include <algorithm>
+#include <iostream>
+
 #include "Renderer.h"
+#include "GLStateCache.h"
+
+IndexType IndexBuffer::ChooseType(unsigned int maxIndex, bool allowBytes)
+{
+	if (allowBytes && maxIndex <= 0xff)
+		return IndexType::UnsignedByte;
+	if (maxIndex <= 0xffff)
+		return IndexType::UnsignedShort;
+	return IndexType::UnsignedInt;
+}
+
+unsigned int IndexBuffer::GetGLType(IndexType type)
+{
+	switch (type)
+	{
+	case IndexType::UnsignedByte:	return GL_UNSIGNED_BYTE;
+	case IndexType::UnsignedShort:	return GL_UNSIGNED_SHORT;
+	default:						return GL_UNSIGNED_INT;
+	}
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int glType)
+{
+	switch (glType)
+	{
+	case GL_UNSIGNED_BYTE:	return sizeof(GLubyte);
+	case GL_UNSIGNED_SHORT:	return sizeof(GLushort);
+	case GL_UNSIGNED_INT:	return sizeof(GLuint);
+	}
+
+	ASSERT(false);
+	return 0;
+}
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	: m_Count(count)
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, IndexType type)
+	: m_Count(count), m_Capacity(count), m_Usage(BufferUsage::Static), m_Strategy(UploadStrategy::Default),
+	 m_Pool(nullptr), m_BaseVertex(0)
 {
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
+	if (type == IndexType::Auto)
+	{
+		unsigned int maxIndex = count > 0 ? *std::max_element(data, data + count) : 0;
+		type = ChooseType(maxIndex);
+	}
+	m_Type = GetGLType(type);
+	m_IndexSize = GetSizeOfType(m_Type);
+
+	// Indices that do not fit the type asked for leave an empty buffer
+	std::vector<unsigned char> storage;
+	const void* indices = ConvertIndices(data, count, storage);
+	if (!indices)
+		m_Count = 0;
+	Create(indices);
+}
+
+IndexBuffer::IndexBuffer(const unsigned short* data, unsigned int count)
+	: m_Type(GL_UNSIGNED_SHORT), m_IndexSize(sizeof(unsigned short)), m_Count(count), m_Capacity(count),
+	 m_Usage(BufferUsage::Static), m_Strategy(UploadStrategy::Default), m_Pool(nullptr), m_BaseVertex(0)
+{
+	Create(data);
+}
+
+IndexBuffer::IndexBuffer(const unsigned char* data, unsigned int count)
+	: m_Type(GL_UNSIGNED_BYTE), m_IndexSize(sizeof(unsigned char)), m_Count(count), m_Capacity(count),
+	 m_Usage(BufferUsage::Static), m_Strategy(UploadStrategy::Default), m_Pool(nullptr), m_BaseVertex(0)
+{
+	Create(data);
+}
+
+IndexBuffer::IndexBuffer(unsigned int maxCount, BufferUsage usage, IndexType type)
+	: m_Type(GetGLType(type)), m_IndexSize(GetSizeOfType(m_Type)), m_Count(maxCount), m_Capacity(maxCount),
+	 m_Usage(usage), m_Strategy(UploadStrategy::Default), m_Pool(nullptr), m_BaseVertex(0)
+{
+	Create(nullptr);
+}
+
+IndexBuffer::IndexBuffer(BufferPool& pool, const unsigned int* data, unsigned int count, int baseVertex)
+	: m_Count(count), m_Capacity(count), m_Usage(BufferUsage::Static), m_Strategy(UploadStrategy::Default),
+	 m_Pool(&pool), m_BaseVertex(baseVertex)
+{
+	ASSERT(pool.GetTarget() == GL_ELEMENT_ARRAY_BUFFER);
+
+	switch (pool.GetElementSize())
+	{
+	case sizeof(GLubyte):	m_Type = GL_UNSIGNED_BYTE; break;
+	case sizeof(GLushort):	m_Type = GL_UNSIGNED_SHORT; break;
+	default:				m_Type = GL_UNSIGNED_INT; break;
+	}
+	m_IndexSize = GetSizeOfType(m_Type);
+	ASSERT(m_IndexSize == pool.GetElementSize());
+
+	m_Allocation = pool.Allocate(count);
+	ASSERT(m_Allocation.IsValid());
+	m_RendererID = pool.GetRendererID(m_Allocation.Block);
+
+	if (data)
+	{
+		// A mesh too big for the pool's index size draws nothing
+		std::vector<unsigned char> storage;
+		const void* indices = ConvertIndices(data, count, storage);
+		if (indices)
+			pool.SetData(m_Allocation, 0, indices, count);
+		else
+			m_Count = 0;
+	}
+}
+
+void IndexBuffer::Create(const void* data)
+{
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Capacity * m_IndexSize, data, BufferUpload::GetUsageEnum(m_Usage)));
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	if (m_Pool)
+	{
+		m_Pool->Free(m_Allocation);
+		return;
+	}
+
+	GLStateCache::OnDeleteBuffer(m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+const void* IndexBuffer::ConvertIndices(const unsigned int* data, unsigned int count, std::vector<unsigned char>& storage) const
+{
+	if (m_Type == GL_UNSIGNED_INT)
+		return data;
+
+	// Checked in every build, truncated indices would draw garbage
+	unsigned int maxIndex = count > 0 ? *std::max_element(data, data + count) : 0;
+	if (maxIndex > (m_Type == GL_UNSIGNED_SHORT ? 0xffffu : 0xffu))
+	{
+		std::cout << "Index " << maxIndex << " does not fit a " << m_IndexSize * 8 << " bit index buffer, indices dropped" << std::endl;
+		return nullptr;
+	}
+
+	storage.resize(count * m_IndexSize);
+	if (m_Type == GL_UNSIGNED_SHORT)
+	{
+		unsigned short* indices = (unsigned short*)storage.data();
+		for (unsigned int i = 0; i < count; i++)
+			indices[i] = (unsigned short)data[i];
+	}
+	else
+	{
+		for (unsigned int i = 0; i < count; i++)
+			storage[i] = (unsigned char)data[i];
+	}
+	return storage.data();
+}
+
+void IndexBuffer::SetData(unsigned int offset, const unsigned int* data, unsigned int count)
+{
+	std::vector<unsigned char> storage;
+	const void* indices = ConvertIndices(data, count, storage);
+	if (!indices)
+		return;
+
+	if (m_Pool)
+	{
+		m_Pool->SetData(m_Allocation, offset, indices, count, m_Strategy);
+		return;
+	}
+
+	// The element binding belongs to the bound VAO, this may change the current one's
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+	BufferUpload::Upload(GL_ELEMENT_ARRAY_BUFFER, m_Capacity * m_IndexSize, m_Usage, m_Strategy,
+		offset * m_IndexSize, indices, count * m_IndexSize);
+}
+
+void IndexBuffer::SetCount(unsigned int count)
+{
+	ASSERT(count <= m_Capacity);
+	m_Count = count;
+}
+
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
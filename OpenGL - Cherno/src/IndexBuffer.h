@@ -1,16 +1,82 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
+#include "BufferUpload.h"
+#include "BufferPool.h"
+
+// Auto picks the narrowest type the largest index fits in, down to 16 bits. Byte
+// indices have to be asked for, many desktop drivers convert them on the CPU.
+enum class IndexType
+{
+	Auto, UnsignedByte, UnsignedShort, UnsignedInt
+};
+
 class IndexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	// GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	unsigned int m_Type;
+	unsigned int m_IndexSize;
 	unsigned int m_Count;
+	unsigned int m_Capacity;
+	BufferUsage m_Usage;
+	UploadStrategy m_Strategy;
+	BufferPool* m_Pool;
+	BufferPool::Allocation m_Allocation;
+	int m_BaseVertex;
+
+	void Create(const void* data);
+	// Returns data itself when no conversion is needed, else the narrowed copy in
+	// storage. nullptr, after printing why, when an index does not fit the type.
+	const void* ConvertIndices(const unsigned int* data, unsigned int count, std::vector<unsigned char>& storage) const;
 public:
-	IndexBuffer(const unsigned int* data, unsigned int count);
+	IndexBuffer(const unsigned int* data, unsigned int count, IndexType type = IndexType::Auto);
+	IndexBuffer(const unsigned short* data, unsigned int count);
+	IndexBuffer(const unsigned char* data, unsigned int count);
+	// Buffer with room for maxCount indices, filled later through SetData. The
+	// type cannot be derived from data that is not there yet, Auto means 32 bits.
+	IndexBuffer(unsigned int maxCount, BufferUsage usage, IndexType type = IndexType::UnsignedInt);
+	// View of count indices in a shared pool, whose element size (1, 2 or 4) sets the
+	// index type. The indices stay relative to the mesh, baseVertex (the VertexBuffer
+	// view's GetBaseVertex) is added when drawing, so they narrow as well as
+	// for a mesh of its own. Indices too large for the pool leave the view empty,
+	// GetCount 0. The pool has to outlive the view.
+	IndexBuffer(BufferPool& pool, const unsigned int* data, unsigned int count, int baseVertex = 0);
 	~IndexBuffer();
 
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+	// offset and count are in indices, which are narrowed to the buffer's type and
+	// have to fit it, else nothing is written. Draws use GetCount, which starts at the capacity and is
+	// narrowed with SetCount
+	void SetData(unsigned int offset, const unsigned int* data, unsigned int count);
+	void SetCount(unsigned int count);
+
 	void Bind() const;
 	void Unbind() const;
 
+	inline void SetUploadStrategy(UploadStrategy strategy) { m_Strategy = strategy; }
+	inline UploadStrategy GetUploadStrategy() const { return m_Strategy; }
+	inline unsigned int GetType() const { return m_Type; }
+	inline unsigned int GetIndexSize() const { return m_IndexSize; }
 	inline unsigned int GetCount() const { return m_Count; }
-};
\ No newline at end of file
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsPooled() const { return m_Pool != nullptr; }
+
+	// Where the indices start in the underlying buffer and what to add to them,
+	// both 0 unless pooled
+	inline unsigned int GetFirstIndex() const { return m_Pool ? m_Allocation.Offset : 0; }
+	inline int GetBaseVertex() const { return m_BaseVertex; }
+	// The indices argument of glDrawElements*
+	inline void* GetIndexOffset() const { return (void*)((uintptr_t)GetFirstIndex() * m_IndexSize); }
+
+	// Smallest type that holds maxIndex, never bytes for Auto
+	static IndexType ChooseType(unsigned int maxIndex, bool allowBytes = false);
+	static unsigned int GetGLType(IndexType type);
+	static unsigned int GetSizeOfType(unsigned int glType);
+};
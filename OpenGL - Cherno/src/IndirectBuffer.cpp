@@ -0,0 +1,66 @@
+#include "IndirectBuffer.h"
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+IndirectBuffer::IndirectBuffer(const DrawElementsIndirectCommand* commands, unsigned int count)
+	: m_Count(count), m_Capacity(count), m_Commands(commands, commands + count), m_CommandsValid(true)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(DrawElementsIndirectCommand), commands, GL_STATIC_DRAW));
+}
+
+IndirectBuffer::IndirectBuffer(unsigned int maxCount)
+	: m_Count(0), m_Capacity(maxCount), m_CommandsValid(true)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, maxCount * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW));
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	GLStateCache::OnDeleteBuffer(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void IndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, unsigned int count)
+{
+	ASSERT(count <= m_Capacity);
+
+	m_Count = count;
+	m_Commands.assign(commands, commands + count);
+	m_CommandsValid = true;
+
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+	GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), commands));
+}
+
+void IndirectBuffer::InvalidateCommands()
+{
+	m_CommandsValid = false;
+}
+
+const std::vector<DrawElementsIndirectCommand>& IndirectBuffer::GetCommands() const
+{
+	// Reading back stalls until the GPU is done writing, only the fallback path gets here
+	if (!m_CommandsValid)
+	{
+		m_Commands.resize(m_Count);
+		GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+		GLCall(glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_Count * sizeof(DrawElementsIndirectCommand), m_Commands.data()));
+		m_CommandsValid = true;
+	}
+	return m_Commands;
+}
+
+void IndirectBuffer::Bind() const
+{
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+}
+
+void IndirectBuffer::Unbind() const
+{
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+// Layout fixed by GL for glDrawElementsIndirect / glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count;
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int BaseInstance;
+};
+
+// GL_DRAW_INDIRECT_BUFFER with a CPU copy of the commands, which the
+// Renderer replays itself when the driver lacks indirect drawing.
+class IndirectBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Count;
+	unsigned int m_Capacity;
+	mutable std::vector<DrawElementsIndirectCommand> m_Commands;
+	mutable bool m_CommandsValid;
+
+public:
+	IndirectBuffer(const DrawElementsIndirectCommand* commands, unsigned int count);
+	// Dynamic buffer with room for maxCount commands, filled later through SetData
+	IndirectBuffer(unsigned int maxCount);
+	~IndirectBuffer();
+
+	void SetData(const DrawElementsIndirectCommand* commands, unsigned int count);
+	// Call after the GPU wrote commands (e.g. from a compute shader), so the CPU
+	// copy is read back before it is used next
+	void InvalidateCommands();
+
+	const std::vector<DrawElementsIndirectCommand>& GetCommands() const;
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetCount() const { return m_Count; }
+};
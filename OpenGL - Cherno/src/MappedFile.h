@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file through the virtual memory system. Pages
+// are read from disk (or the OS file cache) as they are first touched, so
+// opening is cheap no matter the size and the data is never copied into
+// a buffer of our own.
+class MappedFile
+{
+private:
+	const unsigned char* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Unmaps any previous file. Empty files cannot be mapped and fail.
+	bool Open(const std::string& path);
+	void Close();
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+};
@@ -0,0 +1,370 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+namespace {
+
+	uint64_t AlignUp(uint64_t offset)
+	{
+		return (offset + MeshFile::Alignment - 1) / MeshFile::Alignment * MeshFile::Alignment;
+	}
+
+	bool IsValidElement(const MeshFile::Element& element)
+	{
+		switch (element.Type)
+		{
+		case GL_FLOAT:
+		case GL_UNSIGNED_INT:
+		case GL_UNSIGNED_BYTE:
+		case GL_HALF_FLOAT:
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+			return element.Count >= 1 && element.Count <= 4 && element.Normalized <= 1;
+		case GL_INT_2_10_10_10_REV:
+			return element.Count == 4 && element.Normalized <= 1;
+		}
+		return false;
+	}
+
+	// True when [offset, offset + size) lies inside the file and starts aligned
+	bool IsValidBlob(uint64_t offset, uint64_t size, uint64_t fileSize)
+	{
+		return offset % MeshFile::Alignment == 0 && offset <= fileSize && size <= fileSize - offset;
+	}
+
+	template<typename T>
+	bool AreIndicesInRange(const unsigned char* data, unsigned int indexCount, unsigned int vertexCount)
+	{
+		// The blob is aligned, and a plain max over it vectorizes
+		const T* indices = (const T*)data;
+		T maxIndex = 0;
+		for (unsigned int i = 0; i < indexCount; i++)
+			maxIndex = std::max(maxIndex, indices[i]);
+		return indexCount == 0 || maxIndex < vertexCount;
+	}
+
+}
+
+MeshFile::MeshFile()
+	: m_Header(nullptr)
+{
+}
+
+bool MeshFile::Validate(std::string& error)
+{
+	const Header& header = *(const Header*)m_File.GetData();
+	uint64_t fileSize = m_File.GetSize();
+
+	if (fileSize < sizeof(Header) || header.Magic != Magic)
+	{
+		error = "not a mesh file";
+		return false;
+	}
+	if (header.Version != Version)
+	{
+		error = "unsupported version " + std::to_string(header.Version);
+		return false;
+	}
+	if (header.FileSize != fileSize)
+	{
+		error = "truncated file";
+		return false;
+	}
+
+	// Rebuilding the layout checks the stored offsets are the packed ones VertexArray expects
+	if (header.ElementCount == 0 || header.ElementCount > VertexBufferLayout::MaxElements)
+	{
+		error = "invalid vertex layout";
+		return false;
+	}
+	m_Layout = VertexBufferLayout();
+	for (unsigned int i = 0; i < header.ElementCount; i++)
+	{
+		const Element& element = header.Elements[i];
+		if (!IsValidElement(element))
+		{
+			error = "invalid vertex layout";
+			return false;
+		}
+		m_Layout.Push(element.Type, element.Count, element.Normalized != 0);
+		if (m_Layout.GetElements()[i].offset != element.Offset)
+		{
+			error = "invalid vertex layout";
+			return false;
+		}
+	}
+	if (m_Layout.GetStride() != header.Stride)
+	{
+		error = "invalid vertex layout";
+		return false;
+	}
+
+	if (header.IndexType != GL_UNSIGNED_BYTE && header.IndexType != GL_UNSIGNED_SHORT && header.IndexType != GL_UNSIGNED_INT)
+	{
+		error = "invalid index type";
+		return false;
+	}
+
+	uint64_t vertexSize = (uint64_t)header.VertexCount * header.Stride;
+	uint64_t indexSize = (uint64_t)header.IndexCount * IndexBuffer::GetSizeOfType(header.IndexType);
+	uint64_t submeshSize = (uint64_t)header.SubmeshCount * sizeof(Submesh);
+	if (vertexSize > 0xffffffffu || !IsValidBlob(header.VertexOffset, vertexSize, fileSize) ||
+		!IsValidBlob(header.IndexOffset, indexSize, fileSize) || !IsValidBlob(header.SubmeshOffset, submeshSize, fileSize))
+	{
+		error = "blob out of range";
+		return false;
+	}
+
+	// Out of range indices would have the GPU fetch past the vertex buffer
+	const unsigned char* indices = m_File.GetData() + header.IndexOffset;
+	bool indicesInRange =
+		header.IndexType == GL_UNSIGNED_BYTE ? AreIndicesInRange<uint8_t>(indices, header.IndexCount, header.VertexCount) :
+		header.IndexType == GL_UNSIGNED_SHORT ? AreIndicesInRange<uint16_t>(indices, header.IndexCount, header.VertexCount) :
+		AreIndicesInRange<uint32_t>(indices, header.IndexCount, header.VertexCount);
+	if (!indicesInRange)
+	{
+		error = "index out of range";
+		return false;
+	}
+
+	const Submesh* submeshes = (const Submesh*)(m_File.GetData() + header.SubmeshOffset);
+	for (unsigned int i = 0; i < header.SubmeshCount; i++)
+	{
+		const Submesh& submesh = submeshes[i];
+		if ((uint64_t)submesh.FirstIndex + submesh.IndexCount > header.IndexCount || !std::memchr(submesh.Name, 0, sizeof(submesh.Name)))
+		{
+			error = "invalid submesh";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MeshFile::Open(const std::string& path)
+{
+	Close();
+
+	std::string error;
+	if (!m_File.Open(path))
+		error = "cannot map file";
+	else if (Validate(error))
+	{
+		m_Header = (const Header*)m_File.GetData();
+		return true;
+	}
+
+	std::cout << "Failed to load mesh file " << path << ": " << error << std::endl;
+	m_File.Close();
+	return false;
+}
+
+void MeshFile::Close()
+{
+	m_Header = nullptr;
+	m_Layout = VertexBufferLayout();
+	m_File.Close();
+}
+
+bool MeshFile::Write(const std::string& path, const VertexBufferLayout& layout, const void* vertices, unsigned int vertexCount,
+	const unsigned int* indices, unsigned int indexCount, const std::vector<MeshImporter::Submesh>& submeshes)
+{
+	auto elements = layout.GetElements();
+	if (elements.size() == 0 || (uint64_t)vertexCount * layout.GetStride() > 0xffffffffu)
+	{
+		std::cout << "Failed to write mesh file " << path << ": invalid vertex data" << std::endl;
+		return false;
+	}
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	header.Magic = Magic;
+	header.Version = Version;
+	header.ElementCount = elements.size();
+	header.Stride = layout.GetStride();
+	for (unsigned int i = 0; i < elements.size(); i++)
+		header.Elements[i] = { elements[i].type, elements[i].count, elements[i].normalized, elements[i].offset };
+	header.VertexCount = vertexCount;
+	header.IndexCount = indexCount;
+	header.SubmeshCount = (uint32_t)submeshes.size();
+
+	// Narrowed here once so loading never has to
+	unsigned int maxIndex = indexCount > 0 ? *std::max_element(indices, indices + indexCount) : 0;
+	if (indexCount > 0 && maxIndex >= vertexCount)
+	{
+		std::cout << "Failed to write mesh file " << path << ": index out of range" << std::endl;
+		return false;
+	}
+	header.IndexType = IndexBuffer::GetGLType(IndexBuffer::ChooseType(maxIndex));
+	unsigned int indexSize = IndexBuffer::GetSizeOfType(header.IndexType);
+	std::vector<unsigned char> indexData((size_t)indexCount * indexSize);
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		if (indexSize == sizeof(unsigned short))
+		{
+			unsigned short index = (unsigned short)indices[i];
+			std::memcpy(&indexData[i * sizeof(index)], &index, sizeof(index));
+		}
+		else
+		{
+			std::memcpy(&indexData[(size_t)i * sizeof(unsigned int)], &indices[i], sizeof(unsigned int));
+		}
+	}
+
+	std::vector<Submesh> table(submeshes.size());
+	for (size_t i = 0; i < submeshes.size(); i++)
+	{
+		std::memset(&table[i], 0, sizeof(Submesh));
+		std::strncpy(table[i].Name, submeshes[i].Name.c_str(), sizeof(table[i].Name) - 1);
+		table[i].FirstIndex = submeshes[i].FirstIndex;
+		table[i].IndexCount = submeshes[i].IndexCount;
+	}
+
+	uint64_t vertexSize = (uint64_t)vertexCount * header.Stride;
+	header.VertexOffset = AlignUp(sizeof(Header));
+	header.IndexOffset = AlignUp(header.VertexOffset + vertexSize);
+	header.SubmeshOffset = AlignUp(header.IndexOffset + indexData.size());
+	header.FileSize = header.SubmeshOffset + table.size() * sizeof(Submesh);
+
+	std::ofstream stream(path, std::ios::binary);
+	const char padding[Alignment] = {};
+	auto writeBlob = [&](uint64_t offset, const void* data, uint64_t size) {
+		if (!stream)
+			return;
+		stream.write(padding, (std::streamsize)(offset - (uint64_t)stream.tellp()));
+		stream.write((const char*)data, (std::streamsize)size);
+	};
+	writeBlob(0, &header, sizeof(header));
+	writeBlob(header.VertexOffset, vertices, vertexSize);
+	writeBlob(header.IndexOffset, indexData.data(), indexData.size());
+	writeBlob(header.SubmeshOffset, table.data(), table.size() * sizeof(Submesh));
+
+	if (!stream)
+	{
+		std::cout << "Failed to write mesh file " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool MeshFile::Convert(const std::string& input, const std::string& output, const std::vector<MeshImporter::Attribute>& attributes)
+{
+	MeshImporter::Mesh mesh;
+	if (!MeshImporter::Load(input, attributes, mesh))
+		return false;
+
+	if (!Write(output, mesh.Layout, mesh.Vertices.data(), mesh.VertexCount, mesh.Indices.data(), (unsigned int)mesh.Indices.size(), mesh.Submeshes))
+		return false;
+
+	std::cout << "Converted " << input << " to " << output << ": " << mesh.VertexCount << " vertices, "
+		<< mesh.Indices.size() / 3 << " triangles, " << mesh.Submeshes.size() << " submeshes" << std::endl;
+	return true;
+}
+
+std::unique_ptr<VertexBuffer> MeshFile::CreateVertexBuffer() const
+{
+	return std::make_unique<VertexBuffer>(GetVertexData(), GetVertexDataSize());
+}
+
+std::unique_ptr<IndexBuffer> MeshFile::CreateIndexBuffer() const
+{
+	switch (GetIndexType())
+	{
+	case GL_UNSIGNED_BYTE:	return std::make_unique<IndexBuffer>((const unsigned char*)GetIndexData(), GetIndexCount());
+	case GL_UNSIGNED_SHORT:	return std::make_unique<IndexBuffer>((const unsigned short*)GetIndexData(), GetIndexCount());
+	}
+	return std::make_unique<IndexBuffer>((const unsigned int*)GetIndexData(), GetIndexCount(), IndexType::UnsignedInt);
+}
+
+void MeshFile::Benchmark(const std::vector<std::string>& paths)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto milliseconds = [](Clock::time_point start) { return std::chrono::duration<float, std::milli>(Clock::now() - start).count(); };
+
+	std::vector<std::string> generated;
+	if (paths.empty())
+		generated = MeshImporter::WriteBenchmarkMeshes();
+	const std::vector<std::string>& files = paths.empty() ? generated : paths;
+
+	const std::vector<MeshImporter::Attribute> attributes = { MeshImporter::Attribute::Position, MeshImporter::Attribute::Normal, MeshImporter::Attribute::TexCoord };
+	const char* binaryPath = "MeshFileBenchmark.mesh";
+
+	// Reading every blob once stands in for the copy glBufferData makes, a mapped
+	// file only costs anything once its pages are touched
+	std::cout << "Mesh file load benchmark (best of 3, warm file cache)" << std::endl;
+	std::cout << std::left << std::setw(32) << "File" << std::right << std::setw(12) << "Triangles" << std::setw(10) << "Text MB"
+		<< std::setw(12) << "Import ms" << std::setw(10) << "Mesh MB" << std::setw(10) << "Open ms" << std::setw(10) << "Load ms"
+		<< std::setw(10) << "Speedup" << std::endl;
+
+	for (const std::string& file : files)
+	{
+		MeshImporter::Mesh mesh;
+		float importMs = 0.0f;
+		bool loaded = true;
+		for (int run = 0; run < 3 && loaded; run++)
+		{
+			loaded = MeshImporter::Load(file, attributes, mesh);
+			if (loaded && (run == 0 || mesh.LoadStats.TotalMs < importMs))
+				importMs = mesh.LoadStats.TotalMs;
+		}
+		if (!loaded || !Write(binaryPath, mesh.Layout, mesh.Vertices.data(), mesh.VertexCount, mesh.Indices.data(), (unsigned int)mesh.Indices.size(), mesh.Submeshes))
+			continue;
+
+		// Load is opening plus reading every byte
+		float openMs = 0.0f, loadMs = 0.0f;
+		size_t binarySize = 0;
+		uint64_t checksum = 0;
+		for (int run = 0; run < 3; run++)
+		{
+			auto start = Clock::now();
+			MeshFile meshFile;
+			if (!meshFile.Open(binaryPath))
+				break;
+			float open = milliseconds(start);
+
+			const unsigned char* blobs[] = { (const unsigned char*)meshFile.GetVertexData(), (const unsigned char*)meshFile.GetIndexData() };
+			size_t sizes[] = { meshFile.GetVertexDataSize(), (size_t)meshFile.GetIndexCount() * IndexBuffer::GetSizeOfType(meshFile.GetIndexType()) };
+			for (int b = 0; b < 2; b++)
+			{
+				for (size_t i = 0; i + sizeof(uint64_t) <= sizes[b]; i += sizeof(uint64_t))
+				{
+					uint64_t word;
+					std::memcpy(&word, blobs[b] + i, sizeof(word));
+					checksum += word;
+				}
+			}
+			float load = milliseconds(start);
+
+			if (run == 0 || load < loadMs)
+			{
+				openMs = open;
+				loadMs = load;
+			}
+			binarySize = meshFile.GetFileSize();
+		}
+
+		std::string name = file.size() > 30 ? "..." + file.substr(file.size() - 27) : file;
+		std::cout << std::left << std::setw(32) << name << std::right << std::setw(12) << mesh.LoadStats.Triangles << std::fixed << std::setprecision(1)
+			<< std::setw(10) << mesh.LoadStats.FileBytes / (1024.0f * 1024.0f) << std::setw(12) << importMs
+			<< std::setw(10) << binarySize / (1024.0f * 1024.0f) << std::setprecision(3) << std::setw(10) << openMs << std::setw(10) << loadMs
+			<< std::setprecision(1) << std::setw(9) << (loadMs > 0.0f ? importMs / loadMs : 0.0f) << "x" << std::endl;
+		std::cout.unsetf(std::ios_base::floatfield);
+
+		// Keeps the reads from being optimized away
+		volatile uint64_t sink = checksum;
+		(void)sink;
+	}
+
+	std::remove(binaryPath);
+	for (const std::string& file : generated)
+		std::remove(file.c_str());
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+#include "MappedFile.h"
+#include "MeshImporter.h"
+
+class VertexBuffer;
+class IndexBuffer;
+
+// Binary mesh container meant to be memory mapped. The file is:
+//
+//	Header			magic, version, vertex layout, counts and where the blobs are
+//	vertex blob		vertices exactly as the vertex buffer takes them
+//	index blob		indices in their narrowest type, as the index buffer takes them
+//	submesh table	Submesh entries
+//
+// Every blob starts at a multiple of Alignment, so once mapped the blobs are
+// aligned for any attribute or index type and go straight into
+// glBufferData without being parsed or copied. Everything is little endian.
+// Write files with Write or Convert, the --convert-mesh flag runs Convert.
+class MeshFile
+{
+public:
+	static constexpr uint32_t Magic = 0x4853454d; // "MESH"
+	static constexpr uint32_t Version = 1;
+	static constexpr uint32_t Alignment = 64;
+
+	struct Element
+	{
+		uint32_t Type;
+		uint32_t Count;
+		uint32_t Normalized;
+		uint32_t Offset;
+	};
+
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t FileSize;
+
+		uint32_t ElementCount;
+		uint32_t Stride;
+		Element Elements[VertexBufferLayout::MaxElements];
+
+		uint32_t VertexCount;
+		// GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		uint32_t IndexType;
+		uint32_t IndexCount;
+		uint32_t SubmeshCount;
+
+		uint64_t VertexOffset;
+		uint64_t IndexOffset;
+		uint64_t SubmeshOffset;
+	};
+
+	struct Submesh
+	{
+		// Zero terminated, longer names are cut
+		char Name[56];
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+	};
+
+	static_assert(sizeof(Header) == 320 && sizeof(Submesh) == 64, "Mesh file structs must not have padding");
+
+private:
+	MappedFile m_File;
+	const Header* m_Header;
+	VertexBufferLayout m_Layout;
+
+	bool Validate(std::string& error);
+
+public:
+	MeshFile();
+
+	// Maps the file and checks that everything it describes lies inside it and
+	// that every index names a vertex, the only pass over the blobs it makes.
+	// Prints the reason and returns false on failure.
+	bool Open(const std::string& path);
+	void Close();
+
+	// vertices are vertexCount * layout.GetStride() bytes, every index must be
+	// below vertexCount. Indices are stored in the narrowest type that holds
+	// them, bytes excepted.
+	static bool Write(const std::string& path, const VertexBufferLayout& layout, const void* vertices, unsigned int vertexCount,
+		const unsigned int* indices, unsigned int indexCount, const std::vector<MeshImporter::Submesh>& submeshes);
+	// Imports an OBJ or glTF file and writes it as a mesh file
+	static bool Convert(const std::string& input, const std::string& output, const std::vector<MeshImporter::Attribute>& attributes);
+
+	// Buffers filled straight from the mapped blobs, only valid while open
+	std::unique_ptr<VertexBuffer> CreateVertexBuffer() const;
+	std::unique_ptr<IndexBuffer> CreateIndexBuffer() const;
+
+	// Times MeshImporter::Load on the text files against opening and reading
+	// the same meshes converted to mesh files. Without paths it uses the
+	// meshes of MeshImporter::Benchmark.
+	static void Benchmark(const std::vector<std::string>& paths);
+
+	inline bool IsOpen() const { return m_Header != nullptr; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline unsigned int GetVertexCount() const { return m_Header->VertexCount; }
+	inline const void* GetVertexData() const { return m_File.GetData() + m_Header->VertexOffset; }
+	inline unsigned int GetVertexDataSize() const { return m_Header->VertexCount * m_Header->Stride; }
+	inline unsigned int GetIndexType() const { return m_Header->IndexType; }
+	inline unsigned int GetIndexCount() const { return m_Header->IndexCount; }
+	inline const void* GetIndexData() const { return m_File.GetData() + m_Header->IndexOffset; }
+	inline unsigned int GetSubmeshCount() const { return m_Header->SubmeshCount; }
+	inline const Submesh* GetSubmeshes() const { return (const Submesh*)(m_File.GetData() + m_Header->SubmeshOffset); }
+	inline size_t GetFileSize() const { return m_File.GetSize(); }
+};
@@ -0,0 +1,1531 @@
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+namespace {
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	float GetMilliseconds(Clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	}
+
+	bool ReadFile(const std::string& path, std::vector<char>& data)
+	{
+		std::ifstream stream(path, std::ios::binary | std::ios::ate);
+		if (!stream)
+			return false;
+
+		std::streamsize size = stream.tellg();
+		stream.seekg(0);
+		data.resize((size_t)size);
+		return size == 0 || (bool)stream.read(data.data(), size);
+	}
+
+	bool EndsWith(const std::string& text, const char* suffix)
+	{
+		size_t length = std::strlen(suffix);
+		if (text.size() < length)
+			return false;
+
+		for (size_t i = 0; i < length; i++)
+		{
+			if (std::tolower((unsigned char)text[text.size() - length + i]) != suffix[i])
+				return false;
+		}
+		return true;
+	}
+
+	unsigned int GetParallelism(unsigned int parallelism)
+	{
+		unsigned int available = ThreadPool::Get().GetThreadCount() + 1;
+		return parallelism == 0 ? available : std::min(parallelism, available);
+	}
+
+	// Splits [0, count) into ranges of at least minimum items, one ParallelFor item each
+	unsigned int GetRangeCount(size_t count, unsigned int parallelism, size_t minimum)
+	{
+		return (unsigned int)std::max<size_t>(1, std::min<size_t>(parallelism * 4, count / minimum));
+	}
+
+	// Merges bitwise identical vertices, keeping the first of each in order of use.
+	// Returns the new index of every vertex and compacts vertices to the unique ones.
+	std::vector<unsigned int> Deduplicate(std::vector<float>& vertices, unsigned int stride, unsigned int parallelism)
+	{
+		PROFILE_SCOPE("MeshImporter::Deduplicate");
+		ThreadPool& pool = ThreadPool::Get();
+		unsigned int count = (unsigned int)(vertices.size() / stride);
+		const size_t vertexSize = stride * sizeof(float);
+
+		std::vector<uint64_t> hashes(count);
+		pool.ParallelFor(count, parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (unsigned int v = begin; v < end; v++)
+			{
+				const unsigned char* bytes = (const unsigned char*)&vertices[(size_t)v * stride];
+				uint64_t hash = 14695981039346656037ull;
+				for (size_t i = 0; i < vertexSize; i++)
+					hash = (hash ^ bytes[i]) * 1099511628211ull;
+				hashes[v] = hash;
+			}
+		});
+
+		// Every partition of the hash space finds the first vertex of each value
+		// on its own, no two threads ever look at the same vertex value
+		const uint32_t empty = ~0u;
+		std::vector<unsigned int> first(count);
+		unsigned int partitions = parallelism;
+		pool.ParallelFor(partitions, partitions, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (unsigned int partition = begin; partition < end; partition++)
+			{
+				size_t tableSize = 64;
+				while (tableSize < (size_t)count / partitions * 2)
+					tableSize *= 2;
+				std::vector<uint32_t> table(tableSize, empty);
+				size_t used = 0;
+
+				for (unsigned int v = 0; v < count; v++)
+				{
+					uint64_t hash = hashes[v];
+					if ((hash >> 40) % partitions != partition)
+						continue;
+
+					size_t mask = table.size() - 1;
+					for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+					{
+						uint32_t other = table[slot];
+						if (other == empty)
+						{
+							table[slot] = v;
+							first[v] = v;
+							used++;
+							break;
+						}
+						if (hashes[other] == hash && std::memcmp(&vertices[(size_t)other * stride], &vertices[(size_t)v * stride], vertexSize) == 0)
+						{
+							first[v] = other;
+							break;
+						}
+					}
+
+					// Keep the table at most half full
+					if (used * 2 > table.size())
+					{
+						std::vector<uint32_t> grown(table.size() * 2, empty);
+						for (uint32_t entry : table)
+						{
+							if (entry == empty)
+								continue;
+							size_t slot = hashes[entry] & (grown.size() - 1);
+							while (grown[slot] != empty)
+								slot = (slot + 1) & (grown.size() - 1);
+							grown[slot] = entry;
+						}
+						table.swap(grown);
+					}
+				}
+			}
+		});
+
+		// Number the first vertices in order, in ranges whose starts come from a scan of their counts
+		unsigned int ranges = GetRangeCount(count, parallelism, 4096);
+		unsigned int rangeSize = (count + ranges - 1) / ranges;
+		std::vector<unsigned int> rangeOffsets(ranges + 1, 0);
+		pool.ParallelFor(ranges, parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (unsigned int range = begin; range < end; range++)
+			{
+				unsigned int unique = 0;
+				for (unsigned int v = range * rangeSize; v < std::min(count, (range + 1) * rangeSize); v++)
+					unique += first[v] == v;
+				rangeOffsets[range + 1] = unique;
+			}
+		});
+		for (unsigned int range = 0; range < ranges; range++)
+			rangeOffsets[range + 1] += rangeOffsets[range];
+		unsigned int uniqueCount = rangeOffsets[ranges];
+
+		std::vector<unsigned int> remap(count);
+		std::vector<float> unique((size_t)uniqueCount * stride);
+		pool.ParallelFor(ranges, parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (unsigned int range = begin; range < end; range++)
+			{
+				unsigned int next = rangeOffsets[range];
+				for (unsigned int v = range * rangeSize; v < std::min(count, (range + 1) * rangeSize); v++)
+				{
+					if (first[v] != v)
+						continue;
+					remap[v] = next;
+					std::memcpy(&unique[(size_t)next * stride], &vertices[(size_t)v * stride], vertexSize);
+					next++;
+				}
+			}
+		});
+
+		// Duplicates always come after their first vertex, which is numbered by now
+		pool.ParallelFor(count, parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (unsigned int v = begin; v < end; v++)
+			{
+				if (first[v] != v)
+					remap[v] = remap[first[v]];
+			}
+		});
+
+		vertices.swap(unique);
+		return remap;
+	}
+
+	// OBJ
+
+	inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+	inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+	const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && IsSpace(*p))
+			p++;
+		return p;
+	}
+
+	// Decimal and exponent notation as OBJ writers produce it, much faster than strtof
+	const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		static const double powersOfTen[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		p = SkipSpaces(p, end);
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		double mantissa = 0.0;
+		int exponent = 0;
+		while (p < end && IsDigit(*p))
+			mantissa = mantissa * 10.0 + (*p++ - '0');
+		if (p < end && *p == '.')
+		{
+			p++;
+			while (p < end && IsDigit(*p))
+			{
+				mantissa = mantissa * 10.0 + (*p++ - '0');
+				exponent--;
+			}
+		}
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			p++;
+			bool negativeExponent = false;
+			if (p < end && (*p == '-' || *p == '+'))
+				negativeExponent = *p++ == '-';
+			int explicitExponent = 0;
+			while (p < end && IsDigit(*p))
+				explicitExponent = std::min(explicitExponent * 10 + (*p++ - '0'), 1000);
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+		}
+
+		if (exponent != 0)
+		{
+			int magnitude = std::abs(exponent);
+			double scale = magnitude <= 22 ? powersOfTen[magnitude] : std::pow(10.0, magnitude);
+			mantissa = exponent < 0 ? mantissa / scale : mantissa * scale;
+		}
+		value = (float)(negative ? -mantissa : mantissa);
+		return p;
+	}
+
+	const char* ParseInt(const char* p, const char* end, int64_t& value)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		value = 0;
+		while (p < end && IsDigit(*p))
+			value = value * 10 + (*p++ - '0');
+		if (negative)
+			value = -value;
+		return p;
+	}
+
+	struct ObjSubmesh
+	{
+		std::string Name;
+		unsigned int FirstTriangle;
+	};
+
+	// What one thread parsed of a range of lines. Relative (negative) indices can
+	// point before the chunk, so they are kept relative to it until every chunk's
+	// start in the global lists is known.
+	const int64_t MissingIndex = -1;
+	const int64_t RelativeIndexBase = 1ll << 40;
+
+	struct ObjChunk
+	{
+		std::vector<float> Positions;
+		std::vector<float> TexCoords;
+		std::vector<float> Normals;
+		// Position, texture coordinate and normal index of every triangle corner
+		std::vector<int64_t> Corners;
+		std::vector<ObjSubmesh> Submeshes;
+		bool Failed = false;
+		std::string Error;
+	};
+
+	int64_t ResolveObjIndex(int64_t index, size_t localCount, ObjChunk& chunk)
+	{
+		if (index > 0)
+			return index - 1;
+		if (index < 0)
+			return RelativeIndexBase + (int64_t)localCount + index;
+
+		chunk.Failed = true;
+		chunk.Error = "index 0 in face";
+		return MissingIndex;
+	}
+
+	void ParseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+	{
+		while (p < end)
+		{
+			p = SkipSpaces(p, end);
+			const char* lineEnd = (const char*)std::memchr(p, '\n', end - p);
+			if (!lineEnd)
+				lineEnd = end;
+
+			if (p + 1 < lineEnd && p[0] == 'v' && IsSpace(p[1]))
+			{
+				float x, y, z;
+				p = ParseFloat(p + 1, lineEnd, x);
+				p = ParseFloat(p, lineEnd, y);
+				p = ParseFloat(p, lineEnd, z);
+				chunk.Positions.insert(chunk.Positions.end(), { x, y, z });
+			}
+			else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 't' && IsSpace(p[2]))
+			{
+				float u, v = 0.0f;
+				p = ParseFloat(p + 2, lineEnd, u);
+				if (SkipSpaces(p, lineEnd) < lineEnd)
+					p = ParseFloat(p, lineEnd, v);
+				chunk.TexCoords.insert(chunk.TexCoords.end(), { u, v });
+			}
+			else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2]))
+			{
+				float x, y, z;
+				p = ParseFloat(p + 2, lineEnd, x);
+				p = ParseFloat(p, lineEnd, y);
+				p = ParseFloat(p, lineEnd, z);
+				chunk.Normals.insert(chunk.Normals.end(), { x, y, z });
+			}
+			else if (p + 1 < lineEnd && p[0] == 'f' && IsSpace(p[1]))
+			{
+				// Polygons become triangle fans
+				int64_t firstCorner[3], previousCorner[3];
+				unsigned int cornerCount = 0;
+				p++;
+				while ((p = SkipSpaces(p, lineEnd)) < lineEnd)
+				{
+					int64_t position, texCoord = 0, normal = 0;
+					p = ParseInt(p, lineEnd, position);
+					if (p < lineEnd && *p == '/')
+					{
+						p++;
+						if (p < lineEnd && *p != '/')
+							p = ParseInt(p, lineEnd, texCoord);
+						if (p < lineEnd && *p == '/')
+							p = ParseInt(p + 1, lineEnd, normal);
+					}
+					if (p < lineEnd && !IsSpace(*p))
+					{
+						chunk.Failed = true;
+						chunk.Error = "malformed face";
+						return;
+					}
+
+					int64_t corner[3] = {
+						ResolveObjIndex(position, chunk.Positions.size() / 3, chunk),
+						texCoord ? ResolveObjIndex(texCoord, chunk.TexCoords.size() / 2, chunk) : MissingIndex,
+						normal ? ResolveObjIndex(normal, chunk.Normals.size() / 3, chunk) : MissingIndex
+					};
+
+					if (cornerCount == 0)
+						std::copy(corner, corner + 3, firstCorner);
+					else if (cornerCount >= 2)
+					{
+						chunk.Corners.insert(chunk.Corners.end(), firstCorner, firstCorner + 3);
+						chunk.Corners.insert(chunk.Corners.end(), previousCorner, previousCorner + 3);
+						chunk.Corners.insert(chunk.Corners.end(), corner, corner + 3);
+					}
+					std::copy(corner, corner + 3, previousCorner);
+					cornerCount++;
+				}
+			}
+			else if ((p + 1 < lineEnd && (p[0] == 'o' || p[0] == 'g') && IsSpace(p[1])) ||
+				(lineEnd - p > 6 && std::strncmp(p, "usemtl", 6) == 0 && IsSpace(p[6])))
+			{
+				const char* name = SkipSpaces(p + (p[0] == 'u' ? 6 : 1), lineEnd);
+				const char* nameEnd = lineEnd;
+				while (nameEnd > name && IsSpace(nameEnd[-1]))
+					nameEnd--;
+				chunk.Submeshes.push_back({ std::string(name, nameEnd), (unsigned int)(chunk.Corners.size() / 9) });
+			}
+
+			p = lineEnd + 1;
+		}
+	}
+
+	bool LoadObj(const std::vector<char>& file, const std::vector<MeshImporter::Attribute>& attributes, unsigned int stride,
+		MeshImporter::Mesh& mesh, unsigned int parallelism, std::string& error)
+	{
+		ThreadPool& pool = ThreadPool::Get();
+		const char* begin = file.data();
+		const char* end = begin + file.size();
+
+		// Chunks of at least 1 MB, split after a line break
+		unsigned int chunkCount = GetRangeCount(file.size(), parallelism, 1 << 20);
+		std::vector<const char*> bounds(chunkCount + 1, end);
+		bounds[0] = begin;
+		for (unsigned int i = 1; i < chunkCount; i++)
+		{
+			const char* split = std::max(bounds[i - 1], begin + file.size() / chunkCount * i);
+			const char* lineBreak = (const char*)std::memchr(split, '\n', end - split);
+			bounds[i] = lineBreak ? lineBreak + 1 : end;
+		}
+
+		std::vector<ObjChunk> chunks(chunkCount);
+		pool.ParallelFor(chunkCount, parallelism, [&](unsigned int first, unsigned int last, unsigned int) {
+			for (unsigned int i = first; i < last; i++)
+				ParseObjChunk(bounds[i], bounds[i + 1], chunks[i]);
+		});
+
+		// Where every chunk starts in the global lists
+		struct ChunkBase
+		{
+			size_t Positions, TexCoords, Normals, Corners;
+		};
+		std::vector<ChunkBase> bases(chunkCount + 1, ChunkBase{ 0, 0, 0, 0 });
+		for (unsigned int i = 0; i < chunkCount; i++)
+		{
+			if (chunks[i].Failed)
+			{
+				error = chunks[i].Error;
+				return false;
+			}
+			bases[i + 1].Positions = bases[i].Positions + chunks[i].Positions.size() / 3;
+			bases[i + 1].TexCoords = bases[i].TexCoords + chunks[i].TexCoords.size() / 2;
+			bases[i + 1].Normals = bases[i].Normals + chunks[i].Normals.size() / 3;
+			bases[i + 1].Corners = bases[i].Corners + chunks[i].Corners.size() / 3;
+		}
+
+		std::vector<float> positions(bases[chunkCount].Positions * 3);
+		std::vector<float> texCoords(bases[chunkCount].TexCoords * 2);
+		std::vector<float> normals(bases[chunkCount].Normals * 3);
+		pool.ParallelFor(chunkCount, parallelism, [&](unsigned int first, unsigned int last, unsigned int) {
+			for (unsigned int i = first; i < last; i++)
+			{
+				std::copy(chunks[i].Positions.begin(), chunks[i].Positions.end(), positions.begin() + bases[i].Positions * 3);
+				std::copy(chunks[i].TexCoords.begin(), chunks[i].TexCoords.end(), texCoords.begin() + bases[i].TexCoords * 2);
+				std::copy(chunks[i].Normals.begin(), chunks[i].Normals.end(), normals.begin() + bases[i].Normals * 3);
+			}
+		});
+
+		// Expand every corner into a full vertex, merging comes later
+		size_t cornerCount = bases[chunkCount].Corners;
+		if (cornerCount > 0xffffffffu)
+		{
+			error = "too many vertices";
+			return false;
+		}
+		mesh.Vertices.resize(cornerCount * stride);
+		std::atomic<bool> outOfRange(false);
+		pool.ParallelFor(chunkCount, parallelism, [&](unsigned int first, unsigned int last, unsigned int) {
+			for (unsigned int i = first; i < last; i++)
+			{
+				const ObjChunk& chunk = chunks[i];
+				const size_t listBases[3] = { bases[i].Positions, bases[i].TexCoords, bases[i].Normals };
+				const size_t listSizes[3] = { positions.size() / 3, texCoords.size() / 2, normals.size() / 3 };
+				float* vertex = &mesh.Vertices[bases[i].Corners * stride];
+
+				for (size_t c = 0; c < chunk.Corners.size(); c += 3, vertex += stride)
+				{
+					// Checked before anything is read, a bad index gives up on the whole chunk
+					int64_t indices[3];
+					bool valid = true;
+					for (unsigned int k = 0; k < 3; k++)
+					{
+						int64_t index = chunk.Corners[c + k];
+						if (index >= RelativeIndexBase / 2)
+							index = (int64_t)listBases[k] + index - RelativeIndexBase;
+						if (index != MissingIndex && (index < 0 || (size_t)index >= listSizes[k]))
+							valid = false;
+						indices[k] = index;
+					}
+					if (!valid || indices[0] == MissingIndex)
+					{
+						outOfRange = true;
+						return;
+					}
+
+					float* output = vertex;
+					for (MeshImporter::Attribute attribute : attributes)
+					{
+						switch (attribute)
+						{
+						case MeshImporter::Attribute::Position:
+							std::copy(&positions[indices[0] * 3], &positions[indices[0] * 3] + 3, output);
+							output += 3;
+							break;
+						case MeshImporter::Attribute::TexCoord:
+							if (indices[1] == MissingIndex)
+								std::fill(output, output + 2, 0.0f);
+							else
+								std::copy(&texCoords[indices[1] * 2], &texCoords[indices[1] * 2] + 2, output);
+							output += 2;
+							break;
+						case MeshImporter::Attribute::Normal:
+							if (indices[2] == MissingIndex)
+								std::fill(output, output + 3, 0.0f);
+							else
+								std::copy(&normals[indices[2] * 3], &normals[indices[2] * 3] + 3, output);
+							output += 3;
+							break;
+						}
+					}
+				}
+			}
+		});
+		if (outOfRange)
+		{
+			error = "face index out of range";
+			return false;
+		}
+
+		// Submeshes continue across chunks until the next o, g or usemtl line
+		std::vector<ObjSubmesh> starts(1, ObjSubmesh{ std::string(), 0 });
+		for (unsigned int i = 0; i < chunkCount; i++)
+		{
+			for (const ObjSubmesh& submesh : chunks[i].Submeshes)
+				starts.push_back({ submesh.Name, (unsigned int)(bases[i].Corners / 3) + submesh.FirstTriangle });
+		}
+		unsigned int triangleCount = (unsigned int)(cornerCount / 3);
+		for (size_t i = 0; i < starts.size(); i++)
+		{
+			unsigned int next = i + 1 < starts.size() ? starts[i + 1].FirstTriangle : triangleCount;
+			if (next > starts[i].FirstTriangle)
+				mesh.Submeshes.push_back({ starts[i].Name, starts[i].FirstTriangle * 3, (next - starts[i].FirstTriangle) * 3 });
+		}
+
+		mesh.Indices.resize(cornerCount);
+		for (size_t i = 0; i < cornerCount; i++)
+			mesh.Indices[i] = (unsigned int)i;
+		return true;
+	}
+
+	// glTF
+
+	// Just enough JSON for glTF documents
+	struct JsonValue
+	{
+		enum class Type
+		{
+			Null, Bool, Number, String, Array, Object
+		};
+
+		Type Kind = Type::Null;
+		bool Bool = false;
+		double Number = 0.0;
+		std::string String;
+		std::vector<JsonValue> Elements;
+		std::vector<std::pair<std::string, JsonValue>> Members;
+
+		const JsonValue* Find(const char* key) const
+		{
+			for (const auto& member : Members)
+			{
+				if (member.first == key)
+					return &member.second;
+			}
+			return nullptr;
+		}
+
+		double GetNumber(const char* key, double fallback) const
+		{
+			const JsonValue* value = Find(key);
+			return value && value->Kind == Type::Number ? value->Number : fallback;
+		}
+
+		int GetInt(const char* key, int fallback) const { return (int)GetNumber(key, fallback); }
+
+		std::string GetString(const char* key) const
+		{
+			const JsonValue* value = Find(key);
+			return value && value->Kind == Type::String ? value->String : std::string();
+		}
+
+		// Null when key is missing or not an array of at least index + 1 elements
+		const JsonValue* GetElement(const char* key, int index) const
+		{
+			const JsonValue* array = Find(key);
+			if (!array || array->Kind != Type::Array || index < 0 || (size_t)index >= array->Elements.size())
+				return nullptr;
+			return &array->Elements[index];
+		}
+	};
+
+	class JsonParser
+	{
+	private:
+		const char* m_Position;
+		const char* m_End;
+		unsigned int m_Depth;
+
+		void SkipWhitespace()
+		{
+			while (m_Position < m_End && (*m_Position == ' ' || *m_Position == '\t' || *m_Position == '\n' || *m_Position == '\r'))
+				m_Position++;
+		}
+
+		bool Expect(const char* literal)
+		{
+			size_t length = std::strlen(literal);
+			if ((size_t)(m_End - m_Position) < length || std::strncmp(m_Position, literal, length) != 0)
+				return false;
+			m_Position += length;
+			return true;
+		}
+
+		static void AppendUtf8(std::string& text, unsigned int codePoint)
+		{
+			if (codePoint < 0x80)
+				text += (char)codePoint;
+			else if (codePoint < 0x800)
+			{
+				text += (char)(0xc0 | (codePoint >> 6));
+				text += (char)(0x80 | (codePoint & 0x3f));
+			}
+			else
+			{
+				text += (char)(0xe0 | (codePoint >> 12));
+				text += (char)(0x80 | ((codePoint >> 6) & 0x3f));
+				text += (char)(0x80 | (codePoint & 0x3f));
+			}
+		}
+
+		bool ParseString(std::string& text)
+		{
+			m_Position++;
+			while (m_Position < m_End && *m_Position != '"')
+			{
+				char c = *m_Position++;
+				if (c != '\\')
+				{
+					text += c;
+					continue;
+				}
+				if (m_Position >= m_End)
+					return false;
+
+				switch (char escape = *m_Position++)
+				{
+				case 'b': text += '\b'; break;
+				case 'f': text += '\f'; break;
+				case 'n': text += '\n'; break;
+				case 'r': text += '\r'; break;
+				case 't': text += '\t'; break;
+				case 'u':
+				{
+					if (m_End - m_Position < 4)
+						return false;
+					unsigned int codePoint = (unsigned int)std::strtoul(std::string(m_Position, 4).c_str(), nullptr, 16);
+					AppendUtf8(text, codePoint);
+					m_Position += 4;
+					break;
+				}
+				default: text += escape; break;
+				}
+			}
+			if (m_Position >= m_End)
+				return false;
+			m_Position++;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value)
+		{
+			SkipWhitespace();
+			if (m_Position >= m_End || ++m_Depth > 256)
+				return false;
+
+			bool parsed = true;
+			switch (*m_Position)
+			{
+			case '{':
+				value.Kind = JsonValue::Type::Object;
+				m_Position++;
+				SkipWhitespace();
+				if (m_Position < m_End && *m_Position == '}')
+				{
+					m_Position++;
+					break;
+				}
+				while (parsed)
+				{
+					SkipWhitespace();
+					value.Members.emplace_back();
+					parsed = m_Position < m_End && *m_Position == '"' && ParseString(value.Members.back().first);
+					SkipWhitespace();
+					parsed = parsed && m_Position < m_End && *m_Position++ == ':' && ParseValue(value.Members.back().second);
+					SkipWhitespace();
+					if (!parsed || m_Position >= m_End)
+						return false;
+					if (*m_Position++ == '}')
+						break;
+					parsed = m_Position[-1] == ',';
+				}
+				break;
+			case '[':
+				value.Kind = JsonValue::Type::Array;
+				m_Position++;
+				SkipWhitespace();
+				if (m_Position < m_End && *m_Position == ']')
+				{
+					m_Position++;
+					break;
+				}
+				while (parsed)
+				{
+					value.Elements.emplace_back();
+					parsed = ParseValue(value.Elements.back());
+					SkipWhitespace();
+					if (!parsed || m_Position >= m_End)
+						return false;
+					if (*m_Position++ == ']')
+						break;
+					parsed = m_Position[-1] == ',';
+				}
+				break;
+			case '"':
+				value.Kind = JsonValue::Type::String;
+				parsed = ParseString(value.String);
+				break;
+			case 't':
+				value.Kind = JsonValue::Type::Bool;
+				value.Bool = true;
+				parsed = Expect("true");
+				break;
+			case 'f':
+				value.Kind = JsonValue::Type::Bool;
+				parsed = Expect("false");
+				break;
+			case 'n':
+				parsed = Expect("null");
+				break;
+			default:
+			{
+				const char* numberEnd = m_Position;
+				while (numberEnd < m_End && (IsDigit(*numberEnd) || (*numberEnd && std::strchr("+-.eE", *numberEnd))))
+					numberEnd++;
+
+				std::string number(m_Position, numberEnd);
+				char* parsedEnd;
+				value.Kind = JsonValue::Type::Number;
+				value.Number = std::strtod(number.c_str(), &parsedEnd);
+				parsed = !number.empty() && parsedEnd == number.c_str() + number.size();
+				m_Position = numberEnd;
+				break;
+			}
+			}
+
+			m_Depth--;
+			return parsed;
+		}
+
+	public:
+		JsonParser(const char* begin, const char* end)
+			: m_Position(begin), m_End(end), m_Depth(0)
+		{
+		}
+
+		bool Parse(JsonValue& value)
+		{
+			if (!ParseValue(value))
+				return false;
+			SkipWhitespace();
+			return m_Position == m_End;
+		}
+	};
+
+	bool DecodeBase64(const char* p, const char* end, std::vector<unsigned char>& data)
+	{
+		unsigned int bits = 0, bitCount = 0;
+		for (; p < end && *p != '='; p++)
+		{
+			char c = *p;
+			unsigned int value;
+			if (c >= 'A' && c <= 'Z') value = c - 'A';
+			else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+			else if (c >= '0' && c <= '9') value = c - '0' + 52;
+			else if (c == '+') value = 62;
+			else if (c == '/') value = 63;
+			else return false;
+
+			bits = (bits << 6) | value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				data.push_back((unsigned char)(bits >> bitCount));
+			}
+		}
+		return true;
+	}
+
+	std::string DecodeUri(const std::string& uri)
+	{
+		std::string path;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			if (uri[i] == '%' && i + 2 < uri.size())
+			{
+				path += (char)std::strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+				i += 2;
+			}
+			else
+			{
+				path += uri[i];
+			}
+		}
+		return path;
+	}
+
+	struct GltfAccessor
+	{
+		const unsigned char* Data = nullptr;
+		unsigned int Count = 0;
+		unsigned int ComponentType = 0;
+		unsigned int Components = 0;
+		unsigned int Stride = 0;
+		bool Normalized = false;
+
+		float ReadFloat(unsigned int index, unsigned int component) const
+		{
+			const unsigned char* element = Data + (size_t)index * Stride;
+			switch (ComponentType)
+			{
+			case GL_FLOAT:			{ float v; std::memcpy(&v, element + component * 4, 4); return v; }
+			case GL_UNSIGNED_BYTE:	{ float v = element[component]; return Normalized ? v / 255.0f : v; }
+			case GL_BYTE:			{ float v = (float)(int8_t)element[component]; return Normalized ? std::max(v / 127.0f, -1.0f) : v; }
+			case GL_UNSIGNED_SHORT:	{ uint16_t v; std::memcpy(&v, element + component * 2, 2); return Normalized ? v / 65535.0f : v; }
+			case GL_SHORT:			{ int16_t v; std::memcpy(&v, element + component * 2, 2); return Normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+			}
+			return 0.0f;
+		}
+
+		unsigned int ReadIndex(unsigned int index) const
+		{
+			const unsigned char* element = Data + (size_t)index * Stride;
+			switch (ComponentType)
+			{
+			case GL_UNSIGNED_BYTE:	return element[0];
+			case GL_UNSIGNED_SHORT:	{ uint16_t v; std::memcpy(&v, element, 2); return v; }
+			case GL_UNSIGNED_INT:	{ uint32_t v; std::memcpy(&v, element, 4); return v; }
+			}
+			return 0;
+		}
+	};
+
+	unsigned int GetComponentSize(unsigned int componentType)
+	{
+		switch (componentType)
+		{
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:	return 1;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:	return 2;
+		case GL_UNSIGNED_INT:
+		case GL_FLOAT:			return 4;
+		}
+		return 0;
+	}
+
+	struct GltfDocument
+	{
+		JsonValue Json;
+		std::vector<std::vector<unsigned char>> Buffers;
+
+		bool GetAccessor(int index, GltfAccessor& accessor, std::string& error) const
+		{
+			const JsonValue* json = Json.GetElement("accessors", index);
+			if (!json)
+			{
+				error = "missing accessor";
+				return false;
+			}
+			if (json->Find("sparse"))
+			{
+				error = "sparse accessors are not supported";
+				return false;
+			}
+
+			const std::string type = json->GetString("type");
+			const char* types[] = { "SCALAR", "VEC2", "VEC3", "VEC4" };
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				if (type == types[i])
+					accessor.Components = i + 1;
+			}
+			accessor.ComponentType = (unsigned int)json->GetInt("componentType", 0);
+			accessor.Count = (unsigned int)json->GetInt("count", 0);
+			const JsonValue* normalized = json->Find("normalized");
+			accessor.Normalized = normalized && normalized->Bool;
+
+			unsigned int elementSize = accessor.Components * GetComponentSize(accessor.ComponentType);
+			const JsonValue* view = Json.GetElement("bufferViews", json->GetInt("bufferView", -1));
+			if (elementSize == 0 || !view)
+			{
+				error = "unsupported accessor";
+				return false;
+			}
+
+			int buffer = view->GetInt("buffer", -1);
+			if (buffer < 0 || (size_t)buffer >= Buffers.size())
+			{
+				error = "missing buffer";
+				return false;
+			}
+
+			size_t offset = (size_t)view->GetNumber("byteOffset", 0) + (size_t)json->GetNumber("byteOffset", 0);
+			accessor.Stride = (unsigned int)view->GetInt("byteStride", 0);
+			if (accessor.Stride == 0)
+				accessor.Stride = elementSize;
+
+			size_t viewEnd = (size_t)view->GetNumber("byteOffset", 0) + (size_t)view->GetNumber("byteLength", 0);
+			if (accessor.Count > 0 && (offset + (size_t)accessor.Stride * (accessor.Count - 1) + elementSize > viewEnd || viewEnd > Buffers[buffer].size()))
+			{
+				error = "accessor out of range";
+				return false;
+			}
+			accessor.Data = Buffers[buffer].data() + offset;
+			return true;
+		}
+	};
+
+	bool ParseGltf(const std::vector<char>& file, const std::string& path, GltfDocument& document, std::string& error)
+	{
+		const char* json = file.data();
+		const char* jsonEnd = json + file.size();
+		std::vector<unsigned char> binaryChunk;
+
+		// Binary glTF is a header and a JSON chunk followed by an optional BIN chunk
+		uint32_t header[3] = {};
+		if (file.size() >= 12)
+			std::memcpy(header, file.data(), 12);
+		if (header[0] == 0x46546c67)
+		{
+			if (header[1] != 2 || file.size() < 20)
+			{
+				error = "unsupported GLB version";
+				return false;
+			}
+
+			size_t offset = 12;
+			bool hasJson = false;
+			while (offset + 8 <= file.size())
+			{
+				uint32_t chunk[2];
+				std::memcpy(chunk, file.data() + offset, 8);
+				offset += 8;
+				if (offset + chunk[0] > file.size())
+				{
+					error = "truncated GLB chunk";
+					return false;
+				}
+				if (chunk[1] == 0x4e4f534a && !hasJson)
+				{
+					json = file.data() + offset;
+					jsonEnd = json + chunk[0];
+					hasJson = true;
+				}
+				else if (chunk[1] == 0x004e4942 && binaryChunk.empty())
+				{
+					binaryChunk.assign(file.data() + offset, file.data() + offset + chunk[0]);
+				}
+				offset += (chunk[0] + 3) & ~3u;
+			}
+			if (!hasJson)
+			{
+				error = "GLB without JSON chunk";
+				return false;
+			}
+		}
+
+		JsonParser parser(json, jsonEnd);
+		if (!parser.Parse(document.Json) || document.Json.Kind != JsonValue::Type::Object)
+		{
+			error = "invalid JSON";
+			return false;
+		}
+
+		std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+		const JsonValue* buffers = document.Json.Find("buffers");
+		if (buffers && buffers->Kind == JsonValue::Type::Array)
+		{
+			for (const JsonValue& buffer : buffers->Elements)
+			{
+				std::string uri = buffer.GetString("uri");
+				document.Buffers.emplace_back();
+				std::vector<unsigned char>& data = document.Buffers.back();
+
+				if (uri.empty())
+				{
+					data = binaryChunk;
+				}
+				else if (uri.compare(0, 5, "data:") == 0)
+				{
+					size_t comma = uri.find(";base64,");
+					if (comma == std::string::npos || !DecodeBase64(uri.data() + comma + 8, uri.data() + uri.size(), data))
+					{
+						error = "unsupported data URI";
+						return false;
+					}
+				}
+				else
+				{
+					std::vector<char> bytes;
+					if (!ReadFile(directory + DecodeUri(uri), bytes))
+					{
+						error = "cannot read buffer " + uri;
+						return false;
+					}
+					data.assign(bytes.begin(), bytes.end());
+				}
+
+				if (data.size() < (size_t)buffer.GetNumber("byteLength", 0))
+				{
+					error = "buffer shorter than its byteLength";
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// One triangle primitive as placed in the scene by a node
+	struct GltfPrimitive
+	{
+		std::string Name;
+		glm::mat4 Transform;
+		glm::mat3 NormalTransform;
+		bool FlipWinding;
+		GltfAccessor Positions, Normals, TexCoords, Indices;
+		bool Indexed;
+		size_t FirstVertex;
+		size_t FirstIndex;
+
+		inline unsigned int GetIndexCount() const { return Indexed ? Indices.Count : Positions.Count; }
+	};
+
+	glm::mat4 GetNodeTransform(const JsonValue& node)
+	{
+		const JsonValue* matrix = node.Find("matrix");
+		if (matrix && matrix->Kind == JsonValue::Type::Array && matrix->Elements.size() == 16)
+		{
+			float values[16];
+			for (unsigned int i = 0; i < 16; i++)
+				values[i] = (float)matrix->Elements[i].Number;
+			return glm::make_mat4(values);
+		}
+
+		glm::vec3 translation(0.0f), scale(1.0f);
+		glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			if (const JsonValue* t = node.GetElement("translation", i))
+				translation[i] = (float)t->Number;
+			if (const JsonValue* s = node.GetElement("scale", i))
+				scale[i] = (float)s->Number;
+		}
+		const JsonValue* r = node.Find("rotation");
+		if (r && r->Kind == JsonValue::Type::Array && r->Elements.size() == 4)
+			rotation = glm::quat((float)r->Elements[3].Number, (float)r->Elements[0].Number, (float)r->Elements[1].Number, (float)r->Elements[2].Number);
+
+		return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+	}
+
+	bool CollectGltfPrimitives(const GltfDocument& document, std::vector<GltfPrimitive>& primitives, std::string& error)
+	{
+		const JsonValue& json = document.Json;
+		std::vector<std::pair<int, glm::mat4>> stack;
+
+		const JsonValue* scene = json.GetElement("scenes", json.GetInt("scene", 0));
+		if (scene)
+		{
+			const JsonValue* roots = scene->Find("nodes");
+			if (roots && roots->Kind == JsonValue::Type::Array)
+			{
+				for (auto it = roots->Elements.rbegin(); it != roots->Elements.rend(); ++it)
+					stack.push_back({ (int)it->Number, glm::mat4(1.0f) });
+			}
+		}
+		else
+		{
+			// Without scenes every mesh is drawn once, untransformed
+			const JsonValue* meshes = json.Find("meshes");
+			for (size_t i = 0; meshes && i < meshes->Elements.size(); i++)
+				stack.push_back({ -1 - (int)i, glm::mat4(1.0f) });
+		}
+
+		const JsonValue* nodes = json.Find("nodes");
+		unsigned int visited = 0;
+		while (!stack.empty())
+		{
+			int nodeIndex = stack.back().first;
+			glm::mat4 transform = stack.back().second;
+			stack.pop_back();
+
+			int meshIndex = -1 - nodeIndex;
+			if (nodeIndex >= 0)
+			{
+				// Guards against cycles in broken files
+				if (!nodes || (size_t)nodeIndex >= nodes->Elements.size() || ++visited > 1000000)
+				{
+					error = "invalid node hierarchy";
+					return false;
+				}
+
+				const JsonValue& node = nodes->Elements[nodeIndex];
+				transform = transform * GetNodeTransform(node);
+				meshIndex = node.GetInt("mesh", -1);
+
+				const JsonValue* children = node.Find("children");
+				if (children && children->Kind == JsonValue::Type::Array)
+				{
+					for (auto it = children->Elements.rbegin(); it != children->Elements.rend(); ++it)
+						stack.push_back({ (int)it->Number, transform });
+				}
+			}
+
+			const JsonValue* mesh = json.GetElement("meshes", meshIndex);
+			const JsonValue* meshPrimitives = mesh ? mesh->Find("primitives") : nullptr;
+			if (!meshPrimitives || meshPrimitives->Kind != JsonValue::Type::Array)
+				continue;
+
+			for (size_t p = 0; p < meshPrimitives->Elements.size(); p++)
+			{
+				const JsonValue& primitive = meshPrimitives->Elements[p];
+				const JsonValue* attributes = primitive.Find("attributes");
+				if (primitive.GetInt("mode", GL_TRIANGLES) != GL_TRIANGLES || !attributes || !attributes->Find("POSITION"))
+					continue;
+
+				GltfPrimitive instance;
+				std::string name = mesh->GetString("name");
+				instance.Name = (name.empty() ? "mesh" + std::to_string(meshIndex) : name) + "/" + std::to_string(p);
+				instance.Transform = transform;
+				instance.NormalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+				instance.FlipWinding = glm::determinant(glm::mat3(transform)) < 0.0f;
+
+				if (!document.GetAccessor(attributes->GetInt("POSITION", -1), instance.Positions, error))
+					return false;
+				if (attributes->Find("NORMAL") && !document.GetAccessor(attributes->GetInt("NORMAL", -1), instance.Normals, error))
+					return false;
+				if (attributes->Find("TEXCOORD_0") && !document.GetAccessor(attributes->GetInt("TEXCOORD_0", -1), instance.TexCoords, error))
+					return false;
+				instance.Indexed = primitive.Find("indices") != nullptr;
+				if (instance.Indexed && !document.GetAccessor(primitive.GetInt("indices", -1), instance.Indices, error))
+					return false;
+
+				if (instance.Positions.Components != 3 || (instance.Normals.Data && instance.Normals.Components != 3) ||
+					(instance.TexCoords.Data && instance.TexCoords.Components != 2) || (instance.Indexed && instance.Indices.Components != 1) ||
+					(instance.Normals.Data && instance.Normals.Count != instance.Positions.Count) ||
+					(instance.TexCoords.Data && instance.TexCoords.Count != instance.Positions.Count))
+				{
+					error = "unexpected accessor type";
+					return false;
+				}
+
+				primitives.push_back(instance);
+			}
+		}
+		return true;
+	}
+
+	bool LoadGltf(const std::vector<char>& file, const std::string& path, const std::vector<MeshImporter::Attribute>& attributes,
+		unsigned int stride, MeshImporter::Mesh& mesh, unsigned int parallelism, std::string& error)
+	{
+		ThreadPool& pool = ThreadPool::Get();
+		GltfDocument document;
+		std::vector<GltfPrimitive> primitives;
+		if (!ParseGltf(file, path, document, error) || !CollectGltfPrimitives(document, primitives, error))
+			return false;
+
+		size_t vertexCount = 0, indexCount = 0;
+		for (GltfPrimitive& primitive : primitives)
+		{
+			primitive.FirstVertex = vertexCount;
+			primitive.FirstIndex = indexCount;
+			vertexCount += primitive.Positions.Count;
+			indexCount += primitive.GetIndexCount() / 3 * 3;
+			mesh.Submeshes.push_back({ primitive.Name, (unsigned int)primitive.FirstIndex, primitive.GetIndexCount() / 3 * 3 });
+		}
+		if (vertexCount > 0xffffffffu || indexCount > 0xffffffffu)
+		{
+			error = "too many vertices";
+			return false;
+		}
+
+		// Items are split evenly, the primitive of every item is found by searching the starts
+		auto findPrimitive = [&](size_t item, bool indices) {
+			auto it = std::upper_bound(primitives.begin(), primitives.end(), item, [indices](size_t value, const GltfPrimitive& primitive) {
+				return value < (indices ? primitive.FirstIndex : primitive.FirstVertex);
+			});
+			return (size_t)(it - primitives.begin()) - 1;
+		};
+
+		mesh.Vertices.resize(vertexCount * stride);
+		pool.ParallelFor((unsigned int)vertexCount, parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (size_t p = findPrimitive(begin, false); p < primitives.size() && primitives[p].FirstVertex < end; p++)
+			{
+				const GltfPrimitive& primitive = primitives[p];
+				size_t first = std::max<size_t>(begin, primitive.FirstVertex);
+				size_t last = std::min<size_t>(end, primitive.FirstVertex + primitive.Positions.Count);
+
+				for (size_t v = first; v < last; v++)
+				{
+					unsigned int source = (unsigned int)(v - primitive.FirstVertex);
+					float* output = &mesh.Vertices[v * stride];
+					for (MeshImporter::Attribute attribute : attributes)
+					{
+						switch (attribute)
+						{
+						case MeshImporter::Attribute::Position:
+						{
+							glm::vec4 position(primitive.Positions.ReadFloat(source, 0), primitive.Positions.ReadFloat(source, 1),
+								primitive.Positions.ReadFloat(source, 2), 1.0f);
+							position = primitive.Transform * position;
+							output[0] = position.x; output[1] = position.y; output[2] = position.z;
+							output += 3;
+							break;
+						}
+						case MeshImporter::Attribute::Normal:
+						{
+							glm::vec3 normal(0.0f);
+							if (primitive.Normals.Data)
+							{
+								normal = primitive.NormalTransform * glm::vec3(primitive.Normals.ReadFloat(source, 0),
+									primitive.Normals.ReadFloat(source, 1), primitive.Normals.ReadFloat(source, 2));
+								float length = glm::length(normal);
+								if (length > 0.0f)
+									normal = normal / length;
+							}
+							output[0] = normal.x; output[1] = normal.y; output[2] = normal.z;
+							output += 3;
+							break;
+						}
+						case MeshImporter::Attribute::TexCoord:
+							output[0] = primitive.TexCoords.Data ? primitive.TexCoords.ReadFloat(source, 0) : 0.0f;
+							output[1] = primitive.TexCoords.Data ? 1.0f - primitive.TexCoords.ReadFloat(source, 1) : 0.0f;
+							output += 2;
+							break;
+						}
+					}
+				}
+			}
+		});
+
+		mesh.Indices.resize(indexCount);
+		std::atomic<bool> outOfRange(false);
+		pool.ParallelFor((unsigned int)indexCount, parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+			for (size_t p = findPrimitive(begin, true); p < primitives.size() && primitives[p].FirstIndex < end; p++)
+			{
+				const GltfPrimitive& primitive = primitives[p];
+				size_t first = std::max<size_t>(begin, primitive.FirstIndex);
+				size_t last = std::min<size_t>(end, primitive.FirstIndex + primitive.GetIndexCount() / 3 * 3);
+
+				for (size_t i = first; i < last; i++)
+				{
+					// Mirroring transforms turn triangles inside out, swap two corners back
+					unsigned int k = (unsigned int)(i - primitive.FirstIndex);
+					if (primitive.FlipWinding && k % 3 != 0)
+						k += k % 3 == 1 ? 1 : -1;
+
+					unsigned int index = primitive.Indexed ? primitive.Indices.ReadIndex(k) : k;
+					if (index >= primitive.Positions.Count)
+					{
+						outOfRange = true;
+						index = 0;
+					}
+					mesh.Indices[i] = (unsigned int)primitive.FirstVertex + index;
+				}
+			}
+		});
+		if (outOfRange)
+		{
+			error = "index out of range";
+			return false;
+		}
+		return true;
+	}
+
+	// Benchmark samples
+
+	void WriteSampleKnot(unsigned int tubular, unsigned int radial, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+	{
+		auto knot = [](float t) {
+			float r = 2.0f + std::cos(3.0f * t);
+			return glm::vec3(r * std::cos(2.0f * t), r * std::sin(2.0f * t), -std::sin(3.0f * t));
+		};
+
+		for (unsigned int i = 0; i <= tubular; i++)
+		{
+			float t = (float)i / tubular * 2.0f * 3.14159265f;
+			glm::vec3 p1 = knot(t), p2 = knot(t + 0.001f);
+			glm::vec3 tangent = p2 - p1;
+			glm::vec3 bitangent = glm::normalize(glm::cross(tangent, p2 + p1));
+			glm::vec3 normal = glm::normalize(glm::cross(bitangent, tangent));
+
+			for (unsigned int j = 0; j <= radial; j++)
+			{
+				float v = (float)j / radial * 2.0f * 3.14159265f;
+				glm::vec3 direction = std::cos(v) * normal + std::sin(v) * bitangent;
+				glm::vec3 position = p1 + 0.4f * direction;
+				vertices.insert(vertices.end(), { position.x, position.y, position.z, direction.x, direction.y, direction.z,
+					(float)i / tubular * 8.0f, (float)j / radial });
+			}
+		}
+
+		for (unsigned int i = 0; i < tubular; i++)
+		{
+			for (unsigned int j = 0; j < radial; j++)
+			{
+				unsigned int a = i * (radial + 1) + j, b = a + radial + 1;
+				indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+			}
+		}
+	}
+
+	bool WriteSampleObj(const std::string& path, const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+	{
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		for (size_t v = 0; v < vertices.size(); v += 8)
+			std::fprintf(file, "v %.6f %.6f %.6f\n", vertices[v], vertices[v + 1], vertices[v + 2]);
+		for (size_t v = 0; v < vertices.size(); v += 8)
+			std::fprintf(file, "vt %.6f %.6f\n", vertices[v + 6], vertices[v + 7]);
+		for (size_t v = 0; v < vertices.size(); v += 8)
+			std::fprintf(file, "vn %.6f %.6f %.6f\n", vertices[v + 3], vertices[v + 4], vertices[v + 5]);
+		std::fprintf(file, "o knot\n");
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			unsigned int a = indices[i] + 1, b = indices[i + 1] + 1, c = indices[i + 2] + 1;
+			std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+		}
+		return std::fclose(file) == 0;
+	}
+
+	bool WriteSampleGlb(const std::string& path, const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+	{
+		unsigned int vertexCount = (unsigned int)(vertices.size() / 8);
+		size_t vertexBytes = vertices.size() * sizeof(float);
+		size_t indexBytes = indices.size() * sizeof(unsigned int);
+
+		// Interleaved position, normal and texture coordinate, as it comes out of the knot generator
+		std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+			"\"meshes\":[{\"name\":\"knot\",\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+			"\"buffers\":[{\"byteLength\":" + std::to_string(vertexBytes + indexBytes) + "}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(vertexBytes) + ",\"byteStride\":32},"
+			"{\"buffer\":0,\"byteOffset\":" + std::to_string(vertexBytes) + ",\"byteLength\":" + std::to_string(indexBytes) + "}],"
+			"\"accessors\":["
+			"{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+			"{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+			"{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC2\"},"
+			"{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(indices.size()) + ",\"type\":\"SCALAR\"}]}";
+		while (json.size() % 4 != 0)
+			json += ' ';
+
+		// glTF texture coordinates start at the top
+		std::vector<float> flipped = vertices;
+		for (size_t v = 0; v < flipped.size(); v += 8)
+			flipped[v + 7] = 1.0f - flipped[v + 7];
+
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		uint32_t jsonHeader[2] = { (uint32_t)json.size(), 0x4e4f534a };
+		uint32_t binaryHeader[2] = { (uint32_t)(vertexBytes + indexBytes), 0x004e4942 };
+		uint32_t header[3] = { 0x46546c67, 2, (uint32_t)(12 + 8 + json.size() + 8 + vertexBytes + indexBytes) };
+		std::fwrite(header, sizeof(header), 1, file);
+		std::fwrite(jsonHeader, sizeof(jsonHeader), 1, file);
+		std::fwrite(json.data(), json.size(), 1, file);
+		std::fwrite(binaryHeader, sizeof(binaryHeader), 1, file);
+		std::fwrite(flipped.data(), vertexBytes, 1, file);
+		std::fwrite(indices.data(), indexBytes, 1, file);
+		return std::fclose(file) == 0;
+	}
+
+}
+
+unsigned int MeshImporter::GetComponentCount(Attribute attribute)
+{
+	switch (attribute)
+	{
+	case Attribute::Position:	return 3;
+	case Attribute::Normal:		return 3;
+	case Attribute::TexCoord:	return 2;
+	}
+	return 0;
+}
+
+bool MeshImporter::ParseAttribute(const char* name, Attribute& attribute)
+{
+	const char* names[] = { "position", "normal", "texcoord" };
+	for (int i = 0; i < 3; i++)
+	{
+		if (std::strcmp(name, names[i]) == 0)
+		{
+			attribute = (Attribute)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool MeshImporter::Load(const std::string& path, const std::vector<Attribute>& attributes, Mesh& mesh, unsigned int parallelism)
+{
+	PROFILE_SCOPE("MeshImporter::Load");
+	auto start = Clock::now();
+	mesh = Mesh();
+	mesh.LoadStats.Threads = parallelism = GetParallelism(parallelism);
+
+	unsigned int stride = 0;
+	for (Attribute attribute : attributes)
+	{
+		mesh.Layout.Push<float>(GetComponentCount(attribute));
+		stride += GetComponentCount(attribute);
+	}
+
+	std::vector<char> file;
+	if (!ReadFile(path, file))
+	{
+		std::cout << "Failed to load mesh " << path << ": cannot read file" << std::endl;
+		return false;
+	}
+	mesh.LoadStats.FileBytes = file.size();
+	mesh.LoadStats.ReadMs = GetMilliseconds(start);
+
+	auto parseStart = Clock::now();
+	std::string error;
+	bool loaded;
+	if (EndsWith(path, ".obj"))
+		loaded = LoadObj(file, attributes, stride, mesh, parallelism, error);
+	else if (EndsWith(path, ".gltf") || EndsWith(path, ".glb"))
+		loaded = LoadGltf(file, path, attributes, stride, mesh, parallelism, error);
+	else
+	{
+		loaded = false;
+		error = "unknown file type";
+	}
+	if (!loaded || stride == 0)
+	{
+		std::cout << "Failed to load mesh " << path << ": " << (loaded ? "no attributes requested" : error) << std::endl;
+		mesh = Mesh();
+		return false;
+	}
+	mesh.LoadStats.ParseMs = GetMilliseconds(parseStart);
+
+	auto deduplicateStart = Clock::now();
+	mesh.LoadStats.SourceVertices = (unsigned int)(mesh.Vertices.size() / stride);
+	std::vector<unsigned int> remap = Deduplicate(mesh.Vertices, stride, parallelism);
+	ThreadPool::Get().ParallelFor((unsigned int)mesh.Indices.size(), parallelism, [&](unsigned int begin, unsigned int end, unsigned int) {
+		for (unsigned int i = begin; i < end; i++)
+			mesh.Indices[i] = remap[mesh.Indices[i]];
+	});
+	mesh.VertexCount = (unsigned int)(mesh.Vertices.size() / stride);
+	mesh.LoadStats.DeduplicateMs = GetMilliseconds(deduplicateStart);
+
+	mesh.LoadStats.Vertices = mesh.VertexCount;
+	mesh.LoadStats.Triangles = (unsigned int)(mesh.Indices.size() / 3);
+	mesh.LoadStats.TotalMs = GetMilliseconds(start);
+	return true;
+}
+
+std::vector<std::string> MeshImporter::WriteBenchmarkMeshes()
+{
+	// About a million triangles, roughly 110 MB of OBJ and 30 MB of GLB
+	std::cout << "Writing benchmark meshes..." << std::endl;
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	WriteSampleKnot(8192, 64, vertices, indices);
+
+	std::vector<std::string> paths;
+	if (WriteSampleObj("MeshImporterBenchmark.obj", vertices, indices))
+		paths.push_back("MeshImporterBenchmark.obj");
+	if (WriteSampleGlb("MeshImporterBenchmark.glb", vertices, indices))
+		paths.push_back("MeshImporterBenchmark.glb");
+	return paths;
+}
+
+void MeshImporter::Benchmark(const std::vector<std::string>& paths)
+{
+	std::vector<std::string> generated;
+	if (paths.empty())
+		generated = WriteBenchmarkMeshes();
+	const std::vector<std::string>& files = paths.empty() ? generated : paths;
+
+	const std::vector<Attribute> attributes = { Attribute::Position, Attribute::Normal, Attribute::TexCoord };
+	const unsigned int threadCounts[] = { 1, GetParallelism(0) };
+
+	std::cout << "Mesh import benchmark (best of 3)" << std::endl;
+	std::cout << std::left << std::setw(32) << "File" << std::right << std::setw(8) << "Threads" << std::setw(10) << "MB"
+		<< std::setw(12) << "Triangles" << std::setw(12) << "Vertices" << std::setw(10) << "ms" << std::setw(10) << "MB/s"
+		<< std::setw(14) << "Mtris/s" << std::endl;
+
+	for (const std::string& file : files)
+	{
+		for (unsigned int threads : threadCounts)
+		{
+			Stats best;
+			bool loaded = true;
+			for (int run = 0; run < 3 && loaded; run++)
+			{
+				Mesh mesh;
+				loaded = Load(file, attributes, mesh, threads);
+				if (loaded && (run == 0 || mesh.LoadStats.TotalMs < best.TotalMs))
+					best = mesh.LoadStats;
+			}
+			if (!loaded)
+				break;
+
+			std::string name = file.size() > 30 ? "..." + file.substr(file.size() - 27) : file;
+			std::cout << std::left << std::setw(32) << name << std::right << std::setw(8) << best.Threads << std::fixed << std::setprecision(1)
+				<< std::setw(10) << best.FileBytes / (1024.0f * 1024.0f) << std::setw(12) << best.Triangles << std::setw(12) << best.Vertices
+				<< std::setw(10) << best.TotalMs << std::setw(10) << best.GetMegabytesPerSecond()
+				<< std::setprecision(2) << std::setw(14) << best.GetTrianglesPerSecond() / 1e6f << std::endl;
+			std::cout.unsetf(std::ios_base::floatfield);
+
+			// A second run with the same thread count would measure nothing new
+			if (threadCounts[0] == threadCounts[1])
+				break;
+		}
+	}
+
+	for (const std::string& file : generated)
+		std::remove(file.c_str());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+// Loads triangle meshes from Wavefront OBJ and glTF 2.0 (.gltf with external or
+// base64 embedded buffers, and .glb) files. Vertices come out interleaved in the
+// order of the requested attributes, which should be the attribute locations of
+// the shader, and Layout describes them. Attributes a file lacks are zero.
+// Identical vertices are merged, keeping the order of first use, so the result
+// can go straight into a VertexBuffer and IndexBuffer or through MeshOptimizer.
+//
+// OBJ text is parsed in chunks, and vertex expansion and merging are split over
+// ThreadPool::Get() too, so Load must not be called from a pool task. For glTF
+// the node transforms of the default scene are applied and texture coordinates
+// are flipped to GL's bottom left origin, as Texture flips images on load.
+// Materials, skins, morph targets, sparse accessors and primitives other than
+// triangle lists are ignored.
+class MeshImporter
+{
+public:
+	enum class Attribute
+	{
+		Position, Normal, TexCoord
+	};
+
+	// One per OBJ object, group or material, one per glTF primitive
+	struct Submesh
+	{
+		std::string Name;
+		unsigned int FirstIndex;
+		unsigned int IndexCount;
+	};
+
+	struct Stats
+	{
+		size_t FileBytes = 0;
+		unsigned int Triangles = 0;
+		// Before and after merging identical vertices
+		unsigned int SourceVertices = 0;
+		unsigned int Vertices = 0;
+		unsigned int Threads = 0;
+		float ReadMs = 0.0f;
+		float ParseMs = 0.0f;
+		float DeduplicateMs = 0.0f;
+		float TotalMs = 0.0f;
+
+		inline float GetMegabytesPerSecond() const { return TotalMs > 0.0f ? FileBytes / (1024.0f * 1024.0f) / (TotalMs / 1000.0f) : 0.0f; }
+		inline float GetTrianglesPerSecond() const { return TotalMs > 0.0f ? Triangles / (TotalMs / 1000.0f) : 0.0f; }
+	};
+
+	struct Mesh
+	{
+		std::vector<float> Vertices;
+		std::vector<unsigned int> Indices;
+		std::vector<Submesh> Submeshes;
+		VertexBufferLayout Layout;
+		unsigned int VertexCount = 0;
+		Stats LoadStats;
+	};
+
+	// parallelism 0 uses every pool thread. Prints the reason and returns false on failure.
+	static bool Load(const std::string& path, const std::vector<Attribute>& attributes, Mesh& mesh, unsigned int parallelism = 0);
+
+	// Times loads with one thread and with all of them and prints MB/s and
+	// triangles/s. Without paths it writes a large OBJ and GLB of its own.
+	static void Benchmark(const std::vector<std::string>& paths);
+	// Writes the generated benchmark meshes to the working directory and returns
+	// their paths, the caller deletes them
+	static std::vector<std::string> WriteBenchmarkMeshes();
+
+	static unsigned int GetComponentCount(Attribute attribute);
+	// "position", "normal" or "texcoord"
+	static bool ParseAttribute(const char* name, Attribute& attribute);
+};
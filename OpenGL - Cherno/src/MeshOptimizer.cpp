@@ -0,0 +1,389 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Profiler.h"
+
+namespace {
+
+	// Triangles using each vertex, as offsets into one flat array
+	struct Adjacency
+	{
+		std::vector<unsigned int> Offsets;
+		std::vector<unsigned int> Triangles;
+
+		Adjacency(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount)
+			: Offsets(vertexCount + 1, 0), Triangles(indexCount)
+		{
+			for (unsigned int i = 0; i < indexCount; i++)
+				Offsets[indices[i] + 1]++;
+			for (unsigned int v = 0; v < vertexCount; v++)
+				Offsets[v + 1] += Offsets[v];
+
+			std::vector<unsigned int> fill(Offsets.begin(), Offsets.end() - 1);
+			for (unsigned int i = 0; i < indexCount; i++)
+				Triangles[fill[indices[i]]++] = i / 3;
+		}
+	};
+
+	// A vertex is in the cache while fewer than cacheSize misses happened since its own
+	struct CacheTimestamps
+	{
+		std::vector<unsigned int> Timestamps;
+		unsigned int Time;
+		unsigned int CacheSize;
+
+		CacheTimestamps(unsigned int vertexCount, unsigned int cacheSize)
+			: Timestamps(vertexCount, 0), Time(cacheSize + 1), CacheSize(cacheSize)
+		{
+		}
+
+		bool Touch(unsigned int vertex)
+		{
+			if (Time - Timestamps[vertex] <= CacheSize)
+				return false;
+			Timestamps[vertex] = Time++;
+			return true;
+		}
+
+		unsigned int TouchTriangle(const unsigned int* triangle)
+		{
+			return Touch(triangle[0]) + Touch(triangle[1]) + Touch(triangle[2]);
+		}
+
+		// Everything that was cached counts as evicted
+		inline void Flush() { Time += CacheSize + 1; }
+	};
+
+	struct Vec3
+	{
+		float x, y, z;
+	};
+
+	inline Vec3 GetPosition(const unsigned char* vertices, unsigned int vertexSize, unsigned int positionOffset, unsigned int vertex)
+	{
+		Vec3 position;
+		std::memcpy(&position, vertices + (size_t)vertex * vertexSize + positionOffset, sizeof(Vec3));
+		return position;
+	}
+
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+	unsigned int cacheSize)
+{
+	PROFILE_SCOPE("MeshOptimizer::OptimizeVertexCache");
+	// A trailing partial triangle is left where it is
+	unsigned int triangleCount = indexCount / 3;
+	indexCount = triangleCount * 3;
+	if (triangleCount == 0)
+		return;
+
+	Adjacency adjacency(indices, indexCount, vertexCount);
+
+	std::vector<unsigned int> liveTriangles(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		liveTriangles[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> result;
+	result.reserve(indexCount);
+
+	unsigned int cursor = 0;
+	int fanning = (int)indices[0];
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		for (unsigned int a = adjacency.Offsets[fanning]; a < adjacency.Offsets[fanning + 1]; a++)
+		{
+			unsigned int triangle = adjacency.Triangles[a];
+			if (emitted[triangle])
+				continue;
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				unsigned int v = indices[triangle * 3 + k];
+				result.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+
+				if (time - timestamps[v] > cacheSize)
+					timestamps[v] = time++;
+			}
+			emitted[triangle] = true;
+		}
+
+		// Prefer the candidate that stays in the cache longest while its remaining triangles are emitted
+		fanning = -1;
+		int bestPriority = -1;
+		for (unsigned int v : candidates)
+		{
+			if (liveTriangles[v] == 0)
+				continue;
+
+			int priority = 0;
+			if (time - timestamps[v] + 2 * liveTriangles[v] <= cacheSize)
+				priority = (int)(time - timestamps[v]);
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fanning = (int)v;
+			}
+		}
+
+		// Dead end, fall back to a recently used vertex, then to any vertex with triangles left
+		while (fanning < 0 && !deadEnd.empty())
+		{
+			unsigned int v = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[v] > 0)
+				fanning = (int)v;
+		}
+		while (fanning < 0 && cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+				fanning = (int)cursor;
+			cursor++;
+		}
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const void* vertices, unsigned int vertexCount,
+	unsigned int vertexSize, unsigned int positionOffset, float threshold, unsigned int cacheSize)
+{
+	PROFILE_SCOPE("MeshOptimizer::OptimizeOverdraw");
+	// A trailing partial triangle is left where it is
+	unsigned int triangleCount = indexCount / 3;
+	indexCount = triangleCount * 3;
+	if (triangleCount == 0)
+		return;
+
+	// Hard boundaries: triangles missing the cache with all three vertices start anew anyway
+	CacheTimestamps cache(vertexCount, cacheSize);
+	std::vector<unsigned int> hardClusters;
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		if (cache.TouchTriangle(indices + t * 3) == 3 || t == 0)
+			hardClusters.push_back(t);
+	}
+	hardClusters.push_back(triangleCount);
+
+	// Soft boundaries: cut a hard cluster wherever its ACMR so far is already within
+	// threshold of the whole cluster's, the cache flush there costs little
+	std::vector<unsigned int> clusters;
+	for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+	{
+		unsigned int start = hardClusters[c], end = hardClusters[c + 1];
+
+		cache.Flush();
+		unsigned int clusterMisses = 0;
+		for (unsigned int t = start; t < end; t++)
+			clusterMisses += cache.TouchTriangle(indices + t * 3);
+		float clusterThreshold = threshold * (float)clusterMisses / (float)(end - start);
+
+		clusters.push_back(start);
+		cache.Flush();
+		unsigned int runningMisses = 0, runningTriangles = 0;
+		for (unsigned int t = start; t < end; t++)
+		{
+			runningMisses += cache.TouchTriangle(indices + t * 3);
+			runningTriangles++;
+
+			if ((float)runningMisses / (float)runningTriangles <= clusterThreshold && t + 1 < end)
+			{
+				clusters.push_back(t + 1);
+				cache.Flush();
+				runningMisses = runningTriangles = 0;
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+
+	const unsigned char* vertexData = (const unsigned char*)vertices;
+
+	Vec3 meshCenter = { 0.0f, 0.0f, 0.0f };
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		Vec3 p = GetPosition(vertexData, vertexSize, positionOffset, indices[i]);
+		meshCenter.x += p.x;
+		meshCenter.y += p.y;
+		meshCenter.z += p.z;
+	}
+	meshCenter.x /= (float)indexCount;
+	meshCenter.y /= (float)indexCount;
+	meshCenter.z /= (float)indexCount;
+
+	// Area weighted center and normal per cluster, the further out the cluster
+	// lies along its normal the earlier it is drawn
+	size_t clusterCount = clusters.size() - 1;
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		Vec3 center = { 0.0f, 0.0f, 0.0f }, normal = { 0.0f, 0.0f, 0.0f };
+		float totalArea = 0.0f;
+
+		for (unsigned int t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			Vec3 p0 = GetPosition(vertexData, vertexSize, positionOffset, indices[t * 3 + 0]);
+			Vec3 p1 = GetPosition(vertexData, vertexSize, positionOffset, indices[t * 3 + 1]);
+			Vec3 p2 = GetPosition(vertexData, vertexSize, positionOffset, indices[t * 3 + 2]);
+
+			Vec3 e1 = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+			Vec3 e2 = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+			Vec3 n = { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+			float area = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+			center.x += (p0.x + p1.x + p2.x) / 3.0f * area;
+			center.y += (p0.y + p1.y + p2.y) / 3.0f * area;
+			center.z += (p0.z + p1.z + p2.z) / 3.0f * area;
+			normal.x += n.x;
+			normal.y += n.y;
+			normal.z += n.z;
+			totalArea += area;
+		}
+
+		float normalLength = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+		if (totalArea > 0.0f && normalLength > 0.0f)
+		{
+			sortKeys[c] = ((center.x / totalArea - meshCenter.x) * normal.x + (center.y / totalArea - meshCenter.y) * normal.y +
+				(center.z / totalArea - meshCenter.z) * normal.z) / normalLength;
+		}
+		else
+		{
+			sortKeys[c] = 0.0f;
+		}
+	}
+
+	std::vector<unsigned int> order(clusterCount);
+	for (unsigned int c = 0; c < clusterCount; c++)
+		order[c] = c;
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<unsigned int> result;
+	result.reserve(triangleCount * 3);
+	for (unsigned int c : order)
+		result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+	unsigned int* indices, unsigned int indexCount)
+{
+	PROFILE_SCOPE("MeshOptimizer::OptimizeVertexFetch");
+	const unsigned int unused = ~0u;
+	std::vector<unsigned int> remap(vertexCount, unused);
+
+	unsigned char* vertexData = (unsigned char*)vertices;
+	std::vector<unsigned char> source(vertexData, vertexData + (size_t)vertexCount * vertexSize);
+
+	unsigned int next = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int& target = remap[indices[i]];
+		if (target == unused)
+		{
+			std::memcpy(vertexData + (size_t)next * vertexSize, source.data() + (size_t)indices[i] * vertexSize, vertexSize);
+			target = next++;
+		}
+		indices[i] = target;
+	}
+	return next;
+}
+
+unsigned int MeshOptimizer::Optimize(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+	unsigned int* indices, unsigned int indexCount, unsigned int positionOffset)
+{
+	OptimizeVertexCache(indices, indexCount, vertexCount);
+	OptimizeOverdraw(indices, indexCount, vertices, vertexCount, vertexSize, positionOffset);
+	return OptimizeVertexFetch(vertices, vertexCount, vertexSize, indices, indexCount);
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount,
+	unsigned int vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStats stats;
+	stats.Triangles = indexCount / 3;
+
+	// A real FIFO, unlike the timestamp approximation the optimizers use
+	std::vector<unsigned int> fifo(cacheSize, ~0u);
+	std::vector<bool> cached(vertexCount, false), seen(vertexCount, false);
+	unsigned int head = 0;
+
+	for (unsigned int i = 0; i < stats.Triangles * 3; i++)
+	{
+		unsigned int v = indices[i];
+		if (!seen[v])
+		{
+			seen[v] = true;
+			stats.Vertices++;
+		}
+		if (cached[v])
+			continue;
+
+		stats.Misses++;
+		if (fifo[head] != ~0u)
+			cached[fifo[head]] = false;
+		fifo[head] = v;
+		cached[v] = true;
+		head = (head + 1) % cacheSize;
+	}
+
+	if (stats.Triangles > 0)
+		stats.ACMR = (float)stats.Misses / (float)stats.Triangles;
+	if (stats.Vertices > 0)
+		stats.ATVR = (float)stats.Misses / (float)stats.Vertices;
+	return stats;
+}
+
+MeshOptimizer::VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const unsigned int* indices, unsigned int indexCount,
+	unsigned int vertexCount, unsigned int vertexSize)
+{
+	const unsigned int lineSize = 64;
+	const unsigned int lineCount = 16 * 1024 / lineSize;
+
+	VertexFetchStats stats;
+	std::vector<size_t> tags(lineCount, ~(size_t)0);
+	std::vector<bool> seen(vertexCount, false);
+	unsigned int uniqueVertices = 0;
+
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int v = indices[i];
+		if (!seen[v])
+		{
+			seen[v] = true;
+			uniqueVertices++;
+		}
+
+		size_t begin = (size_t)v * vertexSize / lineSize;
+		size_t end = ((size_t)v * vertexSize + vertexSize - 1) / lineSize;
+		for (size_t line = begin; line <= end; line++)
+		{
+			size_t& tag = tags[line % lineCount];
+			if (tag != line)
+			{
+				tag = line;
+				stats.BytesFetched += lineSize;
+			}
+		}
+	}
+
+	if (uniqueVertices > 0)
+		stats.Overfetch = (float)stats.BytesFetched / (float)((size_t)uniqueVertices * vertexSize);
+	return stats;
+}
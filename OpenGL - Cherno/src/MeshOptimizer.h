@@ -0,0 +1,62 @@
+#pragma once
+
+// Reorders mesh data on the CPU before it goes into a VertexBuffer/IndexBuffer,
+// so the GPU transforms and fetches each vertex as few times as possible.
+// The usual order is OptimizeVertexCache, then OptimizeOverdraw, then
+// OptimizeVertexFetch, which Optimize runs in one go. Index data is a plain
+// triangle list of unsigned ints, vertices are interleaved with a fixed stride
+// and, where positions are needed, start with or contain three floats.
+// Indices past the last whole triangle are not reordered.
+class MeshOptimizer
+{
+public:
+	static const unsigned int DefaultCacheSize = 16;
+
+	struct VertexCacheStats
+	{
+		unsigned int Triangles = 0;
+		unsigned int Vertices = 0;
+		unsigned int Misses = 0;
+		// Average cache miss ratio, vertex shader runs per triangle. 0.5 is the
+		// ideal for large regular grids, 3 means no reuse at all.
+		float ACMR = 0.0f;
+		// Average transform to vertex ratio, vertex shader runs per vertex. 1 is ideal.
+		float ATVR = 0.0f;
+	};
+
+	struct VertexFetchStats
+	{
+		unsigned int BytesFetched = 0;
+		// Bytes fetched over the size of the vertices used, 1 is ideal
+		float Overfetch = 0.0f;
+	};
+
+	// Tipsify (Sander et al., "Fast Triangle Reordering for Vertex Locality and
+	// Reduced Overdraw"): fans around the most recently used vertex that is still
+	// in the cache, running in linear time
+	static void OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize);
+
+	// Splits the vertex cache ordered triangles into clusters at points where that
+	// costs little cache efficiency, then draws the clusters facing away from the
+	// mesh center first, as those are the most likely to occlude the rest.
+	// threshold is the ACMR a cluster may lose against the input order, 1.05 = 5%.
+	static void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const void* vertices, unsigned int vertexCount,
+		unsigned int vertexSize, unsigned int positionOffset = 0, float threshold = 1.05f, unsigned int cacheSize = DefaultCacheSize);
+
+	// Puts vertices in the order the indices first use them and remaps the indices.
+	// Unreferenced vertices are dropped, returns the new vertex count.
+	static unsigned int OptimizeVertexFetch(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+		unsigned int* indices, unsigned int indexCount);
+
+	// All three passes, returns the new vertex count
+	static unsigned int Optimize(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+		unsigned int* indices, unsigned int indexCount, unsigned int positionOffset = 0);
+
+	// Simulates a FIFO post-transform cache of cacheSize vertices
+	static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize);
+	// Simulates a 16 KB direct-mapped cache of 64 byte lines in front of the vertex buffer
+	static VertexFetchStats AnalyzeVertexFetch(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int vertexSize);
+};
@@ -0,0 +1,249 @@
+#include "MeshQuantizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Profiler.h"
+
+namespace {
+
+	enum class Format
+	{
+		Packed1010102, Snorm16, Half, Float
+	};
+
+	// Two byte formats get an even component count so every attribute stays 4 byte aligned
+	unsigned int GetStoredCount(Format format, unsigned int count)
+	{
+		switch (format)
+		{
+		case Format::Packed1010102:	return 4;
+		case Format::Snorm16:
+		case Format::Half:			return (count + 1) & ~1u;
+		default:					return count;
+		}
+	}
+
+	unsigned int GetStoredSize(Format format, unsigned int count)
+	{
+		switch (format)
+		{
+		case Format::Packed1010102:	return sizeof(Packed1010102);
+		case Format::Snorm16:		return GetStoredCount(format, count) * sizeof(int16_t);
+		case Format::Half:			return GetStoredCount(format, count) * sizeof(Half);
+		default:					return count * sizeof(float);
+		}
+	}
+
+	float GetSnormError(float value, float scale, float offset, unsigned int bits)
+	{
+		int32_t stored = VertexFormats::FloatToSnorm((value - offset) / scale, bits);
+		float decoded = VertexFormats::SnormToFloat(stored, bits) * scale + offset;
+		float legacy = VertexFormats::SnormToFloatLegacy(stored, bits) * scale + offset;
+		return std::max(std::abs(decoded - value), std::abs(legacy - value));
+	}
+
+	float GetHalfError(float value)
+	{
+		float decoded = VertexFormats::HalfToFloat(VertexFormats::FloatToHalf(value));
+		return std::isfinite(decoded) ? std::abs(decoded - value) : std::numeric_limits<float>::infinity();
+	}
+
+}
+
+MeshQuantizer::Result MeshQuantizer::Quantize(const float* vertices, unsigned int vertexCount, const std::vector<Attribute>& attributes)
+{
+	PROFILE_SCOPE("MeshQuantizer::Quantize");
+	Result result;
+	result.VertexCount = vertexCount;
+	for (const Attribute& attribute : attributes)
+		result.SourceStride += attribute.Count;
+
+	std::vector<Format> formats;
+	unsigned int sourceOffset = 0;
+	for (const Attribute& attribute : attributes)
+	{
+		ASSERT(attribute.Count >= 1 && attribute.Count <= 4);
+
+		glm::vec4 minValue(std::numeric_limits<float>::max()), maxValue(-std::numeric_limits<float>::max());
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			const float* values = vertices + (size_t)v * result.SourceStride + sourceOffset;
+			for (unsigned int c = 0; c < attribute.Count; c++)
+			{
+				minValue[c] = std::min(minValue[c], values[c]);
+				maxValue[c] = std::max(maxValue[c], values[c]);
+			}
+		}
+
+		// Normalized formats map [-1, 1] onto the attribute's bounds, or take it as is
+		QuantizedAttribute quantized;
+		quantized.Scale = glm::vec4(1.0f);
+		quantized.Offset = glm::vec4(0.0f);
+		bool fitsNormalized = true;
+		for (unsigned int c = 0; c < attribute.Count; c++)
+		{
+			if (attribute.AllowRemap)
+			{
+				quantized.Offset[c] = (minValue[c] + maxValue[c]) * 0.5f;
+				quantized.Scale[c] = (maxValue[c] - minValue[c]) * 0.5f;
+				if (quantized.Scale[c] <= 0.0f)
+					quantized.Scale[c] = 1.0f;
+			}
+			else if (vertexCount > 0 && (minValue[c] < -1.0f || maxValue[c] > 1.0f))
+			{
+				fitsNormalized = false;
+			}
+		}
+
+		const Format candidates[] = { Format::Packed1010102, Format::Snorm16, Format::Half, Format::Float };
+		Format chosen = Format::Float;
+		float chosenError = 0.0f;
+		unsigned int chosenSize = GetStoredSize(Format::Float, attribute.Count);
+
+		for (Format format : candidates)
+		{
+			unsigned int size = GetStoredSize(format, attribute.Count);
+			if (size >= chosenSize)
+				continue;
+			if ((format == Format::Packed1010102 || format == Format::Snorm16) && !fitsNormalized)
+				continue;
+			if (format == Format::Packed1010102 && attribute.Count < 3)
+				continue;
+
+			float error = 0.0f;
+			for (unsigned int v = 0; v < vertexCount && error <= attribute.MaxError; v++)
+			{
+				const float* values = vertices + (size_t)v * result.SourceStride + sourceOffset;
+				for (unsigned int c = 0; c < attribute.Count; c++)
+				{
+					if (format == Format::Half)
+					{
+						error = std::max(error, GetHalfError(values[c]));
+					}
+					else if (format == Format::Packed1010102 && c == 3)
+					{
+						// Two bits only hold -1, 0 and 1 exactly, and only 1 decodes the same under both GL rules
+						if (values[c] != 1.0f)
+							error = std::numeric_limits<float>::infinity();
+					}
+					else
+					{
+						unsigned int bits = format == Format::Snorm16 ? 16 : 10;
+						error = std::max(error, GetSnormError(values[c], quantized.Scale[c], quantized.Offset[c], bits));
+					}
+				}
+			}
+
+			if (error <= attribute.MaxError)
+			{
+				chosen = format;
+				chosenError = error;
+				chosenSize = size;
+			}
+		}
+
+		if (chosen == Format::Half || chosen == Format::Float)
+		{
+			quantized.Scale = glm::vec4(1.0f);
+			quantized.Offset = glm::vec4(0.0f);
+		}
+		// Padding components are stored as 1 and decode to 1, so is a packed w
+		unsigned int keep = chosen == Format::Packed1010102 ? std::min(attribute.Count, 3u) : attribute.Count;
+		for (unsigned int c = keep; c < 4; c++)
+		{
+			quantized.Scale[c] = 1.0f;
+			quantized.Offset[c] = 0.0f;
+		}
+
+		quantized.Count = GetStoredCount(chosen, attribute.Count);
+		quantized.Error = chosenError;
+		switch (chosen)
+		{
+		case Format::Packed1010102:
+			quantized.Type = GL_INT_2_10_10_10_REV;
+			quantized.Normalized = true;
+			result.Layout.Push<Packed1010102>(1);
+			break;
+		case Format::Snorm16:
+			quantized.Type = GL_SHORT;
+			quantized.Normalized = true;
+			result.Layout.Push<short>(quantized.Count);
+			break;
+		case Format::Half:
+			quantized.Type = GL_HALF_FLOAT;
+			quantized.Normalized = false;
+			result.Layout.Push<Half>(quantized.Count);
+			break;
+		default:
+			quantized.Type = GL_FLOAT;
+			quantized.Normalized = false;
+			result.Layout.Push<float>(quantized.Count);
+			break;
+		}
+
+		result.Attributes.push_back(quantized);
+		formats.push_back(chosen);
+		sourceOffset += attribute.Count;
+	}
+
+	unsigned int stride = result.Layout.GetStride();
+	result.Vertices.resize((size_t)vertexCount * stride);
+
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		const float* source = vertices + (size_t)v * result.SourceStride;
+		unsigned char* destination = result.Vertices.data() + (size_t)v * stride;
+
+		for (size_t a = 0; a < attributes.size(); a++)
+		{
+			const QuantizedAttribute& quantized = result.Attributes[a];
+
+			float values[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			for (unsigned int c = 0; c < std::min(attributes[a].Count, quantized.Count); c++)
+				values[c] = (source[c] - quantized.Offset[c]) / quantized.Scale[c];
+
+			switch (formats[a])
+			{
+			case Format::Packed1010102:
+			{
+				Packed1010102 packed = VertexFormats::PackSnorm1010102(values[0], values[1], values[2], values[3]);
+				std::memcpy(destination, &packed, sizeof(packed));
+				break;
+			}
+			case Format::Snorm16:
+				for (unsigned int c = 0; c < quantized.Count; c++)
+				{
+					int16_t stored = (int16_t)VertexFormats::FloatToSnorm(values[c], 16);
+					std::memcpy(destination + c * sizeof(int16_t), &stored, sizeof(int16_t));
+				}
+				break;
+			case Format::Half:
+				for (unsigned int c = 0; c < quantized.Count; c++)
+				{
+					Half stored = VertexFormats::FloatToHalf(values[c]);
+					std::memcpy(destination + c * sizeof(Half), &stored, sizeof(Half));
+				}
+				break;
+			default:
+				std::memcpy(destination, values, quantized.Count * sizeof(float));
+				break;
+			}
+
+			destination += result.Layout.GetElements()[a].GetSize();
+			source += attributes[a].Count;
+		}
+	}
+
+	return result;
+}
+
+glm::mat4 MeshQuantizer::Result::GetDecodeMatrix(unsigned int attribute) const
+{
+	const QuantizedAttribute& quantized = Attributes[attribute];
+	glm::mat4 decode = glm::translate(glm::mat4(1.0f), glm::vec3(quantized.Offset));
+	return glm::scale(decode, glm::vec3(quantized.Scale));
+}
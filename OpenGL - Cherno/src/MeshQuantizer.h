@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexBufferLayout.h"
+
+// Converts interleaved float vertices into the smallest attribute formats that
+// stay within a given error, see VertexFormats. Every attribute is tried as
+// packed 10_10_10_2, normalized short, half float and finally float, the first
+// that fits the bound wins. Errors are measured by encoding and decoding every
+// value, with both GL rules for normalized integers.
+//
+// Normalized formats only cover [-1, 1]. Attributes that are allowed to be
+// remapped are stored over their own bounds instead and come with a Scale and
+// Offset to decode them (decoded = stored * Scale + Offset). For positions that
+// folds into the model matrix. Two byte formats are padded to an even component
+// count with a stored 1, the value GL fills in for a missing w, which keeps every
+// attribute 4 byte aligned.
+class MeshQuantizer
+{
+public:
+	struct Attribute
+	{
+		unsigned int Count;
+		// Largest absolute difference allowed per component
+		float MaxError;
+		bool AllowRemap;
+	};
+
+	struct QuantizedAttribute
+	{
+		unsigned int Type;
+		unsigned int Count;
+		bool Normalized;
+		glm::vec4 Scale;
+		glm::vec4 Offset;
+		float Error;
+	};
+
+	struct Result
+	{
+		std::vector<unsigned char> Vertices;
+		std::vector<QuantizedAttribute> Attributes;
+		VertexBufferLayout Layout;
+		unsigned int VertexCount = 0;
+		unsigned int SourceStride = 0;
+
+		inline unsigned int GetStride() const { return Layout.GetStride(); }
+		// Decode matrix for a position attribute, multiply it onto the model matrix
+		glm::mat4 GetDecodeMatrix(unsigned int attribute) const;
+	};
+
+	static Result Quantize(const float* vertices, unsigned int vertexCount, const std::vector<Attribute>& attributes);
+};
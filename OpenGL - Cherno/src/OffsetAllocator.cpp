@@ -0,0 +1,261 @@
+#include "OffsetAllocator.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "Renderer.h"
+
+static uint32_t FindLowestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+static uint32_t FindHighestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else
+	return 31 - (uint32_t)__builtin_clz(mask);
+#endif
+}
+
+// Sizes below 8 get a bin each, above that 8 bins per power of two
+uint32_t OffsetAllocator::BinRoundDown(uint32_t size)
+{
+	if (size < s_BinsPerLevel)
+		return size;
+
+	uint32_t level = FindHighestBit(size);
+	uint32_t sub = (size >> (level - 3)) & (s_BinsPerLevel - 1);
+	return (level - 2) * s_BinsPerLevel + sub;
+}
+
+uint32_t OffsetAllocator::BinRoundUp(uint32_t size)
+{
+	uint32_t bin = BinRoundDown(size);
+	return BinSize(bin) < size ? bin + 1 : bin;
+}
+
+uint32_t OffsetAllocator::BinSize(uint32_t bin)
+{
+	if (bin < s_BinsPerLevel)
+		return bin;
+
+	uint32_t level = bin / s_BinsPerLevel + 2;
+	uint32_t sub = bin % s_BinsPerLevel;
+	return (s_BinsPerLevel + sub) << (level - 3);
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t size)
+	: m_Size(size)
+{
+	Reset();
+}
+
+void OffsetAllocator::Reset()
+{
+	m_Nodes.clear();
+	m_FreeNodes.clear();
+	std::fill(m_BinHeads, m_BinHeads + s_BinCount, (uint32_t)NoSpace);
+	std::fill(m_UsedBins, m_UsedBins + s_LevelCount, (uint8_t)0);
+	m_UsedLevels = 0;
+	m_FreeSpace = 0;
+	m_Allocations = 0;
+
+	if (m_Size > 0)
+		InsertFree(NewNode(0, m_Size));
+}
+
+uint32_t OffsetAllocator::NewNode(uint32_t offset, uint32_t size)
+{
+	uint32_t index;
+	if (!m_FreeNodes.empty())
+	{
+		index = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+	}
+	else
+	{
+		index = (uint32_t)m_Nodes.size();
+		m_Nodes.emplace_back();
+	}
+
+	Node& node = m_Nodes[index];
+	node.Offset = offset;
+	node.Size = size;
+	node.BinPrev = node.BinNext = NoSpace;
+	node.NeighborPrev = node.NeighborNext = NoSpace;
+	node.Used = false;
+	return index;
+}
+
+void OffsetAllocator::InsertFree(uint32_t index)
+{
+	Node& node = m_Nodes[index];
+	uint32_t bin = BinRoundDown(node.Size);
+
+	node.Used = false;
+	node.BinPrev = NoSpace;
+	node.BinNext = m_BinHeads[bin];
+	if (node.BinNext != NoSpace)
+		m_Nodes[node.BinNext].BinPrev = index;
+	m_BinHeads[bin] = index;
+
+	m_UsedBins[bin / s_BinsPerLevel] |= 1 << (bin % s_BinsPerLevel);
+	m_UsedLevels |= 1u << (bin / s_BinsPerLevel);
+	m_FreeSpace += node.Size;
+}
+
+void OffsetAllocator::RemoveFree(uint32_t index)
+{
+	Node& node = m_Nodes[index];
+
+	if (node.BinPrev != NoSpace)
+		m_Nodes[node.BinPrev].BinNext = node.BinNext;
+	if (node.BinNext != NoSpace)
+		m_Nodes[node.BinNext].BinPrev = node.BinPrev;
+
+	uint32_t bin = BinRoundDown(node.Size);
+	if (m_BinHeads[bin] == index)
+	{
+		m_BinHeads[bin] = node.BinNext;
+		if (node.BinNext == NoSpace)
+		{
+			uint32_t level = bin / s_BinsPerLevel;
+			m_UsedBins[level] &= ~(1 << (bin % s_BinsPerLevel));
+			if (m_UsedBins[level] == 0)
+				m_UsedLevels &= ~(1u << level);
+		}
+	}
+
+	node.BinPrev = node.BinNext = NoSpace;
+	m_FreeSpace -= node.Size;
+}
+
+uint32_t OffsetAllocator::FindBin(uint32_t minBin) const
+{
+	uint32_t level = minBin / s_BinsPerLevel;
+	if (level >= s_LevelCount)
+		return NoSpace;
+
+	uint32_t bins = m_UsedBins[level] & (0xffu << (minBin % s_BinsPerLevel));
+	if (bins)
+		return level * s_BinsPerLevel + FindLowestBit(bins);
+
+	uint32_t levels = level + 1 < 32 ? m_UsedLevels & (~0u << (level + 1)) : 0;
+	if (!levels)
+		return NoSpace;
+
+	level = FindLowestBit(levels);
+	return level * s_BinsPerLevel + FindLowestBit(m_UsedBins[level]);
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size)
+{
+	Allocation allocation;
+	if (size == 0)
+		return allocation;
+
+	// Rounding up means any range in the bin found is big enough, no list walking
+	uint32_t bin = FindBin(BinRoundUp(size));
+	if (bin == NoSpace)
+		return allocation;
+
+	uint32_t index = m_BinHeads[bin];
+	RemoveFree(index);
+
+	uint32_t remainder = m_Nodes[index].Size - size;
+	if (remainder > 0)
+	{
+		uint32_t rest = NewNode(m_Nodes[index].Offset + size, remainder);
+		Node& node = m_Nodes[index];
+		node.Size = size;
+
+		m_Nodes[rest].NeighborPrev = index;
+		m_Nodes[rest].NeighborNext = node.NeighborNext;
+		if (node.NeighborNext != NoSpace)
+			m_Nodes[node.NeighborNext].NeighborPrev = rest;
+		node.NeighborNext = rest;
+
+		InsertFree(rest);
+	}
+
+	m_Nodes[index].Used = true;
+	m_Allocations++;
+
+	allocation.Offset = m_Nodes[index].Offset;
+	allocation.Node = index;
+	return allocation;
+}
+
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+	if (!allocation.IsValid())
+		return;
+
+	uint32_t index = allocation.Node;
+	ASSERT(m_Nodes[index].Used);
+	m_Allocations--;
+
+	// Swallow free neighbors so free space never stays split into adjacent ranges
+	uint32_t prev = m_Nodes[index].NeighborPrev;
+	if (prev != NoSpace && !m_Nodes[prev].Used)
+	{
+		RemoveFree(prev);
+		Node& node = m_Nodes[index];
+		node.Offset = m_Nodes[prev].Offset;
+		node.Size += m_Nodes[prev].Size;
+		node.NeighborPrev = m_Nodes[prev].NeighborPrev;
+		if (node.NeighborPrev != NoSpace)
+			m_Nodes[node.NeighborPrev].NeighborNext = index;
+		m_FreeNodes.push_back(prev);
+	}
+
+	uint32_t next = m_Nodes[index].NeighborNext;
+	if (next != NoSpace && !m_Nodes[next].Used)
+	{
+		RemoveFree(next);
+		Node& node = m_Nodes[index];
+		node.Size += m_Nodes[next].Size;
+		node.NeighborNext = m_Nodes[next].NeighborNext;
+		if (node.NeighborNext != NoSpace)
+			m_Nodes[node.NeighborNext].NeighborPrev = index;
+		m_FreeNodes.push_back(next);
+	}
+
+	InsertFree(index);
+}
+
+uint32_t OffsetAllocator::GetAllocationSize(const Allocation& allocation) const
+{
+	return allocation.IsValid() ? m_Nodes[allocation.Node].Size : 0;
+}
+
+OffsetAllocator::Stats OffsetAllocator::GetStats() const
+{
+	Stats stats;
+	stats.Size = m_Size;
+	stats.FreeSpace = m_FreeSpace;
+	stats.Allocations = m_Allocations;
+
+	for (uint32_t bin = 0; bin < s_BinCount; bin++)
+	{
+		for (uint32_t index = m_BinHeads[bin]; index != NoSpace; index = m_Nodes[index].BinNext)
+		{
+			stats.LargestFree = std::max(stats.LargestFree, m_Nodes[index].Size);
+			stats.FreeRanges++;
+		}
+	}
+	return stats;
+}
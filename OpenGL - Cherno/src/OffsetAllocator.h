@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Hands out ranges of an abstract [0, size) space, e.g. elements of a GL buffer,
+// in O(1). Free ranges live in size class bins, two levels like TLSF: the top bit
+// of a size picks the first level and the next 3 bits one of 8 bins inside it,
+// with a bitmask per level to find the first non-empty bin that is big enough.
+// Freed ranges are merged with free neighbors right away.
+class OffsetAllocator
+{
+public:
+	static const uint32_t NoSpace = ~0u;
+
+	struct Allocation
+	{
+		uint32_t Offset = NoSpace;
+		// Identifies the range to Free
+		uint32_t Node = NoSpace;
+
+		inline bool IsValid() const { return Node != NoSpace; }
+	};
+
+	struct Stats
+	{
+		uint32_t Size = 0;
+		uint32_t FreeSpace = 0;
+		uint32_t LargestFree = 0;
+		uint32_t FreeRanges = 0;
+		uint32_t Allocations = 0;
+	};
+
+private:
+	static const uint32_t s_BinsPerLevel = 8;
+	static const uint32_t s_LevelCount = 30;
+	static const uint32_t s_BinCount = s_LevelCount * s_BinsPerLevel;
+
+	struct Node
+	{
+		uint32_t Offset;
+		uint32_t Size;
+		uint32_t BinPrev, BinNext;
+		uint32_t NeighborPrev, NeighborNext;
+		bool Used;
+	};
+
+	uint32_t m_Size;
+	std::vector<Node> m_Nodes;
+	std::vector<uint32_t> m_FreeNodes;
+	uint32_t m_BinHeads[s_BinCount];
+	uint32_t m_UsedLevels;
+	uint8_t m_UsedBins[s_LevelCount];
+	uint32_t m_FreeSpace;
+	uint32_t m_Allocations;
+
+	uint32_t NewNode(uint32_t offset, uint32_t size);
+	void InsertFree(uint32_t node);
+	void RemoveFree(uint32_t node);
+	uint32_t FindBin(uint32_t minBin) const;
+
+	static uint32_t BinRoundDown(uint32_t size);
+	static uint32_t BinRoundUp(uint32_t size);
+	static uint32_t BinSize(uint32_t bin);
+
+public:
+	OffsetAllocator(uint32_t size);
+
+	Allocation Allocate(uint32_t size);
+	void Free(const Allocation& allocation);
+	void Reset();
+
+	uint32_t GetAllocationSize(const Allocation& allocation) const;
+	Stats GetStats() const;
+};
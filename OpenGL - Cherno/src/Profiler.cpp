@@ -0,0 +1,258 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "provided/imgui/imgui.h"
+
+struct Profiler::ThreadBuffer
+{
+	static const uint64_t Capacity = 1 << 16;
+
+	std::string Name;
+	unsigned int Index;
+	unsigned int Depth = 0;
+	std::vector<Event> Events;
+	// Only the owning thread writes, everyone else reads
+	std::atomic<uint64_t> WriteIndex;
+
+	ThreadBuffer(unsigned int index)
+		: Name("Thread " + std::to_string(index)), Index(index), Events(Capacity), WriteIndex(0)
+	{
+	}
+};
+
+// Buffers stay alive after their thread exits so readers never see them go away
+static std::mutex s_BuffersMutex;
+
+std::atomic<bool> Profiler::s_Enabled(true);
+std::atomic<int64_t> Profiler::s_FrameStart(0);
+std::atomic<int64_t> Profiler::s_LastFrameStart(0);
+
+static const std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+
+int64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+}
+
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>>& Profiler::GetBuffers()
+{
+	static std::vector<std::unique_ptr<Profiler::ThreadBuffer>> buffers;
+	return buffers;
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+{
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (!buffer)
+	{
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		auto& buffers = GetBuffers();
+		buffers.push_back(std::make_unique<ThreadBuffer>((unsigned int)buffers.size()));
+		buffer = buffers.back().get();
+	}
+	return *buffer;
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(s_BuffersMutex);
+	buffer.Name = name;
+}
+
+unsigned int Profiler::EnterScope()
+{
+	return GetThreadBuffer().Depth++;
+}
+
+void Profiler::LeaveScope(const char* name, int64_t start, unsigned int depth)
+{
+	int64_t end = Now();
+	ThreadBuffer& buffer = GetThreadBuffer();
+	buffer.Depth = depth;
+
+	uint64_t index = buffer.WriteIndex.load(std::memory_order_relaxed);
+	buffer.Events[index % ThreadBuffer::Capacity] = { name, start, end, depth };
+	buffer.WriteIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::BeginFrame()
+{
+	s_LastFrameStart.store(s_FrameStart.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	s_FrameStart.store(Now(), std::memory_order_relaxed);
+}
+
+void Profiler::GetEvents(int64_t start, int64_t end, std::vector<ThreadEvents>& threads)
+{
+	threads.clear();
+
+	std::lock_guard<std::mutex> lock(s_BuffersMutex);
+	for (const auto& buffer : GetBuffers())
+	{
+		ThreadEvents thread;
+		thread.ThreadName = buffer->Name;
+		thread.ThreadIndex = buffer->Index;
+
+		// End times only grow within a thread, so walking back from the newest
+		// event can stop at the first one that ended before the range
+		uint64_t last = buffer->WriteIndex.load(std::memory_order_acquire);
+		uint64_t first = last > ThreadBuffer::Capacity ? last - ThreadBuffer::Capacity : 0;
+
+		std::vector<Event> events;
+		for (uint64_t i = last; i > first; i--)
+		{
+			Event event = buffer->Events[(i - 1) % ThreadBuffer::Capacity];
+			if (event.End < start)
+				break;
+			events.push_back(event);
+		}
+
+		// The writer may have lapped the oldest entries while they were copied, and
+		// may be halfway through overwriting the slot after the last one it wrote
+		uint64_t written = buffer->WriteIndex.load(std::memory_order_acquire);
+		uint64_t valid = written + 1 > ThreadBuffer::Capacity ? written + 1 - ThreadBuffer::Capacity : 0;
+		size_t count = last > valid ? std::min(events.size(), (size_t)(last - valid)) : 0;
+
+		// Newest first in events, oldest first in the result
+		for (size_t i = count; i > 0; i--)
+		{
+			const Event& event = events[i - 1];
+			if (event.Start < end)
+				thread.Events.push_back(event);
+		}
+
+		if (!thread.Events.empty())
+			threads.push_back(std::move(thread));
+	}
+}
+
+static void WriteJsonString(std::ofstream& stream, const std::string& text)
+{
+	stream << '"';
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			stream << '\\';
+		stream << c;
+	}
+	stream << '"';
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+	std::ofstream stream(path);
+	if (!stream)
+		return false;
+
+	std::vector<ThreadEvents> threads;
+	GetEvents(INT64_MIN, INT64_MAX, threads);
+
+	// Complete ("X") events with times in microseconds, plus one thread name record per thread
+	stream << std::fixed << std::setprecision(3);
+	stream << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (const ThreadEvents& thread : threads)
+	{
+		stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.ThreadIndex << ",\"args\":{\"name\":";
+		WriteJsonString(stream, thread.ThreadName);
+		stream << "}}";
+		first = false;
+
+		for (const Event& event : thread.Events)
+		{
+			stream << ",\n{\"name\":";
+			WriteJsonString(stream, event.Name);
+			stream << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.ThreadIndex
+				<< ",\"ts\":" << event.Start / 1000.0 << ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+		}
+	}
+	stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return (bool)stream;
+}
+
+void Profiler::OnImGuiRender()
+{
+	ImGui::Begin("CPU Profiler");
+
+	bool enabled = IsEnabled();
+	if (ImGui::Checkbox("Enabled", &enabled))
+		SetEnabled(enabled);
+	ImGui::SameLine();
+	if (ImGui::Button("Save trace"))
+	{
+		const char* path = "trace.json";
+		if (WriteChromeTrace(path))
+			std::cout << "Wrote " << path << ", open it in chrome://tracing or ui.perfetto.dev" << std::endl;
+	}
+
+	int64_t frameStart = s_LastFrameStart.load(std::memory_order_relaxed);
+	int64_t frameEnd = s_FrameStart.load(std::memory_order_relaxed);
+	if (frameEnd <= frameStart)
+	{
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("Last frame: %.3f ms", (frameEnd - frameStart) * 1e-6);
+
+	std::vector<ThreadEvents> threads;
+	GetEvents(frameStart, frameEnd, threads);
+
+	// One lane per thread, one row per nesting level, time along x
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+	float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+	double scale = width / (double)(frameEnd - frameStart);
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	ImVec2 mouse = ImGui::GetIO().MousePos;
+
+	for (const ThreadEvents& thread : threads)
+	{
+		ImGui::TextUnformatted(thread.ThreadName.c_str());
+
+		unsigned int rows = 1;
+		for (const Event& event : thread.Events)
+			rows = std::max(rows, event.Depth + 1);
+
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		for (const Event& event : thread.Events)
+		{
+			float x0 = origin.x + (float)((std::max(event.Start, frameStart) - frameStart) * scale);
+			float x1 = origin.x + (float)((std::min(event.End, frameEnd) - frameStart) * scale);
+			x1 = std::max(x1, x0 + 1.0f);
+			float y0 = origin.y + event.Depth * rowHeight;
+			float y1 = y0 + rowHeight - 1.0f;
+
+			// Same name, same color
+			uint32_t hash = 2166136261u;
+			for (const char* c = event.Name; *c; c++)
+				hash = (hash ^ (unsigned char)*c) * 16777619u;
+			ImU32 color = IM_COL32(80 + (hash & 0x7f), 80 + ((hash >> 8) & 0x7f), 80 + ((hash >> 16) & 0x7f), 255);
+			drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), color);
+
+			if (x1 - x0 > 20.0f)
+			{
+				drawList->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+				drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), event.Name);
+				drawList->PopClipRect();
+			}
+
+			if (mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+				ImGui::SetTooltip("%s\n%.3f ms", event.Name, (event.End - event.Start) * 1e-6);
+		}
+		ImGui::Dummy(ImVec2(width, rows * rowHeight));
+	}
+
+	ImGui::End();
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	s_Enabled.store(enabled, std::memory_order_relaxed);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Scoped CPU timing. PROFILE_SCOPE records one complete event (name, start, end,
+// nesting depth) into a ring buffer owned by the calling thread, so recording
+// never takes a lock. Readers copy the rings without stopping the writers and
+// discard whatever was overwritten meanwhile. The rings can be dumped as a
+// Chrome trace (chrome://tracing or ui.perfetto.dev) or shown as a flame view.
+//
+// Names must outlive the profiler, string literals are fine.
+class Profiler
+{
+public:
+	struct Event
+	{
+		const char* Name;
+		int64_t Start;
+		int64_t End;
+		unsigned int Depth;
+	};
+
+	struct ThreadEvents
+	{
+		std::string ThreadName;
+		unsigned int ThreadIndex;
+		std::vector<Event> Events;
+	};
+
+private:
+	struct ThreadBuffer;
+
+	static std::atomic<bool> s_Enabled;
+	static std::atomic<int64_t> s_FrameStart;
+	static std::atomic<int64_t> s_LastFrameStart;
+
+	static std::vector<std::unique_ptr<ThreadBuffer>>& GetBuffers();
+	static ThreadBuffer& GetThreadBuffer();
+
+public:
+	// Nanoseconds since the profiler started
+	static int64_t Now();
+
+	static void SetThreadName(const std::string& name);
+	static unsigned int EnterScope();
+	static void LeaveScope(const char* name, int64_t start, unsigned int depth);
+
+	// Marks the start of a main loop iteration, the flame view shows the last full one
+	static void BeginFrame();
+
+	// Events of every thread overlapping [start, end)
+	static void GetEvents(int64_t start, int64_t end, std::vector<ThreadEvents>& threads);
+	static bool WriteChromeTrace(const std::string& path);
+
+	static void OnImGuiRender();
+
+	static void SetEnabled(bool enabled);
+	static inline bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+};
+
+class ProfileScope
+{
+private:
+	const char* m_Name;
+	int64_t m_Start;
+	unsigned int m_Depth;
+	bool m_Active;
+
+public:
+	ProfileScope(const char* name)
+		: m_Name(name), m_Start(0), m_Depth(0), m_Active(Profiler::IsEnabled())
+	{
+		if (m_Active)
+		{
+			m_Depth = Profiler::EnterScope();
+			m_Start = Profiler::Now();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (m_Active)
+			Profiler::LeaveScope(m_Name, m_Start, m_Depth);
+	}
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
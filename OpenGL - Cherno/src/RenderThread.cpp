@@ -0,0 +1,162 @@
+#include "RenderThread.h"
+
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include "GLFW/glfw3.h"
+
+RenderThread::RenderThread(GLFWwindow* window, bool threaded)
+	: m_Window(window), m_Threaded(threaded), m_RecordIndex(0), m_FramePending(false), m_Running(true),
+	  m_NextFence(0), m_CompletedFence(0)
+{
+	if (m_Threaded)
+	{
+		// A context can only be current on one thread at a time
+		glfwMakeContextCurrent(nullptr);
+		m_Thread = std::thread(&RenderThread::Run, this);
+	}
+}
+
+RenderThread::~RenderThread()
+{
+	if (!m_Threaded)
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [this]() { return !m_FramePending && !m_PendingCall; });
+		m_Running = false;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	// Hand the context back so the caller can clean up
+	glfwMakeContextCurrent(m_Window);
+}
+
+void RenderThread::Run()
+{
+	Profiler::SetThreadName("Render");
+	glfwMakeContextCurrent(m_Window);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_Condition.wait(lock, [this]() { return m_FramePending || m_PendingCall || !m_Running; });
+
+		if (m_PendingCall)
+		{
+			// Run unlocked so the main thread is not stuck on the lock meanwhile.
+			// It stays set until done, so the caller and other calls keep waiting.
+			lock.unlock();
+			m_PendingCall();
+			lock.lock();
+			m_PendingCall = nullptr;
+			m_Condition.notify_all();
+			continue;
+		}
+
+		if (!m_FramePending)
+			break;
+
+		// The main thread has already moved on to the other list
+		CommandList& commands = m_CommandLists[m_RecordIndex ^ 1];
+		lock.unlock();
+		ExecuteFrame(commands);
+		lock.lock();
+
+		m_FramePending = false;
+		m_Condition.notify_all();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::ExecuteFrame(CommandList& commands)
+{
+	PROFILE_SCOPE("RenderThread::ExecuteFrame");
+	commands.Execute();
+	commands.Clear();
+
+	{
+		PROFILE_SCOPE("glfwSwapBuffers");
+		glfwSwapBuffers(m_Window);
+	}
+
+	if (m_PresentCallback)
+		m_PresentCallback();
+}
+
+void RenderThread::SubmitFrame()
+{
+	if (!m_Threaded)
+	{
+		ExecuteFrame(m_CommandLists[m_RecordIndex]);
+		return;
+	}
+
+	// Only the render thread could clear the pending frame it would wait for
+	ASSERT(std::this_thread::get_id() != m_Thread.get_id());
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [this]() { return !m_FramePending; });
+		m_RecordIndex ^= 1;
+		m_FramePending = true;
+	}
+	m_Condition.notify_all();
+}
+
+void RenderThread::Call(const std::function<void()>& function)
+{
+	if (!m_Threaded)
+	{
+		function();
+		return;
+	}
+
+	ASSERT(std::this_thread::get_id() != m_Thread.get_id());
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return !m_FramePending && !m_PendingCall; });
+	m_PendingCall = function;
+	m_Condition.notify_all();
+	m_Condition.wait(lock, [this]() { return !m_PendingCall; });
+}
+
+uint64_t RenderThread::InsertFence()
+{
+	uint64_t fence = ++m_NextFence;
+	Record([this, fence]() {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_CompletedFence = fence;
+		}
+		m_Condition.notify_all();
+	});
+	return fence;
+}
+
+void RenderThread::WaitForFence(uint64_t fence)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	// Without a thread the fence can only complete inside SubmitFrame, with one
+	// only the render thread completes it, so it must not wait itself
+	ASSERT(m_Threaded || m_CompletedFence >= fence);
+	ASSERT(std::this_thread::get_id() != m_Thread.get_id());
+	m_Condition.wait(lock, [this, fence]() { return m_CompletedFence >= fence; });
+}
+
+void RenderThread::SetPresentCallback(const std::function<void()>& callback)
+{
+	WaitIdle();
+	m_PresentCallback = callback;
+}
+
+void RenderThread::WaitIdle()
+{
+	if (!m_Threaded)
+		return;
+
+	ASSERT(std::this_thread::get_id() != m_Thread.get_id());
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return !m_FramePending && !m_PendingCall; });
+}
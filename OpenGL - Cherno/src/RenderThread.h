@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "CommandList.h"
+
+struct GLFWwindow;
+
+// Owns the GL context of a window on a dedicated thread. The main thread records
+// a frame into one command list while the render thread executes the previous
+// one and swaps buffers, so the main thread never blocks on the driver or on
+// vsync unless it gets a full frame ahead.
+//
+// With threaded = false the lists run on the calling thread inside SubmitFrame,
+// which keeps the single threaded behaviour behind the same interface.
+class RenderThread
+{
+private:
+	GLFWwindow* m_Window;
+	bool m_Threaded;
+	std::thread m_Thread;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+
+	CommandList m_CommandLists[2];
+	unsigned int m_RecordIndex;
+	bool m_FramePending;
+	bool m_Running;
+
+	std::function<void()> m_PendingCall;
+	std::function<void()> m_PresentCallback;
+
+	uint64_t m_NextFence;
+	uint64_t m_CompletedFence;
+
+	void Run();
+	void ExecuteFrame(CommandList& commands);
+
+public:
+	RenderThread(GLFWwindow* window, bool threaded);
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	// Adds to the frame being recorded, runs on the render thread after SubmitFrame
+	template<typename F>
+	void Record(F&& function)
+	{
+		m_CommandLists[m_RecordIndex].Record(std::forward<F>(function));
+	}
+
+	// Hands the recorded frame to the render thread, waiting for the previous one first
+	void SubmitFrame();
+
+	// Runs the function on the render thread and waits for it, for creating and
+	// destroying GL resources outside of a frame
+	void Call(const std::function<void()>& function);
+
+	// Fences mark a point in the recorded frame, WaitForFence returns once the
+	// render thread got past it. SubmitFrame, Call, WaitForFence and WaitIdle
+	// all wait on the render thread, so recorded commands and calls must not
+	// use them.
+	uint64_t InsertFence();
+	void WaitForFence(uint64_t fence);
+
+	void WaitIdle();
+
+	// Runs on the render thread right after every swap, set before the first frame
+	void SetPresentCallback(const std::function<void()>& callback);
+
+	inline bool IsThreaded() const { return m_Threaded; }
+};
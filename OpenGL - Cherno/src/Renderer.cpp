@@ -1,30 +1,329 @@
 #include "Renderer.h"
 
 #include <iostream>
+#include <algorithm>
 
-void GLClearError() {
-    while (glGetError() != GL_NO_ERROR);
+#include "Texture.h"
+#include "IndirectBuffer.h"
+#include "Profiler.h"
+#include "Culling.h"
+
+bool Renderer::s_ForceIndirectFallback = false;
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+{
+	PROFILE_SCOPE("Renderer::Draw");
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, ib.GetCount(), ib.GetType(), ib.GetIndexOffset(), ib.GetBaseVertex()));
 }
 
-bool GLLogCall(const char* function, const char* file, int line) {
-    while (GLenum error = glGetError()) {
-        std::cout << "[OpenGL Error] (" << error << ")" << function <<
-            " " << file << ":" << line << std::endl;
-        return false;
-    }
-    return true;
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+	PROFILE_SCOPE("Renderer::DrawInstanced");
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, ib.GetCount(), ib.GetType(), ib.GetIndexOffset(), instanceCount,
+		ib.GetBaseVertex()));
 }
 
-void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+bool Renderer::SupportsDrawIndirect()
+{
+	return !s_ForceIndirectFallback && (GLEW_VERSION_4_0 || GLEW_ARB_draw_indirect);
+}
+
+bool Renderer::SupportsMultiDrawIndirect()
+{
+	return !s_ForceIndirectFallback && (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+}
+
+void Renderer::SetForceIndirectFallback(bool force)
+{
+	s_ForceIndirectFallback = force;
+}
+
+void Renderer::DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect, unsigned int index) const
 {
+	PROFILE_SCOPE("Renderer::DrawIndirect");
+	ASSERT(index < indirect.GetCount());
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	if (SupportsDrawIndirect())
+	{
+		indirect.Bind();
+		GLCall(glDrawElementsIndirect(GL_TRIANGLES, ib.GetType(), (const void*)(index * sizeof(DrawElementsIndirectCommand))));
+	}
+	else
+	{
+		DrawIndirectFallback(va, ib, indirect, index, 1);
+	}
+}
+
+void Renderer::MultiDrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect) const
+{
+	MultiDrawIndirect(va, ib, shader, indirect, 0, indirect.GetCount());
+}
+
+void Renderer::MultiDrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect,
+	unsigned int first, unsigned int count) const
+{
+	PROFILE_SCOPE("Renderer::MultiDrawIndirect");
+	ASSERT(first + count <= indirect.GetCount());
+
 	shader.Bind();
 	va.Bind();
 	ib.Bind();
 
-	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+	if (SupportsMultiDrawIndirect())
+	{
+		indirect.Bind();
+		GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, ib.GetType(), (const void*)(first * sizeof(DrawElementsIndirectCommand)),
+			count, sizeof(DrawElementsIndirectCommand)));
+	}
+	else
+	{
+		DrawIndirectFallback(va, ib, indirect, first, count);
+	}
+}
+
+void Renderer::DrawIndirectFallback(const VertexArray& va, const IndexBuffer& ib, const IndirectBuffer& indirect,
+	unsigned int first, unsigned int count) const
+{
+	// Without ARB_base_instance the per-instance attributes always start at instance 0,
+	// so they are moved to the base instance of each command instead
+	bool baseInstance = GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+	unsigned int currentBaseInstance = 0;
+
+	unsigned int type = ib.GetType();
+	const std::vector<DrawElementsIndirectCommand>& commands = indirect.GetCommands();
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		const DrawElementsIndirectCommand& command = commands[i];
+		void* indices = (void*)((uintptr_t)command.FirstIndex * ib.GetIndexSize());
+
+		if (command.InstanceCount == 0)
+			continue;
+
+		if (baseInstance)
+		{
+			GLCall(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.Count, type, indices,
+				command.InstanceCount, command.BaseVertex, command.BaseInstance));
+		}
+		else
+		{
+			if (command.BaseInstance != currentBaseInstance)
+			{
+				va.SetBaseInstance(command.BaseInstance);
+				currentBaseInstance = command.BaseInstance;
+			}
+
+			if (command.InstanceCount == 1)
+			{
+				GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, command.Count, type, indices, command.BaseVertex));
+			}
+			else
+			{
+				GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, type, indices,
+					command.InstanceCount, command.BaseVertex));
+			}
+		}
+	}
+
+	if (currentBaseInstance != 0)
+		va.SetBaseInstance(0);
 }
 
 void Renderer::Clear() const
 {
     GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
+
+uint64_t Renderer::MakeSortKey(const VertexArray& va, const Shader& shader, const Texture* texture,
+	unsigned int layer, bool translucent, float depth)
+{
+	const uint64_t idMask = (1 << 12) - 1;
+	const uint64_t depthMask = (1 << 23) - 1;
+
+	uint64_t shaderID = shader.GetRendererID() & idMask;
+	uint64_t textureID = (texture ? texture->GetRendererID() : 0) & idMask;
+	uint64_t vaoID = va.GetRendererID() & idMask;
+	uint64_t depthBits = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * depthMask);
+
+	uint64_t key = (uint64_t)(layer & 0xf) << 60;
+	if (translucent)
+	{
+		key |= 1ull << 59;
+		key |= (depthMask - depthBits) << 36;
+		key |= shaderID << 24;
+		key |= textureID << 12;
+		key |= vaoID;
+	}
+	else
+	{
+		key |= shaderID << 47;
+		key |= textureID << 35;
+		key |= vaoID << 23;
+		key |= depthBits;
+	}
+	return key;
+}
+
+void RenderCommandBuffer::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture,
+	const glm::mat4& mvp, unsigned int layer, bool translucent, float depth)
+{
+	m_Commands.push_back({ Renderer::MakeSortKey(va, shader, texture, layer, translucent, depth), &va, &ib, &shader, texture, mvp });
+}
+
+bool RenderCommandBuffer::Submit(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, const VertexArray& va,
+	const IndexBuffer& ib, Shader& shader, const Texture* texture, const glm::mat4& mvp, unsigned int layer, bool translucent, float depth)
+{
+	if (!Culling::IsVisible(frustum, min, max))
+		return false;
+
+	Submit(va, ib, shader, texture, mvp, layer, translucent, depth);
+	return true;
+}
+
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture,
+	const glm::mat4& mvp, unsigned int layer, bool translucent, float depth)
+{
+	m_CommandQueue.Submit(va, ib, shader, texture, mvp, layer, translucent, depth);
+}
+
+bool Renderer::Submit(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, const VertexArray& va,
+	const IndexBuffer& ib, Shader& shader, const Texture* texture, const glm::mat4& mvp, unsigned int layer, bool translucent, float depth)
+{
+	return m_CommandQueue.Submit(frustum, min, max, va, ib, shader, texture, mvp, layer, translucent, depth);
+}
+
+void Renderer::Submit(const RenderCommandBuffer& buffer)
+{
+	m_SubmittedBuffers.push_back(&buffer);
+}
+
+void Renderer::SortCommands()
+{
+	PROFILE_SCOPE("Renderer::SortCommands");
+	m_SortEntries.clear();
+
+	const RenderCommand* queued = m_CommandQueue.GetCommands();
+	for (unsigned int i = 0; i < m_CommandQueue.GetCount(); i++)
+		m_SortEntries.push_back({ queued[i].SortKey, &queued[i] });
+
+	for (const RenderCommandBuffer* buffer : m_SubmittedBuffers)
+	{
+		const RenderCommand* commands = buffer->GetCommands();
+		for (unsigned int i = 0; i < buffer->GetCount(); i++)
+			m_SortEntries.push_back({ commands[i].SortKey, &commands[i] });
+	}
+
+	unsigned int count = (unsigned int)m_SortEntries.size();
+	if (count == 0)
+		return;
+	m_SortScratch.resize(count);
+
+	// LSD radix sort, one byte per pass. Stable, so equal keys keep submission order.
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		unsigned int histogram[256] = {};
+		for (const SortEntry& entry : m_SortEntries)
+			histogram[(entry.Key >> shift) & 0xff]++;
+
+		// Every key has the same byte here, this pass would not move anything
+		if (histogram[(m_SortEntries[0].Key >> shift) & 0xff] == count)
+			continue;
+
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			unsigned int bucket = histogram[i];
+			histogram[i] = offset;
+			offset += bucket;
+		}
+
+		for (const SortEntry& entry : m_SortEntries)
+			m_SortScratch[histogram[(entry.Key >> shift) & 0xff]++] = entry;
+
+		m_SortEntries.swap(m_SortScratch);
+	}
+}
+
+void Renderer::Flush()
+{
+	PROFILE_SCOPE("Renderer::Flush");
+	SortCommands();
+	if (m_SortEntries.empty())
+	{
+		m_SubmittedBuffers.clear();
+		return;
+	}
+
+	const Shader* boundShader = nullptr;
+	const VertexArray* boundVertexArray = nullptr;
+	// Vertex arrays of one shared format are the same GL object
+	unsigned int boundVertexArrayID = 0;
+	// Pooled index buffers in the same block share a buffer object, compare those
+	unsigned int boundIndexBuffer = 0;
+	const Texture* boundTexture = nullptr;
+
+	for (const SortEntry& entry : m_SortEntries)
+	{
+		const RenderCommand& command = *entry.Command;
+
+		if (command.Program != boundShader)
+		{
+			command.Program->Bind();
+			boundShader = command.Program;
+			m_Stats.ShaderBinds++;
+		}
+
+		if (command.VAO != boundVertexArray)
+		{
+			if (command.VAO->GetRendererID() != boundVertexArrayID)
+			{
+				boundVertexArrayID = command.VAO->GetRendererID();
+				// The element buffer binding is part of the vertex array state
+				boundIndexBuffer = 0;
+				m_Stats.VertexArrayBinds++;
+			}
+			// Within a shared format this only swaps the vertex buffers
+			command.VAO->Bind();
+			boundVertexArray = command.VAO;
+		}
+
+		if (command.IBO->GetRendererID() != boundIndexBuffer)
+		{
+			command.IBO->Bind();
+			boundIndexBuffer = command.IBO->GetRendererID();
+			m_Stats.IndexBufferBinds++;
+		}
+
+		if (command.Texture2D && command.Texture2D != boundTexture)
+		{
+			command.Texture2D->Bind();
+			boundTexture = command.Texture2D;
+			m_Stats.TextureBinds++;
+		}
+
+		command.Program->SetUniformMat4f("u_MVP", command.MVP);
+		GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, command.IBO->GetCount(), command.IBO->GetType(), command.IBO->GetIndexOffset(),
+			command.IBO->GetBaseVertex()));
+		m_Stats.DrawCalls++;
+	}
+
+	m_Stats.Submitted += (unsigned int)m_SortEntries.size();
+	m_CommandQueue.Clear();
+	m_SubmittedBuffers.clear();
+}
+
+void Renderer::ResetStats()
+{
+	m_Stats = RenderStats();
+}
@@ -2,28 +2,141 @@
 
 #include <GL/glew.h>
 
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "GLDebug.h"
+
+// Error handling, see GLDebug. GLCall remembers where it was called from, and
+// only checks glGetError itself when sampling is on.
+#define GL_CALL_SITE_CONCAT_IMPL(a, b) a##b
+#define GL_CALL_SITE_CONCAT(a, b) GL_CALL_SITE_CONCAT_IMPL(a, b)
 
-// Error handling
 #ifdef _DEBUG
 #define ASSERT(x) if(!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
+#define GLCall(x) static const GLCallSite GL_CALL_SITE_CONCAT(glCallSite, __LINE__) = { #x, __FILE__, __LINE__ };\
+        GLDebug::SetCallSite(&GL_CALL_SITE_CONCAT(glCallSite, __LINE__));\
         x;\
-        ASSERT(GLLogCall(#x, __FILE__, __LINE__));
+        GLDebug::SampleError();
 #else
+// Still names its arguments, so values only asserted on count as used
+#define ASSERT(x) ((void)sizeof(x))
 #define GLCall(x) x
 #endif
 
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+class Texture;
+class IndirectBuffer;
+struct Frustum;
+
+// Sort key layout, most significant bits first:
+//   opaque:      layer(4) | 0 | shader(12) | texture(12) | vertex array(12) | depth(23, front to back)
+//   translucent: layer(4) | 1 | depth(23, back to front) | shader(12) | texture(12) | vertex array(12)
+// Opaque draws are grouped by state, translucent ones keep their blending order.
+struct RenderCommand
+{
+	uint64_t SortKey;
+	const VertexArray* VAO;
+	const IndexBuffer* IBO;
+	Shader* Program;
+	const Texture* Texture2D;
+	glm::mat4 MVP;
+};
+
+struct RenderStats
+{
+	unsigned int Submitted = 0;
+	unsigned int DrawCalls = 0;
+	unsigned int ShaderBinds = 0;
+	unsigned int VertexArrayBinds = 0;
+	unsigned int IndexBufferBinds = 0;
+	unsigned int TextureBinds = 0;
+
+	// Compared to binding everything for every draw, like Draw does
+	inline unsigned int GetShaderBindsAvoided() const { return Submitted - ShaderBinds; }
+	inline unsigned int GetVertexArrayBindsAvoided() const { return Submitted - VertexArrayBinds; }
+	inline unsigned int GetIndexBufferBindsAvoided() const { return Submitted - IndexBufferBinds; }
+	inline unsigned int GetTextureBindsAvoided() const { return Submitted - TextureBinds; }
+};
+
+// Commands recorded away from the Renderer, typically one buffer per worker
+// thread, and handed to Renderer::Submit as a whole. The buffer keeps its
+// memory across Clear, so recording stops allocating after the first frames.
+class RenderCommandBuffer
+{
+private:
+	std::vector<RenderCommand> m_Commands;
+
+public:
+	void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture,
+		const glm::mat4& mvp, unsigned int layer = 0, bool translucent = false, float depth = 0.0f);
+	// Culled submit: records nothing when the box min..max is outside the frustum and
+	// returns whether it recorded. Counts in Culling::GetStats.
+	bool Submit(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, const VertexArray& va, const IndexBuffer& ib,
+		Shader& shader, const Texture* texture, const glm::mat4& mvp, unsigned int layer = 0, bool translucent = false, float depth = 0.0f);
+
+	inline void Clear() { m_Commands.clear(); }
+	inline void Reserve(size_t count) { m_Commands.reserve(count); }
+
+	inline const RenderCommand* GetCommands() const { return m_Commands.data(); }
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+};
 
 class Renderer 
 {
 private:
+	struct SortEntry
+	{
+		uint64_t Key;
+		const RenderCommand* Command;
+	};
+
+	RenderCommandBuffer m_CommandQueue;
+	std::vector<const RenderCommandBuffer*> m_SubmittedBuffers;
+	std::vector<SortEntry> m_SortEntries;
+	std::vector<SortEntry> m_SortScratch;
+	RenderStats m_Stats;
+
+	static bool s_ForceIndirectFallback;
+
+	void SortCommands();
+	void DrawIndirectFallback(const VertexArray& va, const IndexBuffer& ib, const IndirectBuffer& indirect, unsigned int first, unsigned int count) const;
 
 public:
     void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
 	void Clear() const;
+
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+
+	// Indirect draws read their parameters from an IndirectBuffer. Without driver support
+	// they fall back to one glDrawElements*BaseVertex call per command, which moves the
+	// per-instance attributes of va to BaseInstance when the driver lacks ARB_base_instance.
+	void DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect, unsigned int index) const;
+	void MultiDrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect) const;
+	void MultiDrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect,
+		unsigned int first, unsigned int count) const;
+
+	static bool SupportsDrawIndirect();
+	static bool SupportsMultiDrawIndirect();
+	// Take the fallback path even when the driver supports indirect drawing, for comparisons
+	static void SetForceIndirectFallback(bool force);
+
+	// Deferred path: commands are recorded by Submit, then sorted and replayed by Flush
+	void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture,
+		const glm::mat4& mvp, unsigned int layer = 0, bool translucent = false, float depth = 0.0f);
+	bool Submit(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, const VertexArray& va, const IndexBuffer& ib,
+		Shader& shader, const Texture* texture, const glm::mat4& mvp, unsigned int layer = 0, bool translucent = false, float depth = 0.0f);
+	// The buffer is merged into the sort by reference and must stay unchanged until Flush
+	void Submit(const RenderCommandBuffer& buffer);
+	void Flush();
+
+	static uint64_t MakeSortKey(const VertexArray& va, const Shader& shader, const Texture* texture,
+		unsigned int layer, bool translucent, float depth);
+
+	void ResetStats();
+	inline const RenderStats& GetStats() const { return m_Stats; }
 };
\ No newline at end of file
@@ -6,21 +6,26 @@
 #include <sstream>
 
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
 
 Shader::Shader(const std::string& filepath)
 	: m_Filepath(filepath), m_RendererID(0)
 {
+	PROFILE_SCOPE("Shader::Shader");
 	ShaderProgramSource source = ParseShader();
 	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
 }
 
 Shader::~Shader()
 {
+	GLStateCache::OnDeleteProgram(m_RendererID);
 	GLCall(glDeleteProgram(m_RendererID));
 }
 
 ShaderProgramSource Shader::ParseShader()
 {
+	PROFILE_SCOPE("Shader::ParseShader");
 	std::ifstream stream(m_Filepath);
 
 	enum class ShaderType {
@@ -52,6 +57,7 @@ ShaderProgramSource Shader::ParseShader()
 
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
 {
+	PROFILE_SCOPE("Shader::CreateShader");
 	GLCall(unsigned int program = glCreateProgram());
 	GLCall(unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader));
 	GLCall(unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader));
@@ -104,12 +110,12 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 
 void Shader::Bind() const
 {
-	GLCall(glUseProgram(m_RendererID));
+	GLStateCache::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-	GLCall(glUseProgram(0));
+	GLStateCache::UseProgram(0);
 }
 
 void Shader::SetUniform1i(const std::string& name, int value)
@@ -117,6 +123,11 @@ void Shader::SetUniform1i(const std::string& name, int value)
 	GLCall(glUniform1i(GetUniformLocation(name), value));
 }
 
+void Shader::SetUniform1iv(const std::string& name, int count, const int* values)
+{
+	GLCall(glUniform1iv(GetUniformLocation(name), count, values));
+}
+
 void Shader::SetUniform1f(const std::string& name, float value)
 {
 	GLCall(glUniform1f(GetUniformLocation(name), value));
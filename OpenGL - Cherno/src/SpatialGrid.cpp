@@ -0,0 +1,164 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Renderer.h"
+
+SpatialGrid::SpatialGrid(float cellSize)
+	: m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize), m_Count(0)
+{
+	ASSERT(cellSize > 0.0f);
+}
+
+SpatialGrid::~SpatialGrid()
+{
+}
+
+unsigned long long SpatialGrid::GetCellKey(int x, int y)
+{
+	return ((unsigned long long)(unsigned int)x << 32) | (unsigned int)y;
+}
+
+int SpatialGrid::GetCell(float coordinate) const
+{
+	return (int)std::floor(coordinate * m_InverseCellSize);
+}
+
+void SpatialGrid::Link(Handle handle)
+{
+	Entry& entry = m_Entries[handle];
+	entry.CellMinX = GetCell(entry.Min.x);
+	entry.CellMinY = GetCell(entry.Min.y);
+	entry.CellMaxX = GetCell(entry.Max.x);
+	entry.CellMaxY = GetCell(entry.Max.y);
+
+	for (int y = entry.CellMinY; y <= entry.CellMaxY; y++)
+	{
+		for (int x = entry.CellMinX; x <= entry.CellMaxX; x++)
+			m_Cells[GetCellKey(x, y)].push_back(handle);
+	}
+}
+
+void SpatialGrid::Unlink(Handle handle)
+{
+	const Entry& entry = m_Entries[handle];
+	for (int y = entry.CellMinY; y <= entry.CellMaxY; y++)
+	{
+		for (int x = entry.CellMinX; x <= entry.CellMaxX; x++)
+		{
+			// Cells stay allocated when they empty out, objects tend to come back
+			std::vector<Handle>& cell = m_Cells[GetCellKey(x, y)];
+			auto it = std::find(cell.begin(), cell.end(), handle);
+			ASSERT(it != cell.end());
+			*it = cell.back();
+			cell.pop_back();
+		}
+	}
+}
+
+SpatialGrid::Handle SpatialGrid::Insert(const glm::vec2& min, const glm::vec2& max, unsigned int value)
+{
+	Handle handle;
+	if (!m_FreeHandles.empty())
+	{
+		handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+	}
+	else
+	{
+		handle = (Handle)m_Entries.size();
+		m_Entries.emplace_back();
+	}
+
+	Entry& entry = m_Entries[handle];
+	entry.Min = min;
+	entry.Max = max;
+	entry.Value = value;
+	entry.Alive = true;
+	Link(handle);
+
+	m_Count++;
+	return handle;
+}
+
+void SpatialGrid::Move(Handle handle, const glm::vec2& min, const glm::vec2& max)
+{
+	Entry& entry = m_Entries[handle];
+	ASSERT(entry.Alive);
+
+	entry.Min = min;
+	entry.Max = max;
+
+	// Most moves stay within the same cells and only need the new bounds
+	if (GetCell(min.x) == entry.CellMinX && GetCell(min.y) == entry.CellMinY &&
+		GetCell(max.x) == entry.CellMaxX && GetCell(max.y) == entry.CellMaxY)
+		return;
+
+	Unlink(handle);
+	Link(handle);
+}
+
+void SpatialGrid::Remove(Handle handle)
+{
+	Entry& entry = m_Entries[handle];
+	ASSERT(entry.Alive);
+
+	Unlink(handle);
+	entry.Alive = false;
+	m_FreeHandles.push_back(handle);
+	m_Count--;
+}
+
+void SpatialGrid::Clear()
+{
+	m_Cells.clear();
+	m_Entries.clear();
+	m_FreeHandles.clear();
+	m_Count = 0;
+}
+
+void SpatialGrid::QueryRegion(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& results) const
+{
+	int minX = GetCell(min.x), minY = GetCell(min.y);
+	int maxX = GetCell(max.x), maxY = GetCell(max.y);
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		for (int x = minX; x <= maxX; x++)
+		{
+			auto cell = m_Cells.find(GetCellKey(x, y));
+			if (cell == m_Cells.end())
+				continue;
+
+			for (Handle handle : cell->second)
+			{
+				const Entry& entry = m_Entries[handle];
+
+				// An entry spanning several cells is only reported from the first of
+				// them inside the query, which avoids marking entries as visited
+				if (x != std::max(entry.CellMinX, minX) || y != std::max(entry.CellMinY, minY))
+					continue;
+
+				if (entry.Max.x < min.x || entry.Min.x > max.x || entry.Max.y < min.y || entry.Min.y > max.y)
+					continue;
+
+				results.push_back(entry.Value);
+			}
+		}
+	}
+}
+
+void SpatialGrid::QueryPoint(const glm::vec2& point, std::vector<unsigned int>& results) const
+{
+	auto cell = m_Cells.find(GetCellKey(GetCell(point.x), GetCell(point.y)));
+	if (cell == m_Cells.end())
+		return;
+
+	for (Handle handle : cell->second)
+	{
+		const Entry& entry = m_Entries[handle];
+		if (point.x >= entry.Min.x && point.x <= entry.Max.x && point.y >= entry.Min.y && point.y <= entry.Max.y)
+			results.push_back(entry.Value);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Uniform grid over unbounded 2D space for visibility and picking queries. Only
+// occupied cells are stored, in a hash map keyed by cell coordinates, so the world
+// size does not matter. Boxes larger than a cell are linked into every cell they
+// touch. Queries cost the number of cells they cover plus the entries found there,
+// independent of how many objects are in the scene.
+class SpatialGrid
+{
+public:
+	typedef unsigned int Handle;
+
+private:
+	struct Entry
+	{
+		glm::vec2 Min, Max;
+		int CellMinX, CellMinY, CellMaxX, CellMaxY;
+		unsigned int Value;
+		bool Alive;
+	};
+
+	float m_CellSize;
+	float m_InverseCellSize;
+	std::unordered_map<unsigned long long, std::vector<Handle>> m_Cells;
+	std::vector<Entry> m_Entries;
+	std::vector<Handle> m_FreeHandles;
+	unsigned int m_Count;
+
+	static unsigned long long GetCellKey(int x, int y);
+	int GetCell(float coordinate) const;
+	void Link(Handle handle);
+	void Unlink(Handle handle);
+
+public:
+	SpatialGrid(float cellSize = 64.0f);
+	~SpatialGrid();
+
+	// value is what queries report for this entry, usually an index into the caller's objects
+	Handle Insert(const glm::vec2& min, const glm::vec2& max, unsigned int value);
+	void Move(Handle handle, const glm::vec2& min, const glm::vec2& max);
+	void Remove(Handle handle);
+	void Clear();
+
+	// Append the values of entries overlapping the region or containing the point.
+	// Each entry is reported once. Safe to call from several threads at a time.
+	void QueryRegion(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& results) const;
+	void QueryPoint(const glm::vec2& point, std::vector<unsigned int>& results) const;
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetCellCount() const { return (unsigned int)m_Cells.size(); }
+	inline float GetCellSize() const { return m_CellSize; }
+};
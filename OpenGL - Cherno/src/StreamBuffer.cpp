@@ -0,0 +1,154 @@
+#include "StreamBuffer.h"
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int alignment)
+	: m_RendererID(0), m_Target(target), m_RegionSize(regionSize), m_Alignment(alignment),
+	  m_Persistent(SupportsPersistentMapping()), m_MappedData(nullptr), m_StagingData(nullptr),
+	  m_Region(0), m_Offset(0), m_MappedOffset(0), m_Mapped(false), m_Stalls(0)
+{
+	ASSERT(alignment > 0);
+	for (GLsync& fence : m_Fences)
+		fence = nullptr;
+
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLStateCache::BindBuffer(m_Target, m_RendererID);
+
+	if (m_Persistent)
+	{
+		// Coherent, so writes become visible to the GPU without explicit flushes
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(m_Target, (GLsizeiptr)m_RegionSize * RegionCount, nullptr, flags));
+		GLCall(m_MappedData = (unsigned char*)glMapBufferRange(m_Target, 0, (GLsizeiptr)m_RegionSize * RegionCount, flags));
+		ASSERT(m_MappedData);
+	}
+	else
+	{
+		GLCall(glBufferData(m_Target, m_RegionSize, nullptr, GL_STREAM_DRAW));
+		m_StagingData = new unsigned char[m_RegionSize];
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (GLsync fence : m_Fences)
+	{
+		if (fence)
+		{
+			GLCall(glDeleteSync(fence));
+		}
+	}
+
+	if (m_Persistent)
+	{
+		Bind();
+		GLCall(glUnmapBuffer(m_Target));
+	}
+	delete[] m_StagingData;
+
+	GLStateCache::OnDeleteBuffer(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+bool StreamBuffer::SupportsPersistentMapping()
+{
+	return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+void StreamBuffer::NextRegion()
+{
+	m_Offset = 0;
+
+	if (!m_Persistent)
+	{
+		// Orphaning hands the old storage to the driver, which frees it once the GPU is done
+		Bind();
+		GLCall(glBufferData(m_Target, m_RegionSize, nullptr, GL_STREAM_DRAW));
+		return;
+	}
+
+	if (m_Fences[m_Region])
+	{
+		GLCall(glDeleteSync(m_Fences[m_Region]));
+	}
+	m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_Region = (m_Region + 1) % RegionCount;
+
+	GLsync fence = m_Fences[m_Region];
+	if (!fence)
+		return;
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		// The GPU is still reading this region from RegionCount - 1 frames ago
+		m_Stalls++;
+		do
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	GLCall(glDeleteSync(fence));
+	m_Fences[m_Region] = nullptr;
+}
+
+void* StreamBuffer::Map(unsigned int maxSize)
+{
+	ASSERT(!m_Mapped);
+	ASSERT(maxSize <= m_RegionSize);
+
+	unsigned int offset = (m_Offset + m_Alignment - 1) / m_Alignment * m_Alignment;
+	if (offset + maxSize > m_RegionSize)
+	{
+		NextRegion();
+		offset = 0;
+	}
+
+	m_MappedOffset = offset;
+	m_Mapped = true;
+
+	if (m_Persistent)
+		return m_MappedData + (size_t)m_Region * m_RegionSize + offset;
+	return m_StagingData + offset;
+}
+
+unsigned int StreamBuffer::Unmap(unsigned int usedSize)
+{
+	ASSERT(m_Mapped);
+	ASSERT(m_MappedOffset + usedSize <= m_RegionSize);
+
+	unsigned int offset = m_MappedOffset;
+	if (m_Persistent)
+	{
+		offset += m_Region * m_RegionSize;
+	}
+	else if (usedSize > 0)
+	{
+		Bind();
+		GLCall(glBufferSubData(m_Target, offset, usedSize, m_StagingData + m_MappedOffset));
+	}
+
+	m_Offset = m_MappedOffset + usedSize;
+	m_Mapped = false;
+	return offset;
+}
+
+void StreamBuffer::EndFrame()
+{
+	ASSERT(!m_Mapped);
+	if (m_Offset > 0)
+		NextRegion();
+}
+
+void StreamBuffer::Bind() const
+{
+	GLStateCache::BindBuffer(m_Target, m_RendererID);
+}
+
+void StreamBuffer::Unbind() const
+{
+	GLStateCache::BindBuffer(m_Target, 0);
+}
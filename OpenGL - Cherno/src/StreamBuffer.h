@@ -0,0 +1,64 @@
+#pragma once
+
+typedef struct __GLsync* GLsync;
+
+// Buffer for data the CPU regenerates every frame. With ARB_buffer_storage it is
+// one persistently and coherently mapped allocation split into RegionCount
+// regions: each frame writes into its own region and fences it when done, and a
+// region is only reused once its fence has signaled, so writes go straight into
+// GPU-visible memory without allocating or copying. Without the extension the
+// data is staged on the CPU and uploaded with glBufferSubData, orphaning the
+// buffer whenever it wraps around.
+//
+// Map returns room for up to maxSize bytes; Unmap with the bytes actually written
+// returns their offset in the buffer, to draw with (e.g. as base vertex).
+class StreamBuffer
+{
+public:
+	static const unsigned int RegionCount = 3;
+
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Target;
+	unsigned int m_RegionSize;
+	unsigned int m_Alignment;
+	bool m_Persistent;
+
+	unsigned char* m_MappedData;
+	unsigned char* m_StagingData;
+	GLsync m_Fences[RegionCount];
+	unsigned int m_Region;
+	unsigned int m_Offset;
+	unsigned int m_MappedOffset;
+	bool m_Mapped;
+
+	unsigned int m_Stalls;
+
+	void NextRegion();
+
+public:
+	// alignment applies to every offset Unmap returns, pass the vertex stride when
+	// drawing with a base vertex
+	StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int alignment = 4);
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	void* Map(unsigned int maxSize);
+	unsigned int Unmap(unsigned int usedSize);
+
+	// Fences everything written this frame and moves on to the next region
+	void EndFrame();
+
+	void Bind() const;
+	void Unbind() const;
+
+	static bool SupportsPersistentMapping();
+
+	inline bool IsPersistent() const { return m_Persistent; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	// Times the CPU had to wait for the GPU to release a region
+	inline unsigned int GetStallCount() const { return m_Stalls; }
+};
@@ -1,19 +1,33 @@
 #include "Texture.h"
 
+#include "GLStateCache.h"
+#include "Profiler.h"
+
 #include "provided/stb_image/stb_image.h"
 
-Texture::Texture(const std::string& path)
+Texture::Texture(const std::string& path, TextureLoading loading)
 
 	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr),
 	 m_Width(0), m_Height(0), m_BPP(0)
 {
+	PROFILE_SCOPE("Texture::Texture");
+
+	if (loading == TextureLoading::Async)
+	{
+		m_Load = TextureLoader::Load(this, path);
+		return;
+	}
+
 	// Load image data
-	stbi_set_flip_vertically_on_load(1);
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	{
+		PROFILE_SCOPE("stbi_load");
+		stbi_set_flip_vertically_on_load(1);
+		m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	}
 
 	// Create OpenGL texture
 	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::BindTextureForEdit(0, m_RendererID);
 
 	// Set basic texture parameters
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
@@ -23,7 +37,7 @@ Texture::Texture(const std::string& path)
 
 	// Upload texture data to GPU
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::BindTexture(0, 0);
 
 	// Free image data
 	if (m_LocalBuffer)
@@ -33,21 +47,59 @@ Texture::Texture(const std::string& path)
 	}
 }
 
+Texture::Texture(int width, int height)
+	: m_RendererID(0), m_LocalBuffer(nullptr),
+	 m_Width(width), m_Height(height), m_BPP(4)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLStateCache::BindTextureForEdit(0, m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	// Allocate storage only, the data comes through SetData
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLStateCache::BindTexture(0, 0);
+}
+
 Texture::~Texture()
 {
-	GLCall(glDeleteTextures(1, &m_RendererID))
+	if (m_RendererID == 0)
+	{
+		TextureLoader::Cancel(this);
+		return;
+	}
+
+	GLStateCache::OnDeleteTexture(m_RendererID);
+	GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void Texture::WaitUntilLoaded()
+{
+	if (m_Load && !m_Load->IsDone())
+		TextureLoader::Finish(this);
+}
+
+void Texture::SetData(const void* data, unsigned int size)
+{
+	ASSERT(m_RendererID != 0 && size == (unsigned int)(m_Width * m_Height * 4));
+
+	GLStateCache::BindTextureForEdit(0, m_RendererID);
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	GLStateCache::BindTexture(0, 0);
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-	if (slot > 31)
+	if (slot >= GLStateCache::MaxTextureUnits)
 		slot = 0;
 
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::BindTexture(slot, GetRendererID());
 }
 
 void Texture::Unbind() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::BindTexture(0, 0);
 }
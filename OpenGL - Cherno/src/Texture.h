@@ -1,22 +1,53 @@
 #pragma once
 
 #include "Renderer.h"
+#include "TextureLoader.h"
+
+#include <memory>
+
+// Async textures decode on the thread pool and upload over the next frames
+// through TextureLoader, binding its placeholder until then
+enum class TextureLoading
+{
+	Immediate, Async
+};
 
 class Texture
 {
 private:
+	// 0 while an async load is in progress
 	unsigned int m_RendererID;
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	std::shared_ptr<TextureLoadHandle> m_Load;
+
+	friend class TextureLoader;
 
 public:
-	Texture(const std::string& path);
+	Texture(const std::string& path, TextureLoading loading = TextureLoading::Immediate);
+	// Empty RGBA8 texture, filled later through SetData
+	Texture(int width, int height);
 	~Texture();
 
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	// Finishes an async load right away, decoding and uploading on the spot if
+	// TextureLoader has not got to it yet
+	void WaitUntilLoaded();
+
+	void SetData(const void* data, unsigned int size);
+
 	void Bind(unsigned int slot = 0) const;
 	void Unbind() const;
 
+	// 0 until an async load has decoded the image
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	// The placeholder's until an async load completes
+	inline unsigned int GetRendererID() const { return m_RendererID ? m_RendererID : TextureLoader::GetPlaceholder(); }
+	// Null for immediate textures, which are loaded once constructed
+	inline const std::shared_ptr<TextureLoadHandle>& GetLoadHandle() const { return m_Load; }
+	inline bool IsLoaded() const { return !m_Load || m_Load->GetState() == TextureLoadState::Ready; }
 };
\ No newline at end of file
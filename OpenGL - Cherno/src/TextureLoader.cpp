@@ -0,0 +1,281 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "GLStateCache.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+#include "provided/stb_image/stb_image.h"
+
+std::vector<std::shared_ptr<TextureLoader::Job>> TextureLoader::s_Jobs;
+unsigned int TextureLoader::s_Placeholder = 0;
+size_t TextureLoader::s_UploadBudget = 4 * 1024 * 1024;
+TextureLoader::Stats TextureLoader::s_Stats;
+
+TextureLoadHandle::TextureLoadHandle()
+	: m_State(TextureLoadState::Decoding)
+{
+}
+
+void TextureLoadHandle::SetState(TextureLoadState state)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_State = state;
+	m_Condition.notify_all();
+}
+
+void TextureLoadHandle::Wait() const
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return IsDone(); });
+}
+
+void TextureLoader::Decode(Job& job)
+{
+	PROFILE_SCOPE("TextureLoader::Decode");
+
+	// The global flag would race with loads on other threads
+	stbi_set_flip_vertically_on_load_thread(1);
+	int bpp;
+	job.Pixels = stbi_load(job.Path.c_str(), &job.Width, &job.Height, &bpp, 4);
+	if (job.Pixels)
+		job.Handle->SetState(TextureLoadState::Uploading);
+	else
+		job.Error = stbi_failure_reason();
+}
+
+bool TextureLoader::IsDecoded(Job& job)
+{
+	return job.Decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::shared_ptr<TextureLoadHandle> TextureLoader::Load(Texture* texture, const std::string& path)
+{
+	// Made here as loads come from the GL thread, which is the only one that may
+	if (s_Placeholder == 0)
+	{
+		// Grey checkerboard, obviously not the real texture
+		const unsigned char pixels[] = {
+			96, 96, 96, 255,	160, 160, 160, 255,
+			160, 160, 160, 255,	96, 96, 96, 255
+		};
+
+		GLCall(glGenTextures(1, &s_Placeholder));
+		GLStateCache::BindTextureForEdit(0, s_Placeholder);
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+		GLStateCache::BindTexture(0, 0);
+	}
+
+	auto job = std::make_shared<Job>();
+	job->Target = texture;
+	job->Path = path;
+	job->Handle = std::make_shared<TextureLoadHandle>();
+
+	// Without worker threads this decodes right away, the upload is still spread out
+	job->Decoded = ThreadPool::Get().Submit([job]() { Decode(*job); });
+
+	s_Jobs.push_back(job);
+	return job->Handle;
+}
+
+bool TextureLoader::UploadRows(Job& job, size_t& budget)
+{
+	size_t rowSize = (size_t)job.Width * 4;
+	int rows = (int)std::min<size_t>(job.Height - job.RowsUploaded, budget / rowSize);
+	// A fresh budget is never 0, see SetUploadBudget
+	if (rows == 0 && budget == s_UploadBudget)
+		rows = 1;
+	if (rows == 0)
+		return false;
+
+	if (job.RendererID == 0)
+	{
+		GLCall(glGenTextures(1, &job.RendererID));
+		GLStateCache::BindTextureForEdit(0, job.RendererID);
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, job.Width, job.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+		GLCall(glGenBuffers(1, &job.PixelBuffer));
+		GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, job.PixelBuffer);
+		GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, rowSize * job.Height, nullptr, GL_STREAM_DRAW));
+	}
+	else
+	{
+		GLStateCache::BindTextureForEdit(0, job.RendererID);
+		GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, job.PixelBuffer);
+	}
+
+	// Every band goes to its own part of the buffer, which nothing reads yet,
+	// so mapping it never has to wait for the GPU
+	size_t offset = rowSize * job.RowsUploaded;
+	size_t size = rowSize * rows;
+	void* mapped;
+	GLCall(mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	GLboolean intact = GL_FALSE;
+	if (mapped)
+	{
+		std::memcpy(mapped, job.Pixels + offset, size);
+		GLCall(intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	}
+	if (!intact)
+	{
+		GLCall(glBufferSubData(GL_PIXEL_UNPACK_BUFFER, offset, size, job.Pixels + offset));
+	}
+
+	// With an unpack buffer bound the pointer is an offset into it
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.RowsUploaded, job.Width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)offset));
+
+	// Left bound, it would turn every other pixel upload into a buffer read
+	GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	GLStateCache::BindTexture(0, 0);
+
+	job.RowsUploaded += rows;
+	budget -= std::min(budget, size);
+	s_Stats.BytesUploaded += size;
+	return job.RowsUploaded == job.Height;
+}
+
+void TextureLoader::Complete(Job& job)
+{
+	if (job.Target && job.Pixels)
+	{
+		job.Target->m_RendererID = job.RendererID;
+		job.Target->m_Width = job.Width;
+		job.Target->m_Height = job.Height;
+		job.Target->m_BPP = 4;
+		job.RendererID = 0;
+		job.Handle->SetState(TextureLoadState::Ready);
+		s_Stats.Completed++;
+	}
+	else
+	{
+		if (job.Target)
+			std::cout << "Failed to load texture " << job.Path << ": " << job.Error << std::endl;
+		job.Handle->SetState(TextureLoadState::Failed);
+	}
+
+	Release(job);
+}
+
+void TextureLoader::Release(Job& job)
+{
+	if (job.Pixels)
+	{
+		stbi_image_free(job.Pixels);
+		job.Pixels = nullptr;
+	}
+
+	// GL keeps the buffer until the uploads reading it are done
+	if (job.PixelBuffer)
+	{
+		GLStateCache::OnDeleteBuffer(job.PixelBuffer);
+		GLCall(glDeleteBuffers(1, &job.PixelBuffer));
+		job.PixelBuffer = 0;
+	}
+	if (job.RendererID)
+	{
+		GLStateCache::OnDeleteTexture(job.RendererID);
+		GLCall(glDeleteTextures(1, &job.RendererID));
+		job.RendererID = 0;
+	}
+}
+
+void TextureLoader::Update()
+{
+	PROFILE_SCOPE("TextureLoader::Update");
+	s_Stats.BytesUploaded = 0;
+	s_Stats.Decoding = 0;
+	s_Stats.Uploading = 0;
+
+	// Oldest first, so textures appear in the order they were asked for
+	size_t budget = s_UploadBudget;
+	for (auto it = s_Jobs.begin(); it != s_Jobs.end();)
+	{
+		Job& job = **it;
+		if (!IsDecoded(job))
+		{
+			s_Stats.Decoding++;
+			++it;
+			continue;
+		}
+
+		if (!job.Target || !job.Pixels || UploadRows(job, budget))
+		{
+			Complete(job);
+			it = s_Jobs.erase(it);
+			continue;
+		}
+
+		s_Stats.Uploading++;
+		++it;
+	}
+}
+
+void TextureLoader::Finish(Texture* texture)
+{
+	auto it = std::find_if(s_Jobs.begin(), s_Jobs.end(), [texture](const std::shared_ptr<Job>& job) { return job->Target == texture; });
+	if (it == s_Jobs.end())
+		return;
+
+	PROFILE_SCOPE("TextureLoader::Finish");
+	Job& job = **it;
+	job.Decoded.wait();
+
+	// An unlimited budget takes the remaining rows in one go
+	size_t budget = ~(size_t)0;
+	if (job.Pixels)
+		UploadRows(job, budget);
+	Complete(job);
+	s_Jobs.erase(it);
+}
+
+void TextureLoader::Cancel(Texture* texture)
+{
+	for (auto it = s_Jobs.begin(); it != s_Jobs.end(); ++it)
+	{
+		Job& job = **it;
+		if (job.Target != texture)
+			continue;
+
+		// A decode still running finishes into a job nobody waits for, Update drops it then
+		job.Target = nullptr;
+		if (IsDecoded(job))
+		{
+			Complete(job);
+			s_Jobs.erase(it);
+		}
+		return;
+	}
+}
+
+void TextureLoader::Shutdown()
+{
+	for (const std::shared_ptr<Job>& job : s_Jobs)
+	{
+		job->Decoded.wait();
+		job->Target = nullptr;
+		Complete(*job);
+	}
+	s_Jobs.clear();
+
+	if (s_Placeholder)
+	{
+		GLStateCache::OnDeleteTexture(s_Placeholder);
+		GLCall(glDeleteTextures(1, &s_Placeholder));
+		s_Placeholder = 0;
+	}
+	s_Stats = Stats();
+}
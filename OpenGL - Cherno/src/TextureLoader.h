@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Texture;
+
+enum class TextureLoadState
+{
+	Decoding, Uploading, Ready, Failed
+};
+
+// Progress of one asynchronous texture load, safe to poll and wait on from any
+// thread. Waiting blocks until the GL thread has finished the upload, so on
+// that thread use Texture::WaitUntilLoaded, which does the upload itself.
+class TextureLoadHandle
+{
+private:
+	std::atomic<TextureLoadState> m_State;
+	mutable std::mutex m_Mutex;
+	mutable std::condition_variable m_Condition;
+
+	friend class TextureLoader;
+	void SetState(TextureLoadState state);
+
+public:
+	TextureLoadHandle();
+
+	void Wait() const;
+
+	inline TextureLoadState GetState() const { return m_State; }
+	// Ready or failed, a failed texture keeps the placeholder
+	inline bool IsDone() const { TextureLoadState state = m_State; return state == TextureLoadState::Ready || state == TextureLoadState::Failed; }
+};
+
+// Loads the textures created with TextureLoading::Async. Images are decoded
+// on ThreadPool::Get() and uploaded on the GL thread by Update, which copies
+// bands of rows into a pixel unpack buffer and from there into the texture,
+// no more than the upload budget per frame. Until its last row is in, a
+// texture binds a shared placeholder, so loading never stalls a frame.
+//
+// Everything but the handles must only be used on the GL thread. Shutdown
+// has to run before the context goes away, after the textures are gone.
+class TextureLoader
+{
+public:
+	struct Stats
+	{
+		unsigned int Decoding = 0;
+		unsigned int Uploading = 0;
+		unsigned int Completed = 0;
+		// By the last Update
+		size_t BytesUploaded = 0;
+	};
+
+private:
+	struct Job
+	{
+		Texture* Target = nullptr;
+		std::string Path;
+		std::shared_ptr<TextureLoadHandle> Handle;
+		std::future<void> Decoded;
+
+		// Written by the decoding task, read once Decoded is ready
+		unsigned char* Pixels = nullptr;
+		int Width = 0;
+		int Height = 0;
+		std::string Error;
+
+		unsigned int RendererID = 0;
+		unsigned int PixelBuffer = 0;
+		int RowsUploaded = 0;
+	};
+
+	static std::vector<std::shared_ptr<Job>> s_Jobs;
+	static unsigned int s_Placeholder;
+	static size_t s_UploadBudget;
+	static Stats s_Stats;
+
+	static void Decode(Job& job);
+	static bool IsDecoded(Job& job);
+	// Uploads rows until budget runs out, true once all are in
+	static bool UploadRows(Job& job, size_t& budget);
+	// Hands the texture over or fails it, then frees what the job holds
+	static void Complete(Job& job);
+	static void Release(Job& job);
+
+	friend class Texture;
+	static std::shared_ptr<TextureLoadHandle> Load(Texture* texture, const std::string& path);
+	static void Finish(Texture* texture);
+	static void Cancel(Texture* texture);
+
+public:
+	// Once per frame, before drawing
+	static void Update();
+	static void Shutdown();
+
+	// Bytes per Update, at least one row always goes through
+	static inline void SetUploadBudget(size_t bytes) { s_UploadBudget = bytes > 0 ? bytes : 1; }
+	static inline size_t GetUploadBudget() { return s_UploadBudget; }
+	static inline unsigned int GetPlaceholder() { return s_Placeholder; }
+	static inline const Stats& GetStats() { return s_Stats; }
+};
@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Profiler.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+	: m_Stopping(false)
+{
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_Workers.emplace_back([this, i]() {
+			Profiler::SetThreadName("Worker " + std::to_string(i + 1));
+			WorkerLoop();
+		});
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Tasks.empty())
+				return;
+
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+		}
+		task();
+	}
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+	// Single core machines get no workers, the task would never run otherwise
+	if (m_Workers.empty())
+	{
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Tasks.push_back(std::move(task));
+	}
+	m_Condition.notify_one();
+}
+
+void ThreadPool::ParallelFor(unsigned int count, unsigned int parallelism,
+	const std::function<void(unsigned int begin, unsigned int end, unsigned int worker)>& function)
+{
+	parallelism = std::max(1u, std::min({ parallelism, GetThreadCount() + 1, count }));
+	if (parallelism <= 1)
+	{
+		if (count > 0)
+			function(0, count, 0);
+		return;
+	}
+
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+	unsigned int remaining = parallelism - 1;
+
+	unsigned int chunk = (count + parallelism - 1) / parallelism;
+	for (unsigned int worker = 1; worker < parallelism; worker++)
+	{
+		unsigned int begin = std::min(count, worker * chunk);
+		unsigned int end = std::min(count, begin + chunk);
+		Enqueue([&, begin, end, worker]() {
+			if (begin < end)
+			{
+				PROFILE_SCOPE("ParallelFor");
+				function(begin, end, worker);
+			}
+
+			std::lock_guard<std::mutex> lock(doneMutex);
+			if (--remaining == 0)
+				doneCondition.notify_one();
+		});
+	}
+
+	{
+		PROFILE_SCOPE("ParallelFor");
+		function(0, std::min(count, chunk), 0);
+	}
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+	doneCondition.wait(lock, [&]() { return remaining == 0; });
+}
+
+ThreadPool& ThreadPool::Get()
+{
+	static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return pool;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one task queue. A pool without
+// workers runs each task on the calling thread as it is enqueued.
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_Workers;
+	std::deque<std::function<void()>> m_Tasks;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping;
+
+	void WorkerLoop();
+
+public:
+	ThreadPool(unsigned int threadCount);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Enqueue(std::function<void()> task);
+
+	template<typename F>
+	auto Submit(F&& function) -> std::future<decltype(function())>
+	{
+		typedef decltype(function()) Result;
+
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+		std::future<Result> future = task->get_future();
+		Enqueue([task]() { (*task)(); });
+		return future;
+	}
+
+	// Splits [0, count) into one contiguous range per participant and blocks until
+	// all are done. The calling thread takes the first range, so at most
+	// parallelism - 1 workers are used. worker is in [0, parallelism), which lets
+	// callers keep per-worker data without locking. Must not be called from a task.
+	void ParallelFor(unsigned int count, unsigned int parallelism,
+		const std::function<void(unsigned int begin, unsigned int end, unsigned int worker)>& function);
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size(); }
+
+	// Shared pool with one worker per hardware thread besides the calling one
+	static ThreadPool& Get();
+};
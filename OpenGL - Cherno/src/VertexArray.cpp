@@ -1,42 +1,128 @@
 #include "VertexArray.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "StreamBuffer.h"
+#include "VertexFormatCache.h"
 
-VertexArray::VertexArray()
+VertexArray::VertexArray(bool sharedFormat)
+	: m_RendererID(0), m_AttributeCount(0), m_SharedFormat(sharedFormat && VertexFormatCache::IsSupported())
 {
-	GLCall(glGenVertexArrays(1, &m_RendererID));
+	// Shared formats get their vertex array from the cache with the first buffer
+	if (!m_SharedFormat)
+	{
+		GLCall(glGenVertexArrays(1, &m_RendererID));
+	}
 }
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	if (!m_SharedFormat)
+	{
+		GLStateCache::OnDeleteVertexArray(m_RendererID);
+		GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	}
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+	AddBuffer(vb, layout, m_AttributeCount);
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute)
+{
+	if (m_SharedFormat)
+	{
+		AddBinding(vb.GetRendererID(), layout, firstAttribute);
+		return;
+	}
+
 	Bind();
 	vb.Bind();
-	const auto& elements = layout.GetElements();
-	unsigned int offset = 0;
+	AddAttributes(vb.GetRendererID(), layout, firstAttribute);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout)
+{
+	if (m_SharedFormat)
+	{
+		AddBinding(sb.GetRendererID(), layout, m_AttributeCount);
+		return;
+	}
+
+	Bind();
+	sb.Bind();
+	AddAttributes(sb.GetRendererID(), layout, m_AttributeCount);
+}
+
+void VertexArray::AddBinding(unsigned int buffer, const VertexBufferLayout& layout, unsigned int firstAttribute)
+{
+	m_Buffers.push_back({ buffer, layout.GetStride(), layout.GetDivisor() != 0 });
+	m_AttributeCount = std::max(m_AttributeCount, firstAttribute + layout.GetElements().size());
+
+	// Every buffer extends the format. The formats in between stay in the cache,
+	// they are few and usually shared with other vertex arrays anyway.
+	m_RendererID = VertexFormatCache::Acquire(m_RendererID, layout, firstAttribute);
+}
+
+void VertexArray::AddAttributes(unsigned int buffer, const VertexBufferLayout& layout, unsigned int firstAttribute)
+{
+	auto elements = layout.GetElements();
 
 	for (unsigned int i = 0; i < elements.size(); i++)
 	{
 		const auto& element = elements[i];
+		unsigned int attribute = firstAttribute + i;
 
-		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
+		GLCall(glEnableVertexAttribArray(attribute));
+		GLCall(glVertexAttribPointer(attribute, element.count, element.type, element.normalized, layout.GetStride(), (const void*)(uintptr_t)element.offset));
+		GLCall(glVertexAttribDivisor(attribute, layout.GetDivisor()));
 
-		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		if (layout.GetDivisor() != 0)
+			m_InstanceAttributes.push_back({ attribute, buffer, layout.GetStride(), element.type, element.count, element.normalized != 0, element.offset });
 	}
+
+	m_AttributeCount = std::max(m_AttributeCount, firstAttribute + (unsigned int)elements.size());
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLStateCache::BindVertexArray(m_RendererID);
+
+	for (unsigned int i = 0; i < m_Buffers.size(); i++)
+		GLStateCache::BindVertexBuffer(i, m_Buffers[i].Buffer, 0, m_Buffers[i].Stride);
+}
+
+void VertexArray::SetBaseInstance(unsigned int baseInstance) const
+{
+	GLStateCache::BindVertexArray(m_RendererID);
+
+	// Instanced attributes read instance gl_InstanceID / divisor + baseInstance,
+	// so the offset is baseInstance elements whatever the divisor
+	if (m_SharedFormat)
+	{
+		for (unsigned int i = 0; i < m_Buffers.size(); i++)
+		{
+			const BufferBinding& binding = m_Buffers[i];
+			intptr_t offset = binding.PerInstance ? (intptr_t)baseInstance * binding.Stride : 0;
+			GLStateCache::BindVertexBuffer(i, binding.Buffer, offset, binding.Stride);
+		}
+		return;
+	}
+
+	for (const InstanceAttribute& instance : m_InstanceAttributes)
+	{
+		uintptr_t offset = instance.Offset + (uintptr_t)baseInstance * instance.Stride;
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, instance.Buffer);
+		GLCall(glVertexAttribPointer(instance.Attribute, instance.Count, instance.Type, instance.Normalized, instance.Stride, (const void*)offset));
+	}
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLStateCache::BindVertexArray(0);
 }
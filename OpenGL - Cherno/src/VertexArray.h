@@ -1,20 +1,70 @@
 #pragma once
 
+#include <vector>
+
 #include "VertexBuffer.h"
 
 class VertexBufferLayout;
+class StreamBuffer;
 
 class VertexArray
 {
 private:
+	struct BufferBinding
+	{
+		unsigned int Buffer;
+		unsigned int Stride;
+		bool PerInstance;
+	};
+
+	struct InstanceAttribute
+	{
+		unsigned int Attribute;
+		unsigned int Buffer;
+		unsigned int Stride;
+		unsigned int Type;
+		unsigned int Count;
+		bool Normalized;
+		unsigned int Offset;
+	};
+
 	unsigned int m_RendererID;
+	unsigned int m_AttributeCount;
+	bool m_SharedFormat;
+	// Only used with a shared format, one entry per binding point
+	std::vector<BufferBinding> m_Buffers;
+	// Only used without a shared format, for SetBaseInstance
+	std::vector<InstanceAttribute> m_InstanceAttributes;
+
+	// Points attributes at the buffer currently bound to GL_ARRAY_BUFFER, which is buffer
+	void AddAttributes(unsigned int buffer, const VertexBufferLayout& layout, unsigned int firstAttribute);
+	void AddBinding(unsigned int buffer, const VertexBufferLayout& layout, unsigned int firstAttribute);
 
 public:
-	VertexArray();
+	// A shared format vertex array uses the VertexFormatCache vertex array of its
+	// layouts and only binds its own buffers to it, so it never switches vertex
+	// arrays against others of the same format. It has no element buffer, bind
+	// the index buffer before every draw as Renderer does. Without driver support
+	// it is an ordinary vertex array.
+	explicit VertexArray(bool sharedFormat = false);
 	~VertexArray();
 
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+
+	// Attributes continue after the ones of previously added buffers
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute);
+	void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout);
 
 	void Bind() const;
 	void Unbind() const;
+
+	// Binds the vertex array with its per-instance attributes starting at instance
+	// baseInstance, for drivers without ARB_base_instance. Set it back to 0 when done.
+	void SetBaseInstance(unsigned int baseInstance) const;
+
+	// The shared vertex array for shared formats, equal between vertex arrays of one format
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsSharedFormat() const { return m_SharedFormat; }
 };
\ No newline at end of file
@@ -2,25 +2,74 @@
 
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+	: m_Size(size), m_Usage(BufferUsage::Static), m_Strategy(UploadStrategy::Default), m_Pool(nullptr)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+	: m_Size(size), m_Usage(usage), m_Strategy(UploadStrategy::Default), m_Pool(nullptr)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, BufferUpload::GetUsageEnum(usage)));
+}
+
+VertexBuffer::VertexBuffer(BufferPool& pool, const void* data, unsigned int count)
+	: m_Size(count * pool.GetElementSize()), m_Usage(BufferUsage::Static), m_Strategy(UploadStrategy::Default), m_Pool(&pool)
+{
+	ASSERT(pool.GetTarget() == GL_ARRAY_BUFFER);
+
+	m_Allocation = pool.Allocate(count);
+	ASSERT(m_Allocation.IsValid());
+	m_RendererID = pool.GetRendererID(m_Allocation.Block);
+
+	if (data)
+		pool.SetData(m_Allocation, 0, data, count);
+}
+
 VertexBuffer::~VertexBuffer()
 {
+	if (m_Pool)
+	{
+		m_Pool->Free(m_Allocation);
+		return;
+	}
+
+	GLStateCache::OnDeleteBuffer(m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+void VertexBuffer::SetData(const void* data, unsigned int size)
+{
+	SetData(0, data, size);
+}
+
+void VertexBuffer::SetData(unsigned int offset, const void* data, unsigned int size)
+{
+	if (m_Pool)
+	{
+		unsigned int stride = m_Pool->GetElementSize();
+		ASSERT(offset % stride == 0 && size % stride == 0);
+		m_Pool->SetData(m_Allocation, offset / stride, data, size / stride, m_Strategy);
+		return;
+	}
+
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	BufferUpload::Upload(GL_ARRAY_BUFFER, m_Size, m_Usage, m_Strategy, offset, data, size);
+}
+
 void VertexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -1,13 +1,41 @@
 #pragma once
 
+#include "BufferUpload.h"
+#include "BufferPool.h"
+
 class VertexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size;
+	BufferUsage m_Usage;
+	UploadStrategy m_Strategy;
+	BufferPool* m_Pool;
+	BufferPool::Allocation m_Allocation;
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	// Buffer with no initial data, filled later through SetData
+	VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
+	// View of count vertices in a shared pool, whose element size is the vertex
+	// stride. Draw it with GetBaseVertex, the pool has to outlive the view.
+	VertexBuffer(BufferPool& pool, const void* data, unsigned int count);
 	~VertexBuffer();
 
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+	// offset and size are in bytes, relative to the view for pooled buffers
+	void SetData(const void* data, unsigned int size);
+	void SetData(unsigned int offset, const void* data, unsigned int size);
+
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+
+	inline void SetUploadStrategy(UploadStrategy strategy) { m_Strategy = strategy; }
+	inline UploadStrategy GetUploadStrategy() const { return m_Strategy; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsPooled() const { return m_Pool != nullptr; }
+	// Index of the first vertex in the underlying buffer
+	inline int GetBaseVertex() const { return m_Pool ? (int)m_Allocation.Offset : 0; }
+};
@@ -1,41 +1,160 @@
 #pragma once
 
 #include "Renderer.h"
+#include "VertexFormats.h"
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 
-struct VertexBufferElement 
+struct VertexBufferElement
 {
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	// Byte offset from the start of the vertex
+	unsigned int offset;
 
-	static unsigned int GetSizeOfType(unsigned int type) 
+	static constexpr unsigned int GetSizeOfType(unsigned int type)
 	{
-		switch (type) 
+		switch (type)
 		{
 		case GL_FLOAT:			return sizeof(GLfloat);
 		case GL_UNSIGNED_INT:	return sizeof(GLuint);
 		case GL_UNSIGNED_BYTE:	return sizeof(GLbyte);
+		case GL_HALF_FLOAT:		return sizeof(GLhalf);
+		case GL_SHORT:			return sizeof(GLshort);
+		case GL_UNSIGNED_SHORT:	return sizeof(GLushort);
 		}
 
 		ASSERT(false);
 		return 0;
 	}
+
+	// Packed types hold all four components in one 32 bit word
+	constexpr bool IsPacked() const { return type == GL_INT_2_10_10_10_REV; }
+	constexpr unsigned int GetSize() const { return IsPacked() ? sizeof(GLuint) : count * GetSizeOfType(type); }
 };
 
+// How a C++ type is fed to an attribute, used by VertexBufferLayout::Create.
+// Arrays of a type feed one attribute with as many components.
+template<typename T>
+struct VertexAttribute;
+
+template<> struct VertexAttribute<float>			{ static constexpr unsigned int Type = GL_FLOAT, Count = 1; static constexpr bool Normalized = false; };
+template<> struct VertexAttribute<glm::vec2>		{ static constexpr unsigned int Type = GL_FLOAT, Count = 2; static constexpr bool Normalized = false; };
+template<> struct VertexAttribute<glm::vec3>		{ static constexpr unsigned int Type = GL_FLOAT, Count = 3; static constexpr bool Normalized = false; };
+template<> struct VertexAttribute<glm::vec4>		{ static constexpr unsigned int Type = GL_FLOAT, Count = 4; static constexpr bool Normalized = false; };
+template<> struct VertexAttribute<unsigned int>		{ static constexpr unsigned int Type = GL_UNSIGNED_INT, Count = 1; static constexpr bool Normalized = false; };
+template<> struct VertexAttribute<unsigned char>	{ static constexpr unsigned int Type = GL_UNSIGNED_BYTE, Count = 1; static constexpr bool Normalized = true; };
+template<> struct VertexAttribute<short>			{ static constexpr unsigned int Type = GL_SHORT, Count = 1; static constexpr bool Normalized = true; };
+template<> struct VertexAttribute<unsigned short>	{ static constexpr unsigned int Type = GL_UNSIGNED_SHORT, Count = 1; static constexpr bool Normalized = true; };
+template<> struct VertexAttribute<Half>				{ static constexpr unsigned int Type = GL_HALF_FLOAT, Count = 1; static constexpr bool Normalized = false; };
+template<> struct VertexAttribute<Packed1010102>	{ static constexpr unsigned int Type = GL_INT_2_10_10_10_REV, Count = 4; static constexpr bool Normalized = true; };
+
+template<typename T, size_t N>
+struct VertexAttribute<T[N]>
+{
+	static_assert(VertexAttribute<T>::Count == 1, "Arrays only combine single component types");
+	static constexpr unsigned int Type = VertexAttribute<T>::Type, Count = (unsigned int)N;
+	static constexpr bool Normalized = VertexAttribute<T>::Normalized;
+};
+
+// Attributes of one vertex buffer, in order. Elements are stored inline, up to
+// the 16 attributes every implementation supports, so building a layout never
+// allocates and layouts can be constexpr. Vertex structs describe theirs with
+// Create and check it against the struct:
+//
+//	static constexpr VertexBufferLayout GetLayout() { return VertexBufferLayout::Create<glm::vec3, glm::vec2>(); }
+//	static_assert(Vertex::GetLayout().Matches(sizeof(Vertex), { offsetof(Vertex, Position), offsetof(Vertex, TexCoord) }), "");
 class VertexBufferLayout
 {
+public:
+	static constexpr unsigned int MaxElements = 16;
+
+	class ElementRange
+	{
+	private:
+		const VertexBufferElement* m_Begin;
+		unsigned int m_Count;
+	public:
+		constexpr ElementRange(const VertexBufferElement* begin, unsigned int count)
+			: m_Begin(begin), m_Count(count)
+		{
+		}
+
+		constexpr const VertexBufferElement* begin() const { return m_Begin; }
+		constexpr const VertexBufferElement* end() const { return m_Begin + m_Count; }
+		constexpr unsigned int size() const { return m_Count; }
+		constexpr const VertexBufferElement& operator[](unsigned int i) const { return m_Begin[i]; }
+	};
+
 private:
-	std::vector<VertexBufferElement> m_Elements;
+	VertexBufferElement m_Elements[MaxElements];
+	unsigned int m_Count;
 	unsigned int m_Stride;
+	unsigned int m_Divisor;
+
+	constexpr void AddElement(unsigned int type, unsigned int count, bool normalized)
+	{
+		ASSERT(m_Count < MaxElements);
+		VertexBufferElement& element = m_Elements[m_Count++];
+		element.type = type;
+		element.count = count;
+		element.normalized = normalized ? GL_TRUE : GL_FALSE;
+		element.offset = m_Stride;
+		m_Stride += element.GetSize();
+	}
+
+	template<typename T>
+	constexpr void PushAttribute()
+	{
+		using Attribute = VertexAttribute<T>;
+		AddElement(Attribute::Type, Attribute::Count, Attribute::Normalized);
+		static_assert(sizeof(T) == (Attribute::Type == GL_INT_2_10_10_10_REV ? sizeof(GLuint) : Attribute::Count * VertexBufferElement::GetSizeOfType(Attribute::Type)),
+			"Attribute type has padding");
+	}
+
+	static constexpr uint64_t HashCombine(uint64_t hash, uint64_t value)
+	{
+		// FNV-1a, one byte at a time
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
 public:
-	VertexBufferLayout()
-		: m_Stride(0) 
+	constexpr VertexBufferLayout()
+		: m_Elements{}, m_Count(0), m_Stride(0), m_Divisor(0)
+	{
+
+	}
+
+	// One element per type, packed tightly in order
+	template<typename... Attributes>
+	static constexpr VertexBufferLayout Create(unsigned int divisor = 0)
 	{
+		VertexBufferLayout layout;
+		layout.m_Divisor = divisor;
+		int expand[] = { 0, (layout.PushAttribute<Attributes>(), 0)... };
+		(void)expand;
+		return layout;
+	}
+
+	// 0 advances the attributes per vertex, N advances them once every N instances
+	constexpr void SetDivisor(unsigned int divisor) { m_Divisor = divisor; }
 
+	// Any GL attribute type, normalized integers are read as floats in [0, 1] or [-1, 1]
+	constexpr void Push(unsigned int type, unsigned int count, bool normalized)
+	{
+		AddElement(type, count, normalized);
 	}
 
 	template<typename T>
@@ -45,26 +164,102 @@ public:
 	}
 
 	template<>
-	void Push<float>(unsigned int count)
+	constexpr void Push<float>(unsigned int count)
 	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+		AddElement(GL_FLOAT, count, false);
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count)
+	constexpr void Push<unsigned int>(unsigned int count)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+		AddElement(GL_UNSIGNED_INT, count, false);
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count)
+	constexpr void Push<unsigned char>(unsigned int count)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+		AddElement(GL_UNSIGNED_BYTE, count, true);
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
-	inline unsigned int GetStride() const { return m_Stride; }
-};
\ No newline at end of file
+	template<>
+	constexpr void Push<short>(unsigned int count)
+	{
+		AddElement(GL_SHORT, count, true);
+	}
+
+	template<>
+	constexpr void Push<unsigned short>(unsigned int count)
+	{
+		AddElement(GL_UNSIGNED_SHORT, count, true);
+	}
+
+	template<>
+	constexpr void Push<Half>(unsigned int count)
+	{
+		AddElement(GL_HALF_FLOAT, count, false);
+	}
+
+	// count is the number of packed words, each one attribute of 4 components
+	template<>
+	constexpr void Push<Packed1010102>(unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			AddElement(GL_INT_2_10_10_10_REV, 4, true);
+	}
+
+	// True when the elements start at the given offsets and the stride is the
+	// vertex size, meant for a static_assert next to the vertex struct
+	constexpr bool Matches(size_t vertexSize, std::initializer_list<size_t> offsets) const
+	{
+		if (vertexSize != m_Stride || offsets.size() != m_Count)
+			return false;
+		for (unsigned int i = 0; i < m_Count; i++)
+		{
+			if (offsets.begin()[i] != m_Elements[i].offset)
+				return false;
+		}
+		return true;
+	}
+
+	constexpr uint64_t GetHash() const
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned int i = 0; i < m_Count; i++)
+		{
+			const VertexBufferElement& element = m_Elements[i];
+			hash = HashCombine(hash, ((uint64_t)element.type << 32) | ((uint64_t)element.count << 8) | element.normalized);
+			hash = HashCombine(hash, element.offset);
+		}
+		return HashCombine(hash, ((uint64_t)m_Stride << 32) | m_Divisor);
+	}
+
+	constexpr bool operator==(const VertexBufferLayout& other) const
+	{
+		if (m_Count != other.m_Count || m_Stride != other.m_Stride || m_Divisor != other.m_Divisor)
+			return false;
+		for (unsigned int i = 0; i < m_Count; i++)
+		{
+			const VertexBufferElement& a = m_Elements[i];
+			const VertexBufferElement& b = other.m_Elements[i];
+			if (a.type != b.type || a.count != b.count || a.normalized != b.normalized || a.offset != b.offset)
+				return false;
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const VertexBufferLayout& other) const { return !(*this == other); }
+
+	constexpr ElementRange GetElements() const { return ElementRange(m_Elements, m_Count); }
+	constexpr unsigned int GetStride() const { return m_Stride; }
+	constexpr unsigned int GetDivisor() const { return m_Divisor; }
+};
+
+namespace std {
+
+	template<>
+	struct hash<VertexBufferLayout>
+	{
+		size_t operator()(const VertexBufferLayout& layout) const { return (size_t)layout.GetHash(); }
+	};
+
+}
@@ -0,0 +1,114 @@
+#include "VertexFormatCache.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+std::unordered_multimap<uint64_t, VertexFormatCache::Entry> VertexFormatCache::s_Entries;
+VertexFormatCache::Stats VertexFormatCache::s_Stats;
+
+bool VertexFormatCache::IsSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
+uint64_t VertexFormatCache::GetHash(const std::vector<Binding>& bindings)
+{
+	uint64_t hash = 0;
+	for (const Binding& binding : bindings)
+	{
+		uint64_t value = binding.Layout.GetHash() ^ ((uint64_t)binding.FirstAttribute << 56);
+		hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	}
+	return hash;
+}
+
+bool VertexFormatCache::Matches(const Entry& entry, const std::vector<Binding>& bindings)
+{
+	if (entry.Bindings.size() != bindings.size())
+		return false;
+
+	for (unsigned int i = 0; i < bindings.size(); i++)
+	{
+		if (entry.Bindings[i].Layout != bindings[i].Layout || entry.Bindings[i].FirstAttribute != bindings[i].FirstAttribute)
+			return false;
+	}
+	return true;
+}
+
+unsigned int VertexFormatCache::CreateVertexArray(const std::vector<Binding>& bindings)
+{
+	unsigned int vertexArray;
+	GLCall(glGenVertexArrays(1, &vertexArray));
+	GLStateCache::BindVertexArray(vertexArray);
+
+	for (unsigned int b = 0; b < bindings.size(); b++)
+	{
+		const VertexBufferLayout& layout = bindings[b].Layout;
+		auto elements = layout.GetElements();
+
+		for (unsigned int i = 0; i < elements.size(); i++)
+		{
+			const auto& element = elements[i];
+			unsigned int attribute = bindings[b].FirstAttribute + i;
+
+			GLCall(glEnableVertexAttribArray(attribute));
+			GLCall(glVertexAttribFormat(attribute, element.count, element.type, element.normalized, element.offset));
+			GLCall(glVertexAttribBinding(attribute, b));
+		}
+
+		GLCall(glVertexBindingDivisor(b, layout.GetDivisor()));
+	}
+
+	return vertexArray;
+}
+
+unsigned int VertexFormatCache::Acquire(const std::vector<Binding>& bindings)
+{
+	ASSERT(IsSupported());
+	s_Stats.Lookups++;
+
+	uint64_t hash = GetHash(bindings);
+	auto range = s_Entries.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (Matches(it->second, bindings))
+			return it->second.RendererID;
+	}
+
+	Entry entry;
+	entry.Bindings = bindings;
+	entry.RendererID = CreateVertexArray(bindings);
+	s_Entries.emplace(hash, entry);
+	s_Stats.Formats++;
+	return entry.RendererID;
+}
+
+unsigned int VertexFormatCache::Acquire(unsigned int vertexArray, const VertexBufferLayout& layout, unsigned int firstAttribute)
+{
+	std::vector<Binding> bindings;
+	if (vertexArray != 0)
+	{
+		// Only a handful of formats exist, a search beats keeping a second index
+		auto it = std::find_if(s_Entries.begin(), s_Entries.end(),
+			[vertexArray](const std::pair<const uint64_t, Entry>& entry) { return entry.second.RendererID == vertexArray; });
+		ASSERT(it != s_Entries.end());
+		bindings = it->second.Bindings;
+	}
+
+	bindings.push_back({ layout, firstAttribute });
+	return Acquire(bindings);
+}
+
+void VertexFormatCache::Shutdown()
+{
+	for (const auto& entry : s_Entries)
+	{
+		GLStateCache::OnDeleteVertexArray(entry.second.RendererID);
+		GLCall(glDeleteVertexArrays(1, &entry.second.RendererID));
+	}
+
+	s_Entries.clear();
+	s_Stats = Stats();
+}
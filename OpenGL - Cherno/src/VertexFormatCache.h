@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+// Vertex arrays that only describe a vertex format: attribute formats and the
+// binding point each one reads from, set up with glVertexAttribFormat
+// (ARB_vertex_attrib_binding, core in 4.3). Vertex arrays with the same layouts
+// share one of these and only swap the buffers bound to it with
+// glBindVertexBuffer, so meshes of one format draw without switching vertex
+// arrays. Lookups hash the layouts, see VertexBufferLayout::GetHash.
+//
+// Must only be used on the thread that owns the GL context. Entries live until
+// Shutdown, which has to run before that context goes away.
+class VertexFormatCache
+{
+public:
+	// Binding point i of the format is fed by bindings[i], whose attributes
+	// are numbered from FirstAttribute
+	struct Binding
+	{
+		VertexBufferLayout Layout;
+		unsigned int FirstAttribute;
+	};
+
+	struct Stats
+	{
+		unsigned int Formats = 0;
+		unsigned int Lookups = 0;
+	};
+
+private:
+	struct Entry
+	{
+		std::vector<Binding> Bindings;
+		unsigned int RendererID;
+	};
+
+	static std::unordered_multimap<uint64_t, Entry> s_Entries;
+	static Stats s_Stats;
+
+	static uint64_t GetHash(const std::vector<Binding>& bindings);
+	static bool Matches(const Entry& entry, const std::vector<Binding>& bindings);
+	static unsigned int CreateVertexArray(const std::vector<Binding>& bindings);
+
+public:
+	static bool IsSupported();
+
+	// Vertex array of this format, created on first use
+	static unsigned int Acquire(const std::vector<Binding>& bindings);
+	// Vertex array of the format of vertexArray, or of none for 0, with one
+	// more binding point fed by layout
+	static unsigned int Acquire(unsigned int vertexArray, const VertexBufferLayout& layout, unsigned int firstAttribute);
+
+	static void Shutdown();
+
+	static inline const Stats& GetStats() { return s_Stats; }
+};
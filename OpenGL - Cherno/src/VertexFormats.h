@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// Compact attribute storage. These are the C++ side of VertexBufferLayout::Push
+// for GL_HALF_FLOAT and GL_INT_2_10_10_10_REV, plus conversions to and from float.
+
+// IEEE 754 binary16, 10 bit mantissa: about 3 decimal digits, up to 65504
+struct Half
+{
+	uint16_t Bits;
+};
+
+// Four signed normalized components in one 32 bit word, x in the low bits:
+// 10 bits each for xyz and 2 bits for w, which can only be -1, 0 or 1
+struct Packed1010102
+{
+	uint32_t Bits;
+};
+
+namespace VertexFormats {
+
+	// Round to nearest even, out of range values become infinity
+	inline Half FloatToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(float));
+
+		uint32_t sign = (bits >> 16) & 0x8000;
+		int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa = bits & 0x7fffff;
+
+		Half half;
+		if (((bits >> 23) & 0xff) == 0xff)
+		{
+			// Infinity stays infinity, NaN stays NaN
+			half.Bits = (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+		}
+		else if (exponent >= 31)
+		{
+			half.Bits = (uint16_t)(sign | 0x7c00);
+		}
+		else if (exponent <= 0)
+		{
+			// Subnormal or zero, shift the implicit bit in and round what falls off
+			if (exponent < -10)
+			{
+				half.Bits = (uint16_t)sign;
+			}
+			else
+			{
+				mantissa |= 0x800000;
+				uint32_t shift = (uint32_t)(14 - exponent);
+				uint32_t rounded = mantissa >> shift;
+				uint32_t remainder = mantissa & ((1u << shift) - 1);
+				uint32_t halfway = 1u << (shift - 1);
+				if (remainder > halfway || (remainder == halfway && (rounded & 1)))
+					rounded++;
+				half.Bits = (uint16_t)(sign | rounded);
+			}
+		}
+		else
+		{
+			uint32_t rounded = ((uint32_t)exponent << 10) | (mantissa >> 13);
+			uint32_t remainder = mantissa & 0x1fff;
+			if (remainder > 0x1000 || (remainder == 0x1000 && (rounded & 1)))
+				rounded++; // may carry into the exponent, up to infinity, which is right
+			half.Bits = (uint16_t)(sign | rounded);
+		}
+		return half;
+	}
+
+	inline float HalfToFloat(Half half)
+	{
+		uint32_t sign = (uint32_t)(half.Bits & 0x8000) << 16;
+		uint32_t exponent = (half.Bits >> 10) & 0x1f;
+		uint32_t mantissa = half.Bits & 0x3ff;
+
+		uint32_t bits;
+		if (exponent == 0x1f)
+		{
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else if (exponent == 0)
+		{
+			float value = std::ldexp((float)mantissa, -24);
+			return sign ? -value : value;
+		}
+		else
+		{
+			bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+		}
+
+		float value;
+		std::memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+
+	// Signed normalized integers with bits bits, e.g. 16 for GL_SHORT
+	inline int32_t FloatToSnorm(float value, unsigned int bits)
+	{
+		float maxValue = (float)((1 << (bits - 1)) - 1);
+		return (int32_t)std::round(std::min(std::max(value, -1.0f), 1.0f) * maxValue);
+	}
+
+	// GL 4.2 and later decode with max(c / max, -1), earlier versions with
+	// (2c + 1) / (2^bits - 1). Drivers below 4.2 may use either.
+	inline float SnormToFloat(int32_t value, unsigned int bits)
+	{
+		float maxValue = (float)((1 << (bits - 1)) - 1);
+		return std::max((float)value / maxValue, -1.0f);
+	}
+
+	inline float SnormToFloatLegacy(int32_t value, unsigned int bits)
+	{
+		return (2.0f * value + 1.0f) / (float)((1u << bits) - 1);
+	}
+
+	inline Packed1010102 PackSnorm1010102(float x, float y, float z, float w = 0.0f)
+	{
+		Packed1010102 packed;
+		packed.Bits = ((uint32_t)FloatToSnorm(x, 10) & 0x3ff) | (((uint32_t)FloatToSnorm(y, 10) & 0x3ff) << 10) |
+			(((uint32_t)FloatToSnorm(z, 10) & 0x3ff) << 20) | (((uint32_t)FloatToSnorm(w, 2) & 0x3) << 30);
+		return packed;
+	}
+
+	// Sign extends component index (0 = x, 3 = w) of a packed value
+	inline int32_t UnpackComponent1010102(Packed1010102 packed, unsigned int component)
+	{
+		unsigned int bits = component == 3 ? 2 : 10;
+		uint32_t raw = (packed.Bits >> (component * 10)) & ((1u << bits) - 1);
+		return (int32_t)(raw << (32 - bits)) >> (32 - bits);
+	}
+
+}
@@ -0,0 +1,71 @@
+#include "Test.h"
+
+#include "RenderThread.h"
+#include "Texture.h"
+
+#include <cmath>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	void CreateTestTextures(std::vector<std::unique_ptr<Texture>>& textures, int count, int size, bool checkered)
+	{
+		textures.push_back(std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg"));
+
+		std::vector<unsigned int> pixels(size * size);
+		for (int i = 1; i < count; i++)
+		{
+			unsigned int color = 0xff000000 | ((i * 53 % 256) << 16) | ((i * 97 % 256) << 8) | (i * 193 % 256);
+			for (int p = 0; p < size * size; p++)
+				pixels[p] = (!checkered || (p / size + p % size) % 2) ? color : 0xffffffff;
+
+			textures.push_back(std::make_unique<Texture>(size, size));
+			textures.back()->SetData(pixels.data(), (unsigned int)(pixels.size() * sizeof(unsigned int)));
+		}
+	}
+
+	glm::vec2 SweepCamera(const glm::vec2& worldSize, float time, const glm::vec2& frequency)
+	{
+		return glm::vec2((worldSize.x - 960.0f) * 0.5f * (1.0f + std::sin(time * frequency.x)),
+			(worldSize.y - 540.0f) * 0.5f * (1.0f + std::cos(time * frequency.y)));
+	}
+
+	void MoveBouncing(glm::vec2& position, glm::vec2& velocity, const glm::vec2& worldSize, float deltaTime)
+	{
+		position += velocity * deltaTime;
+		if (position.x < 0.0f || position.x > worldSize.x)
+			velocity.x = -velocity.x;
+		if (position.y < 0.0f || position.y > worldSize.y)
+			velocity.y = -velocity.y;
+	}
+
+	TestMenu::TestMenu(Test*& currentTestPointer, RenderThread& renderThread)
+		: m_CurrentTest(currentTestPointer), m_RenderThread(renderThread)
+	{
+	}
+
+	void TestMenu::OnImGuiRender()
+	{
+		for (auto& test : m_Tests)
+		{
+			// Tests create GL resources in their constructor
+			if (ImGui::Button(test.first.c_str()))
+				m_RenderThread.Call([&]() { m_CurrentTest = test.second(); });
+		}
+	}
+
+	bool TestMenu::StartTest(const std::string& name)
+	{
+		for (auto& test : m_Tests)
+		{
+			if (test.first == name)
+			{
+				m_RenderThread.Call([&]() { m_CurrentTest = test.second(); });
+				return true;
+			}
+		}
+		return false;
+	}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class RenderThread;
+class Texture;
+
+namespace test {
+
+	// Fixtures shared by the scenes below. The view is the 960x540 window.
+
+	// The wood texture followed by count - 1 generated size x size textures,
+	// each a colour of its own, checkered with white when asked to
+	void CreateTestTextures(std::vector<std::unique_ptr<Texture>>& textures, int count, int size, bool checkered = false);
+
+	// Where the view starts at time, sweeping over a world larger than the window
+	// at the given frequencies along x and y
+	glm::vec2 SweepCamera(const glm::vec2& worldSize, float time, const glm::vec2& frequency);
+
+	// Moves an object along its velocity, bouncing it off the edges of the world
+	void MoveBouncing(glm::vec2& position, glm::vec2& velocity, const glm::vec2& worldSize, float deltaTime);
+
+	class Test
+	{
+	public:
+		Test() {}
+		virtual ~Test() {}
+
+		// OnUpdate and OnImGuiRender run on the main thread, OnRender and the constructor
+		// and destructor on the thread that owns the GL context
+		virtual void OnUpdate(float deltaTime) {}
+		virtual void OnRender() {}
+		virtual void OnImGuiRender() {}
+	};
+
+	class TestMenu : public Test
+	{
+	private:
+		Test*& m_CurrentTest;
+		RenderThread& m_RenderThread;
+		std::vector<std::pair<std::string, std::function<Test*()>>> m_Tests;
+
+	public:
+		TestMenu(Test*& currentTestPointer, RenderThread& renderThread);
+
+		void OnImGuiRender() override;
+
+		// Switches to the test registered under name, for picking one from the command line
+		bool StartTest(const std::string& name);
+
+		template<typename T>
+		void RegisterTest(const std::string& name)
+		{
+			m_Tests.push_back(std::make_pair(name, []() { return new T(); }));
+		}
+	};
+
+}
@@ -0,0 +1,132 @@
+#include "TestAsyncTextures.h"
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestAsyncTextures::TestAsyncTextures()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
+		  m_TextureCount(64), m_BudgetMB(4), m_Async(true),
+		  m_LoadRequest(0), m_LoadedRequest(0), m_WaitRequest(0), m_WaitedRequest(0),
+		  m_LoadStart(Clock::now()), m_LastRender(Clock::now()),
+		  m_LoadCallMs(0.0f), m_LoadTotalMs(0.0f), m_LongestFrameMs(0.0f), m_LastLoaded(0)
+	{
+		float positions[] = {
+			0.0f, 0.0f, 0.0f, 0.0f,
+			1.0f, 0.0f, 1.0f, 0.0f,
+			1.0f, 1.0f, 1.0f, 1.0f,
+			0.0f, 1.0f, 0.0f, 1.0f
+		};
+
+		unsigned int indices[] = {
+			0, 1, 2, 2, 3, 0
+		};
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VertexBuffer = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices, 6);
+
+		m_Shader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+	}
+
+	TestAsyncTextures::~TestAsyncTextures()
+	{
+	}
+
+	void TestAsyncTextures::LoadTextures()
+	{
+		m_Textures.clear();
+		TextureLoader::SetUploadBudget((size_t)m_BudgetMB * 1024 * 1024);
+
+		// Every texture is decoded on its own, as distinct files would be
+		m_LoadStart = Clock::now();
+		for (int i = 0; i < m_TextureCount; i++)
+		{
+			m_Textures.push_back(std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg",
+				m_Async ? TextureLoading::Async : TextureLoading::Immediate));
+		}
+		m_LoadCallMs = std::chrono::duration<float, std::milli>(Clock::now() - m_LoadStart).count();
+		m_LoadTotalMs = 0.0f;
+		m_LongestFrameMs = 0.0f;
+	}
+
+	void TestAsyncTextures::OnRender()
+	{
+		// The gap between two renders is the frame, loading in between included
+		Clock::time_point now = Clock::now();
+		float frameMs = std::chrono::duration<float, std::milli>(now - m_LastRender).count();
+
+		if (m_LoadedRequest != m_LoadRequest)
+		{
+			m_LoadedRequest = m_LoadRequest;
+			LoadTextures();
+		}
+		else if (!m_Textures.empty())
+		{
+			m_LongestFrameMs = std::max(m_LongestFrameMs, frameMs);
+		}
+
+		if (m_WaitedRequest != m_WaitRequest)
+		{
+			m_WaitedRequest = m_WaitRequest;
+			for (const std::unique_ptr<Texture>& texture : m_Textures)
+				texture->WaitUntilLoaded();
+		}
+
+		unsigned int loaded = 0;
+		for (const std::unique_ptr<Texture>& texture : m_Textures)
+			loaded += texture->IsLoaded();
+		if (loaded == m_Textures.size() && loaded > 0 && m_LoadTotalMs == 0.0f)
+			m_LoadTotalMs = std::chrono::duration<float, std::milli>(Clock::now() - m_LoadStart).count();
+		m_LastLoaded = loaded;
+		m_LastStats = TextureLoader::GetStats();
+
+		Renderer renderer;
+		int columns = (int)std::ceil(std::sqrt((float)std::max<size_t>(m_Textures.size(), 1)));
+		float size = std::min(960.0f, 540.0f) / columns;
+		for (size_t i = 0; i < m_Textures.size(); i++)
+		{
+			glm::vec3 position((i % columns) * size, (i / columns) * size, 0.0f);
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size * 0.95f, size * 0.95f, 1.0f));
+
+			m_Textures[i]->Bind();
+			m_Shader->Bind();
+			m_Shader->SetUniformMat4f("u_MVP", m_Proj * model);
+			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+		}
+
+		m_LastRender = Clock::now();
+	}
+
+	void TestAsyncTextures::OnImGuiRender()
+	{
+		ImGui::SliderInt("Textures", &m_TextureCount, 1, 256);
+		ImGui::SliderInt("Upload MB per frame", &m_BudgetMB, 1, 64);
+		ImGui::Checkbox("Async", &m_Async);
+		if (ImGui::Button("Load"))
+			m_LoadRequest++;
+		ImGui::SameLine();
+		if (ImGui::Button("Wait for all"))
+			m_WaitRequest++;
+
+		ImGui::Text("Loaded %u, decoding %u, uploading %u", m_LastLoaded, m_LastStats.Decoding, m_LastStats.Uploading);
+		ImGui::Text("Uploaded last frame: %.2f MB", m_LastStats.BytesUploaded / (1024.0f * 1024.0f));
+		ImGui::Text("Creating the textures took %.2f ms, all loaded after %.1f ms", m_LoadCallMs, m_LoadTotalMs);
+		ImGui::Text("Longest frame since: %.2f ms", std::max(m_LongestFrameMs, m_LoadCallMs));
+	}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Test.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+
+namespace test {
+
+	// Loads a level's worth of textures at once, either the old way in the
+	// frame that asks for them or through TextureLoader, and draws them as a
+	// grid of quads. The longest frame since loading shows the hitch.
+	class TestAsyncTextures : public Test
+	{
+	private:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		glm::mat4 m_Proj;
+
+		int m_TextureCount;
+		int m_BudgetMB;
+		bool m_Async;
+		unsigned int m_LoadRequest;
+		unsigned int m_LoadedRequest;
+		unsigned int m_WaitRequest;
+		unsigned int m_WaitedRequest;
+
+		// Measured on the GL thread, read by the UI
+		Clock::time_point m_LoadStart;
+		Clock::time_point m_LastRender;
+		float m_LoadCallMs;
+		float m_LoadTotalMs;
+		float m_LongestFrameMs;
+		unsigned int m_LastLoaded;
+		TextureLoader::Stats m_LastStats;
+
+		void LoadTextures();
+
+	public:
+		TestAsyncTextures();
+		~TestAsyncTextures();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,235 @@
+#include "TestBatchRenderer.h"
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	static const int s_SweepWarmupFrames = 10;
+	static const int s_SweepMeasureFrames = 60;
+	// One draw per sprite gets very slow, so the sweep stops the unbatched path here
+	static const int s_SweepUnbatchedLimit = 20000;
+
+	TestBatchRenderer::TestBatchRenderer()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
+		  m_SpriteCount(10000), m_TextureCount(8), m_UseBatching(true),
+		  m_LastDrawCalls(0), m_LastFrameTime(0.0f), m_LastSubmitTime(0.0f),
+		  m_SweepFrame(0), m_SweepFrameTime(0.0f), m_SweepSubmitTime(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer2D>();
+
+		// The wood texture plus small generated textures, enough to overflow the texture slots
+		CreateTestTextures(m_Textures, 64, 8, true);
+
+		float positions[] = {
+			0.0f, 0.0f, 0.0f, 0.0f,
+			1.0f, 0.0f, 1.0f, 0.0f,
+			1.0f, 1.0f, 1.0f, 1.0f,
+			0.0f, 1.0f, 0.0f, 1.0f
+		};
+
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		m_QuadVAO = std::make_unique<VertexArray>();
+		m_QuadVertexBuffer = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_QuadVAO->AddBuffer(*m_QuadVertexBuffer, layout);
+
+		m_QuadIndexBuffer = std::make_unique<IndexBuffer>(indices, 6);
+
+		m_QuadShader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader");
+		m_QuadShader->Bind();
+		m_QuadShader->SetUniform1i("u_Texture", 0);
+	}
+
+	TestBatchRenderer::~TestBatchRenderer()
+	{
+	}
+
+	glm::vec4 TestBatchRenderer::GetSpriteColor(int index) const
+	{
+		float t = (float)index / (float)m_SpriteCount;
+		return { t, 0.4f, 1.0f - t, 1.0f };
+	}
+
+	void TestBatchRenderer::RenderBatched()
+	{
+		// Lay the sprites out on a grid that fills the window
+		int columns = (int)std::ceil(std::sqrt(m_SpriteCount * 960.0f / 540.0f));
+		float size = 960.0f / columns;
+
+		m_BatchRenderer->BeginScene(m_Proj);
+		for (int i = 0; i < m_SpriteCount; i++)
+		{
+			glm::vec2 position((i % columns) * size, (i / columns) * size);
+			if (m_TextureCount == 0)
+				m_BatchRenderer->DrawQuad(position, glm::vec2(size), GetSpriteColor(i));
+			else
+				m_BatchRenderer->DrawQuad(position, glm::vec2(size), *m_Textures[i % m_TextureCount], GetSpriteColor(i));
+		}
+		m_BatchRenderer->EndScene();
+
+		m_LastDrawCalls = m_BatchRenderer->GetStats().DrawCalls;
+	}
+
+	void TestBatchRenderer::RenderUnbatched()
+	{
+		Renderer renderer;
+
+		int columns = (int)std::ceil(std::sqrt(m_SpriteCount * 960.0f / 540.0f));
+		float size = 960.0f / columns;
+
+		m_QuadShader->Bind();
+		for (int i = 0; i < m_SpriteCount; i++)
+		{
+			glm::vec3 position((i % columns) * size, (i / columns) * size, 0.0f);
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size, size, 1.0f));
+
+			m_Textures[m_TextureCount == 0 ? 0 : i % m_TextureCount]->Bind();
+			m_QuadShader->SetUniformMat4f("u_MVP", m_Proj * model);
+			renderer.Draw(*m_QuadVAO, *m_QuadIndexBuffer, *m_QuadShader);
+		}
+
+		m_LastDrawCalls = m_SpriteCount;
+	}
+
+	void TestBatchRenderer::StartSweep()
+	{
+		const int counts[] = { 1000, 5000, 10000, 25000, 50000, 100000 };
+
+		m_SweepResults.clear();
+		m_SweepQueue.clear();
+		for (int count : counts)
+		{
+			m_SweepQueue.push_back({ count, true, 0, 0.0f, 0.0f });
+			if (count <= s_SweepUnbatchedLimit)
+				m_SweepQueue.push_back({ count, false, 0, 0.0f, 0.0f });
+		}
+
+		// Run the queue back to front
+		std::reverse(m_SweepQueue.begin(), m_SweepQueue.end());
+		m_SweepFrame = 0;
+		m_SweepFrameTime = 0.0f;
+		m_SweepSubmitTime = 0.0f;
+	}
+
+	void TestBatchRenderer::UpdateSweep(float deltaTime)
+	{
+		if (m_SweepQueue.empty())
+			return;
+
+		SweepResult& current = m_SweepQueue.back();
+		m_SpriteCount = current.SpriteCount;
+		m_UseBatching = current.Batched;
+
+		// The first frame after a switch has not been rendered with the new settings yet
+		if (m_SweepFrame > s_SweepWarmupFrames)
+		{
+			m_SweepFrameTime += deltaTime;
+			m_SweepSubmitTime += m_LastSubmitTime;
+		}
+
+		if (++m_SweepFrame <= s_SweepWarmupFrames + s_SweepMeasureFrames)
+			return;
+
+		current.DrawCalls = m_LastDrawCalls;
+		current.FrameTimeMs = m_SweepFrameTime * 1000.0f / s_SweepMeasureFrames;
+		current.SubmitTimeMs = m_SweepSubmitTime / s_SweepMeasureFrames;
+		m_SweepResults.push_back(current);
+		m_SweepQueue.pop_back();
+
+		m_SweepFrame = 0;
+		m_SweepFrameTime = 0.0f;
+		m_SweepSubmitTime = 0.0f;
+
+		if (m_SweepQueue.empty())
+		{
+			std::cout << "Sprites\tMode\tDraw calls\tFrame (ms)\tSubmit (ms)" << std::endl;
+			for (const SweepResult& result : m_SweepResults)
+			{
+				std::cout << result.SpriteCount << "\t" << (result.Batched ? "batched" : "unbatched") << "\t"
+					<< result.DrawCalls << "\t" << result.FrameTimeMs << "\t" << result.SubmitTimeMs << std::endl;
+			}
+		}
+	}
+
+	void TestBatchRenderer::OnUpdate(float deltaTime)
+	{
+		m_LastFrameTime = deltaTime * 1000.0f;
+		UpdateSweep(deltaTime);
+	}
+
+	void TestBatchRenderer::OnRender()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_BatchRenderer->ResetStats();
+		if (m_UseBatching)
+			RenderBatched();
+		else
+			RenderUnbatched();
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_LastSubmitTime = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestBatchRenderer::OnImGuiRender()
+	{
+		bool sweeping = !m_SweepQueue.empty();
+
+		if (sweeping)
+			ImGui::BeginDisabled();
+		ImGui::SliderInt("Sprites", &m_SpriteCount, 1, 100000);
+		ImGui::SliderInt("Textures", &m_TextureCount, 0, (int)m_Textures.size());
+		ImGui::Checkbox("Batching", &m_UseBatching);
+		if (ImGui::Button("Run sweep"))
+			StartSweep();
+		if (sweeping)
+			ImGui::EndDisabled();
+
+		ImGui::Text("Draw calls: %u", m_LastDrawCalls);
+		ImGui::Text("Frame: %.3f ms, CPU submit: %.3f ms", m_LastFrameTime, m_LastSubmitTime);
+		if (m_UseBatching)
+		{
+			const BatchRenderer2D::Stats& stats = m_BatchRenderer->GetStats();
+			ImGui::Text("Quads: %u, texture slots: %u/%u", stats.QuadCount, stats.TextureSlotsUsed, m_BatchRenderer->GetTextureSlotCount());
+			ImGui::Text("Vertex stream: %s, stalls: %u", StreamBuffer::SupportsPersistentMapping() ? "persistent" : "orphaning", stats.StreamStalls);
+		}
+
+		if (sweeping)
+			ImGui::Text("Sweeping... %d points left", (int)m_SweepQueue.size());
+
+		if (!m_SweepResults.empty() && ImGui::BeginTable("Sweep", 5, ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("Sprites");
+			ImGui::TableSetupColumn("Mode");
+			ImGui::TableSetupColumn("Draw calls");
+			ImGui::TableSetupColumn("Frame (ms)");
+			ImGui::TableSetupColumn("Submit (ms)");
+			ImGui::TableHeadersRow();
+
+			for (const SweepResult& result : m_SweepResults)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::Text("%d", result.SpriteCount);
+				ImGui::TableNextColumn(); ImGui::TextUnformatted(result.Batched ? "batched" : "unbatched");
+				ImGui::TableNextColumn(); ImGui::Text("%u", result.DrawCalls);
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", result.FrameTimeMs);
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", result.SubmitTimeMs);
+			}
+			ImGui::EndTable();
+		}
+	}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BatchRenderer2D.h"
+
+namespace test {
+
+	// Draws a grid of sprites either through BatchRenderer2D or with one
+	// Renderer::Draw per sprite, and can sweep sprite counts to report how
+	// draw calls and frame time scale in both modes.
+	class TestBatchRenderer : public Test
+	{
+	private:
+		struct SweepResult
+		{
+			int SpriteCount;
+			bool Batched;
+			unsigned int DrawCalls;
+			float FrameTimeMs;
+			float SubmitTimeMs;
+		};
+
+		std::unique_ptr<BatchRenderer2D> m_BatchRenderer;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+
+		// Resources for the unbatched path
+		std::unique_ptr<VertexArray> m_QuadVAO;
+		std::unique_ptr<VertexBuffer> m_QuadVertexBuffer;
+		std::unique_ptr<IndexBuffer> m_QuadIndexBuffer;
+		std::unique_ptr<Shader> m_QuadShader;
+
+		glm::mat4 m_Proj;
+
+		int m_SpriteCount;
+		int m_TextureCount;
+		bool m_UseBatching;
+
+		unsigned int m_LastDrawCalls;
+		float m_LastFrameTime;
+		float m_LastSubmitTime;
+
+		// Sweep state, each point warms up and then averages over a fixed number of frames
+		std::vector<SweepResult> m_SweepResults;
+		std::vector<SweepResult> m_SweepQueue;
+		int m_SweepFrame;
+		float m_SweepFrameTime;
+		float m_SweepSubmitTime;
+
+		void RenderBatched();
+		void RenderUnbatched();
+		void StartSweep();
+		void UpdateSweep(float deltaTime);
+		glm::vec4 GetSpriteColor(int index) const;
+
+	public:
+		TestBatchRenderer();
+		~TestBatchRenderer();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,126 @@
+#include "TestInstancing.h"
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include <chrono>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestInstancing::TestInstancing()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Time(0.0f),
+		  m_InstanceCount(10000), m_Instanced(true), m_LastDrawCalls(0), m_LastSubmitTime(0.0f)
+	{
+		float positions[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f
+		};
+
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		m_VAO = std::make_unique<VertexArray>();
+
+		m_VertexBuffer = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+
+		// Locations 2-5 are the model matrix columns, 6 the color
+		m_InstanceBuffer = std::make_unique<VertexBuffer>(s_MaxInstances * (unsigned int)sizeof(InstanceData), BufferUsage::Stream);
+		VertexBufferLayout instanceLayout;
+		instanceLayout.SetDivisor(1);
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		m_VAO->AddBuffer(*m_InstanceBuffer, instanceLayout);
+
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices, 6);
+
+		m_InstancedShader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Instanced.shader");
+		m_InstancedShader->Bind();
+		m_InstancedShader->SetUniform1i("u_Texture", 0);
+
+		m_BasicShader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader");
+		m_BasicShader->Bind();
+		m_BasicShader->SetUniform1i("u_Texture", 0);
+
+		m_Texture = std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg");
+	}
+
+	TestInstancing::~TestInstancing()
+	{
+	}
+
+	void TestInstancing::UpdateInstances()
+	{
+		int columns = (int)std::ceil(std::sqrt(m_InstanceCount * 960.0f / 540.0f));
+		float size = 960.0f / columns;
+
+		m_Instances.resize(m_InstanceCount);
+		for (int i = 0; i < m_InstanceCount; i++)
+		{
+			glm::vec3 position((i % columns + 0.5f) * size, (i / columns + 0.5f) * size, 0.0f);
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+			model = glm::rotate(model, m_Time + i * 0.01f, glm::vec3(0.0f, 0.0f, 1.0f));
+			model = glm::scale(model, glm::vec3(size * 0.8f, size * 0.8f, 1.0f));
+
+			float t = (float)i / (float)m_InstanceCount;
+			m_Instances[i] = { model, glm::vec4(t, 0.5f, 1.0f - t, 1.0f) };
+		}
+	}
+
+	void TestInstancing::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+		UpdateInstances();
+	}
+
+	void TestInstancing::OnRender()
+	{
+		Renderer renderer;
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_Texture->Bind();
+		if (m_Instanced)
+		{
+			m_InstanceBuffer->SetData(m_Instances.data(), (unsigned int)(m_Instances.size() * sizeof(InstanceData)));
+
+			m_InstancedShader->Bind();
+			m_InstancedShader->SetUniformMat4f("u_ViewProjection", m_Proj);
+			renderer.DrawInstanced(*m_VAO, *m_IndexBuffer, *m_InstancedShader, m_InstanceCount);
+			m_LastDrawCalls = 1;
+		}
+		else
+		{
+			m_BasicShader->Bind();
+			for (const InstanceData& instance : m_Instances)
+			{
+				m_BasicShader->SetUniformMat4f("u_MVP", m_Proj * instance.Model);
+				renderer.Draw(*m_VAO, *m_IndexBuffer, *m_BasicShader);
+			}
+			m_LastDrawCalls = m_InstanceCount;
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_LastSubmitTime = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestInstancing::OnImGuiRender()
+	{
+		ImGui::SliderInt("Instances", &m_InstanceCount, 1, s_MaxInstances);
+		ImGui::Checkbox("Instanced", &m_Instanced);
+		ImGui::Text("Draw calls: %u, CPU submit: %.3f ms", m_LastDrawCalls, m_LastSubmitTime);
+	}
+
+}
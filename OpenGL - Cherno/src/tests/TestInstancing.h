@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+namespace test {
+
+	// Draws the same quad many times, either with one DrawInstanced call fed by a
+	// per-instance vertex buffer or with one Draw and u_MVP upload per copy.
+	class TestInstancing : public Test
+	{
+	private:
+		struct InstanceData
+		{
+			glm::mat4 Model;
+			glm::vec4 Color;
+		};
+
+		static const int s_MaxInstances = 100000;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<VertexBuffer> m_InstanceBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_InstancedShader;
+		std::unique_ptr<Shader> m_BasicShader;
+		std::unique_ptr<Texture> m_Texture;
+
+		std::vector<InstanceData> m_Instances;
+
+		glm::mat4 m_Proj;
+		float m_Time;
+		int m_InstanceCount;
+		bool m_Instanced;
+
+		unsigned int m_LastDrawCalls;
+		float m_LastSubmitTime;
+
+		void UpdateInstances();
+
+	public:
+		TestInstancing();
+		~TestInstancing();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,193 @@
+#include "TestMeshImporter.h"
+
+#include "Renderer.h"
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestMeshImporter::TestMeshImporter()
+		: m_Fit(1.0f), m_LastLoadFailed(false), m_LoadRequest(0), m_LoadedRequest(0), m_Time(0.0f)
+	{
+		std::strcpy(m_Path, "OpenGL - Cherno/res/meshes/Cube.obj");
+
+		m_Shader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+		m_Texture = std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg");
+
+		Load(m_Path);
+	}
+
+	TestMeshImporter::~TestMeshImporter()
+	{
+	}
+
+	void TestMeshImporter::FitToView(const void* vertices, unsigned int vertexCount, unsigned int stride)
+	{
+		// Positions are the first attribute, three floats
+		glm::vec3 min(0.0f), max(0.0f);
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			glm::vec3 position;
+			std::memcpy(&position.x, (const unsigned char*)vertices + (size_t)v * stride, sizeof(float) * 3);
+			min = v == 0 ? position : glm::min(min, position);
+			max = v == 0 ? position : glm::max(max, position);
+		}
+		float size = std::max(glm::length(max - min), 1e-6f);
+		m_Fit = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f / size)) * glm::translate(glm::mat4(1.0f), -(min + max) * 0.5f);
+	}
+
+	void TestMeshImporter::Load(const std::string& path)
+	{
+		if (path.size() > 5 && path.compare(path.size() - 5, 5, ".mesh") == 0)
+		{
+			LoadMeshFile(path);
+			return;
+		}
+
+		// Basic.shader reads the position from location 0 and the texture coordinate from 1
+		MeshImporter::Mesh mesh;
+		m_LastLoadFailed = !MeshImporter::Load(path, { MeshImporter::Attribute::Position, MeshImporter::Attribute::TexCoord }, mesh);
+		if (m_LastLoadFailed || mesh.Indices.empty())
+		{
+			m_LastLoadFailed = true;
+			return;
+		}
+
+		FitToView(mesh.Vertices.data(), mesh.VertexCount, mesh.Layout.GetStride());
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = std::make_unique<VertexBuffer>(mesh.Vertices.data(), (unsigned int)(mesh.Vertices.size() * sizeof(float)));
+		m_VAO->AddBuffer(*m_VBO, mesh.Layout);
+		m_IBO = std::make_unique<IndexBuffer>(mesh.Indices.data(), (unsigned int)mesh.Indices.size());
+
+		m_LastStats = mesh.LoadStats;
+		m_Submeshes = mesh.Submeshes;
+	}
+
+	void TestMeshImporter::LoadMeshFile(const std::string& path)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		MeshFile file;
+		m_LastLoadFailed = !file.Open(path) || file.GetIndexCount() == 0;
+		if (m_LastLoadFailed)
+			return;
+
+		// Basic.shader takes a position and a texture coordinate, in any attribute type
+		auto elements = file.GetLayout().GetElements();
+		if (elements.size() != 2 || elements[0].count < 3 || elements[1].count != 2)
+		{
+			std::cout << "Cannot show " << path << ", convert it with position,texcoord" << std::endl;
+			m_LastLoadFailed = true;
+			return;
+		}
+
+		const VertexBufferElement& position = elements[0];
+		if (position.type == GL_FLOAT && position.count >= 3)
+			FitToView(file.GetVertexData(), file.GetVertexCount(), file.GetLayout().GetStride());
+		else
+			m_Fit = glm::mat4(1.0f);
+
+		// The buffers are filled straight from the mapping, the file can go right after
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = file.CreateVertexBuffer();
+		m_VAO->AddBuffer(*m_VBO, file.GetLayout());
+		m_IBO = file.CreateIndexBuffer();
+
+		m_LastStats = MeshImporter::Stats();
+		m_LastStats.FileBytes = file.GetFileSize();
+		m_LastStats.Triangles = file.GetIndexCount() / 3;
+		m_LastStats.SourceVertices = m_LastStats.Vertices = file.GetVertexCount();
+		m_LastStats.Threads = 1;
+		m_LastStats.TotalMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		m_Submeshes.clear();
+		for (unsigned int i = 0; i < file.GetSubmeshCount(); i++)
+			m_Submeshes.push_back({ file.GetSubmeshes()[i].Name, file.GetSubmeshes()[i].FirstIndex, file.GetSubmeshes()[i].IndexCount });
+	}
+
+	void TestMeshImporter::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+	}
+
+	void TestMeshImporter::OnRender()
+	{
+		// Loading creates buffers, so it happens here on the GL thread
+		if (m_LoadedRequest != m_LoadRequest)
+		{
+			m_LoadedRequest = m_LoadRequest;
+			Load(m_RequestedPath);
+		}
+
+		if (!m_VAO)
+			return;
+
+		Renderer renderer;
+		glm::mat4 proj = glm::perspective(glm::radians(45.0f), 960.0f / 540.0f, 0.1f, 10.0f);
+		glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+		glm::mat4 model = glm::rotate(glm::mat4(1.0f), m_Time * 0.5f, glm::vec3(0.3f, 1.0f, 0.2f)) * m_Fit;
+
+		GLCall(glEnable(GL_DEPTH_TEST));
+		GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+
+		m_Texture->Bind();
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4f("u_MVP", proj * view * model);
+		renderer.Draw(*m_VAO, *m_IBO, *m_Shader);
+
+		GLCall(glDisable(GL_DEPTH_TEST));
+	}
+
+	void TestMeshImporter::OnImGuiRender()
+	{
+		ImGui::InputText("File", m_Path, sizeof(m_Path));
+		if (ImGui::Button("Load"))
+		{
+			m_RequestedPath = m_Path;
+			m_LoadRequest++;
+		}
+		ImGui::SameLine();
+		// Faces pointing past the vertex list, loading must fail instead of reading past it
+		if (ImGui::Button("Load malformed OBJ"))
+		{
+			m_RequestedPath = "OpenGL - Cherno/res/meshes/Malformed.obj";
+			m_LoadRequest++;
+		}
+
+		if (m_LastLoadFailed)
+			ImGui::Text("Loading failed, see the console");
+
+		const MeshImporter::Stats& stats = m_LastStats;
+		ImGui::Text("%u triangles, %u vertices from %u (%.1f KB)", stats.Triangles, stats.Vertices, stats.SourceVertices, stats.FileBytes / 1024.0f);
+		ImGui::Text("Read %.2f ms, parse %.2f ms, merge %.2f ms on %u threads, %.2f ms in all", stats.ReadMs, stats.ParseMs, stats.DeduplicateMs, stats.Threads, stats.TotalMs);
+		ImGui::Text("%.1f MB/s, %.2f M triangles/s", stats.GetMegabytesPerSecond(), stats.GetTrianglesPerSecond() / 1e6f);
+
+		if (!m_Submeshes.empty() && ImGui::BeginTable("Submeshes", 3, ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("Submesh");
+			ImGui::TableSetupColumn("First index");
+			ImGui::TableSetupColumn("Triangles");
+			ImGui::TableHeadersRow();
+
+			for (const MeshImporter::Submesh& submesh : m_Submeshes)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::TextUnformatted(submesh.Name.empty() ? "(unnamed)" : submesh.Name.c_str());
+				ImGui::TableNextColumn(); ImGui::Text("%u", submesh.FirstIndex);
+				ImGui::TableNextColumn(); ImGui::Text("%u", submesh.IndexCount / 3);
+			}
+			ImGui::EndTable();
+		}
+	}
+
+}
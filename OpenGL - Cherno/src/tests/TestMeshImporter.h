@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "MeshImporter.h"
+
+namespace test {
+
+	// Loads an OBJ or glTF file through MeshImporter, or a mesh file through
+	// MeshFile, and spins it in front of the camera with the basic textured
+	// shader. Shows how long each load step took and what merging identical
+	// vertices saved. Mesh files should be converted with position,texcoord.
+	class TestMeshImporter : public Test
+	{
+	private:
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+
+		// Scales and centers the mesh into view
+		glm::mat4 m_Fit;
+		MeshImporter::Stats m_LastStats;
+		std::vector<MeshImporter::Submesh> m_Submeshes;
+		bool m_LastLoadFailed;
+
+		char m_Path[256];
+		std::string m_RequestedPath;
+		unsigned int m_LoadRequest;
+		unsigned int m_LoadedRequest;
+		float m_Time;
+
+		void Load(const std::string& path);
+		void LoadMeshFile(const std::string& path);
+		void FitToView(const void* vertices, unsigned int vertexCount, unsigned int stride);
+
+	public:
+		TestMeshImporter();
+		~TestMeshImporter();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
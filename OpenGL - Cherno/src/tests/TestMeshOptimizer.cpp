@@ -0,0 +1,204 @@
+#include "TestMeshOptimizer.h"
+
+#include "Renderer.h"
+#include "GPUProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestMeshOptimizer::TestMeshOptimizer()
+		: m_OptimizeTime(0.0f), m_PositionError(0.0f), m_TexCoordError(0.0f), m_Time(0.0f), m_GridSize(4),
+		m_UseOptimized(true), m_UseCompact(false)
+	{
+		// (2, 3) torus knot, it folds over itself so draw order matters for overdraw
+		const unsigned int tubular = 1024, radial = 32;
+		const float tubeRadius = 0.4f;
+		auto knot = [](float t) {
+			float r = 2.0f + std::cos(3.0f * t);
+			return glm::vec3(r * std::cos(2.0f * t), r * std::sin(2.0f * t), -std::sin(3.0f * t));
+		};
+
+		std::vector<Vertex> vertices;
+		for (unsigned int i = 0; i <= tubular; i++)
+		{
+			float t = (float)i / tubular * 2.0f * 3.14159265f;
+			glm::vec3 p1 = knot(t), p2 = knot(t + 0.01f);
+			glm::vec3 tangent = p2 - p1;
+			glm::vec3 bitangent = glm::normalize(glm::cross(tangent, p2 + p1));
+			glm::vec3 normal = glm::normalize(glm::cross(bitangent, tangent));
+
+			for (unsigned int j = 0; j <= radial; j++)
+			{
+				float v = (float)j / radial * 2.0f * 3.14159265f;
+				glm::vec3 position = p1 + tubeRadius * (std::cos(v) * normal + std::sin(v) * bitangent);
+				vertices.push_back({ position, glm::vec2((float)i / tubular * 8.0f, (float)j / radial) });
+			}
+		}
+
+		std::vector<unsigned int> indices;
+		for (unsigned int i = 0; i < tubular; i++)
+		{
+			for (unsigned int j = 0; j < radial; j++)
+			{
+				unsigned int a = i * (radial + 1) + j, b = a + radial + 1;
+				indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+			}
+		}
+
+		// Scramble both orders, like a mesh that went through a few export steps
+		std::mt19937 rng(42);
+		unsigned int triangleCount = (unsigned int)indices.size() / 3;
+		std::vector<unsigned int> triangles(triangleCount), remap(vertices.size());
+		for (unsigned int i = 0; i < triangleCount; i++)
+			triangles[i] = i;
+		for (unsigned int i = 0; i < remap.size(); i++)
+			remap[i] = i;
+		std::shuffle(triangles.begin(), triangles.end(), rng);
+		std::shuffle(remap.begin(), remap.end(), rng);
+
+		std::vector<Vertex> shuffledVertices(vertices.size());
+		for (unsigned int i = 0; i < vertices.size(); i++)
+			shuffledVertices[remap[i]] = vertices[i];
+
+		std::vector<unsigned int> shuffledIndices;
+		shuffledIndices.reserve(indices.size());
+		for (unsigned int triangle : triangles)
+		{
+			for (unsigned int k = 0; k < 3; k++)
+				shuffledIndices.push_back(remap[indices[triangle * 3 + k]]);
+		}
+
+		CreateMesh(m_Original, shuffledVertices, shuffledIndices);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned int vertexCount = MeshOptimizer::Optimize(shuffledVertices.data(), (unsigned int)shuffledVertices.size(), sizeof(Vertex),
+			shuffledIndices.data(), (unsigned int)shuffledIndices.size());
+		m_OptimizeTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		shuffledVertices.resize(vertexCount);
+
+		CreateMesh(m_Optimized, shuffledVertices, shuffledIndices);
+
+		// Positions over the knot's bounds to within half a thousandth, texture coordinates as they are
+		MeshQuantizer::Result compact = MeshQuantizer::Quantize(&shuffledVertices[0].Position.x, vertexCount,
+			{ { 3, 0.0005f, true }, { 2, 0.002f, false } });
+		m_PositionError = compact.Attributes[0].Error;
+		m_TexCoordError = compact.Attributes[1].Error;
+
+		m_Compact.Cache = m_Optimized.Cache;
+		m_Compact.Fetch = MeshOptimizer::AnalyzeVertexFetch(shuffledIndices.data(), (unsigned int)shuffledIndices.size(), vertexCount, compact.GetStride());
+		m_Compact.Decode = compact.GetDecodeMatrix(0);
+		m_Compact.VertexSize = compact.GetStride();
+		m_Compact.VAO = std::make_unique<VertexArray>();
+		m_Compact.VBO = std::make_unique<VertexBuffer>(compact.Vertices.data(), (unsigned int)compact.Vertices.size());
+		m_Compact.VAO->AddBuffer(*m_Compact.VBO, compact.Layout);
+		m_Compact.IBO = std::make_unique<IndexBuffer>(shuffledIndices.data(), (unsigned int)shuffledIndices.size());
+
+		m_Shader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		m_Texture = std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg");
+	}
+
+	TestMeshOptimizer::~TestMeshOptimizer()
+	{
+	}
+
+	void TestMeshOptimizer::CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+	{
+		mesh.Cache = MeshOptimizer::AnalyzeVertexCache(indices.data(), (unsigned int)indices.size(), (unsigned int)vertices.size());
+		mesh.Fetch = MeshOptimizer::AnalyzeVertexFetch(indices.data(), (unsigned int)indices.size(), (unsigned int)vertices.size(), sizeof(Vertex));
+
+		mesh.VAO = std::make_unique<VertexArray>();
+		mesh.VBO = std::make_unique<VertexBuffer>(vertices.data(), (unsigned int)(vertices.size() * sizeof(Vertex)));
+		constexpr VertexBufferLayout layout = Vertex::GetLayout();
+		static_assert(layout.Matches(sizeof(Vertex), { offsetof(Vertex, Position), offsetof(Vertex, TexCoord) }), "Vertex layout does not match the struct");
+		mesh.VAO->AddBuffer(*mesh.VBO, layout);
+		mesh.IBO = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+	}
+
+	void TestMeshOptimizer::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+	}
+
+	void TestMeshOptimizer::OnRender()
+	{
+		Renderer renderer;
+		const Mesh& mesh = m_UseOptimized ? (m_UseCompact ? m_Compact : m_Optimized) : m_Original;
+
+		float spacing = 8.0f;
+		float extent = spacing * m_GridSize;
+		glm::mat4 proj = glm::perspective(glm::radians(45.0f), 960.0f / 540.0f, 0.1f, extent * 4.0f);
+		glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -extent * 1.2f));
+
+		GLCall(glEnable(GL_DEPTH_TEST));
+		GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+		m_Texture->Bind();
+
+		{
+			GPU_PROFILE_SCOPE("Mesh");
+			for (int y = 0; y < m_GridSize; y++)
+			{
+				for (int x = 0; x < m_GridSize; x++)
+				{
+					glm::vec3 offset((x - (m_GridSize - 1) * 0.5f) * spacing, (y - (m_GridSize - 1) * 0.5f) * spacing, 0.0f);
+					glm::mat4 model = glm::translate(glm::mat4(1.0f), offset);
+					model = glm::rotate(model, m_Time * 0.5f + x * 0.7f + y * 1.3f, glm::vec3(0.3f, 1.0f, 0.2f));
+
+					m_Shader->Bind();
+					m_Shader->SetUniformMat4f("u_MVP", proj * view * model * mesh.Decode);
+					renderer.Draw(*mesh.VAO, *mesh.IBO, *m_Shader);
+				}
+			}
+		}
+
+		GLCall(glDisable(GL_DEPTH_TEST));
+	}
+
+	void TestMeshOptimizer::OnImGuiRender()
+	{
+		ImGui::Checkbox("Optimized", &m_UseOptimized);
+		ImGui::SameLine();
+		ImGui::Checkbox("Compact vertices", &m_UseCompact);
+		ImGui::SliderInt("Grid", &m_GridSize, 1, 8);
+		ImGui::Text("%u triangles per mesh, optimized in %.1f ms", m_Original.Cache.Triangles, m_OptimizeTime);
+
+		if (ImGui::BeginTable("Stats", 3, ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("");
+			ImGui::TableSetupColumn("Original");
+			ImGui::TableSetupColumn("Optimized");
+			ImGui::TableHeadersRow();
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("ACMR");
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", m_Original.Cache.ACMR);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", m_Optimized.Cache.ACMR);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("ATVR");
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", m_Original.Cache.ATVR);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", m_Optimized.Cache.ATVR);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("Overfetch");
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", m_Original.Fetch.Overfetch);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", m_Optimized.Fetch.Overfetch);
+
+			ImGui::EndTable();
+		}
+
+		ImGui::Text("Vertex size: %u bytes, compact %u bytes", m_Optimized.VertexSize, m_Compact.VertexSize);
+		ImGui::Text("Compact error: position %.5f, texture coordinate %.5f", m_PositionError, m_TexCoordError);
+	}
+
+}
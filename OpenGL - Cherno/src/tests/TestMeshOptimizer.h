@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Test.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "MeshOptimizer.h"
+#include "MeshQuantizer.h"
+
+namespace test {
+
+	// Draws a grid of torus knots whose triangles and vertices come in random
+	// order, as straight out of a tool, or after MeshOptimizer ran over them.
+	// Compare the "Mesh" GPU profiler scope between the two.
+	class TestMeshOptimizer : public Test
+	{
+	private:
+		struct Vertex
+		{
+			glm::vec3 Position;
+			glm::vec2 TexCoord;
+
+			static constexpr VertexBufferLayout GetLayout()
+			{
+				return VertexBufferLayout::Create<decltype(Position), decltype(TexCoord)>();
+			}
+		};
+
+		struct Mesh
+		{
+			std::unique_ptr<VertexArray> VAO;
+			std::unique_ptr<VertexBuffer> VBO;
+			std::unique_ptr<IndexBuffer> IBO;
+			MeshOptimizer::VertexCacheStats Cache;
+			MeshOptimizer::VertexFetchStats Fetch;
+			// Decodes quantized positions, identity for float meshes
+			glm::mat4 Decode = glm::mat4(1.0f);
+			unsigned int VertexSize = sizeof(Vertex);
+		};
+
+		Mesh m_Original;
+		Mesh m_Optimized;
+		Mesh m_Compact;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+
+		float m_OptimizeTime;
+		float m_PositionError;
+		float m_TexCoordError;
+		float m_Time;
+		int m_GridSize;
+		bool m_UseOptimized;
+		bool m_UseCompact;
+
+		static void CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+	public:
+		TestMeshOptimizer();
+		~TestMeshOptimizer();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,126 @@
+#include "TestMultiDrawIndirect.h"
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include <chrono>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestMultiDrawIndirect::TestMultiDrawIndirect()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Time(0.0f),
+		  m_ObjectCount(2000), m_ForceFallback(false), m_LastSubmitTime(0.0f)
+	{
+		// Polygons with 3 to 8 sides, each as a triangle fan around its center
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		for (unsigned int sides = 3; sides <= 8; sides++)
+		{
+			MeshRange mesh;
+			mesh.FirstIndex = (unsigned int)indices.size();
+			mesh.BaseVertex = (int)(vertices.size() / 4);
+			mesh.IndexCount = sides * 3;
+
+			vertices.insert(vertices.end(), { 0.0f, 0.0f, 0.5f, 0.5f });
+			for (unsigned int i = 0; i < sides; i++)
+			{
+				float angle = 6.2831853f * i / sides;
+				float x = 0.5f * std::cos(angle), y = 0.5f * std::sin(angle);
+				vertices.insert(vertices.end(), { x, y, x + 0.5f, y + 0.5f });
+
+				// Indices are relative to the mesh, the base vertex places them in the shared buffer
+				indices.insert(indices.end(), { 0, i + 1, (i + 1) % sides + 1 });
+			}
+
+			m_Meshes.push_back(mesh);
+		}
+
+		m_VAO = std::make_unique<VertexArray>();
+
+		m_VertexBuffer = std::make_unique<VertexBuffer>(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+
+		m_InstanceBuffer = std::make_unique<VertexBuffer>(s_MaxObjects * (unsigned int)sizeof(InstanceData), BufferUsage::Stream);
+		VertexBufferLayout instanceLayout;
+		instanceLayout.SetDivisor(1);
+		for (int i = 0; i < 5; i++)
+			instanceLayout.Push<float>(4);
+		m_VAO->AddBuffer(*m_InstanceBuffer, instanceLayout);
+
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+		m_IndirectBuffer = std::make_unique<IndirectBuffer>(s_MaxObjects);
+
+		m_Shader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Instanced.shader");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		m_Texture = std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg");
+	}
+
+	TestMultiDrawIndirect::~TestMultiDrawIndirect()
+	{
+		Renderer::SetForceIndirectFallback(false);
+	}
+
+	void TestMultiDrawIndirect::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+
+		int columns = (int)std::ceil(std::sqrt(m_ObjectCount * 960.0f / 540.0f));
+		float size = 960.0f / columns;
+
+		m_Instances.resize(m_ObjectCount);
+		m_Commands.resize(m_ObjectCount);
+		for (int i = 0; i < m_ObjectCount; i++)
+		{
+			glm::vec3 position((i % columns + 0.5f) * size, (i / columns + 0.5f) * size, 0.0f);
+			glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), position), m_Time, glm::vec3(0.0f, 0.0f, 1.0f));
+			model = glm::scale(model, glm::vec3(size, size, 1.0f));
+
+			float t = (float)i / (float)m_ObjectCount;
+			m_Instances[i] = { model, glm::vec4(1.0f, t, 1.0f - t, 1.0f) };
+
+			const MeshRange& mesh = m_Meshes[i % m_Meshes.size()];
+			m_Commands[i] = { mesh.IndexCount, 1, mesh.FirstIndex, mesh.BaseVertex, (unsigned int)i };
+		}
+	}
+
+	void TestMultiDrawIndirect::OnRender()
+	{
+		Renderer renderer;
+		Renderer::SetForceIndirectFallback(m_ForceFallback);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_InstanceBuffer->SetData(m_Instances.data(), (unsigned int)(m_Instances.size() * sizeof(InstanceData)));
+		m_IndirectBuffer->SetData(m_Commands.data(), (unsigned int)m_Commands.size());
+
+		m_Texture->Bind();
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4f("u_ViewProjection", m_Proj);
+		renderer.MultiDrawIndirect(*m_VAO, *m_IndexBuffer, *m_Shader, *m_IndirectBuffer);
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_LastSubmitTime = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestMultiDrawIndirect::OnImGuiRender()
+	{
+		ImGui::SliderInt("Objects", &m_ObjectCount, 1, s_MaxObjects);
+		ImGui::Checkbox("Force fallback", &m_ForceFallback);
+
+		bool native = Renderer::SupportsMultiDrawIndirect();
+		ImGui::Text("Path: %s", native ? "glMultiDrawElementsIndirect" : "glDrawElements*BaseVertex loop");
+		ImGui::Text("Draw calls: %d, CPU submit: %.3f ms", native ? 1 : m_ObjectCount, m_LastSubmitTime);
+		ImGui::Text("Indices: %u x %u bytes", m_IndexBuffer->GetCount(), m_IndexBuffer->GetIndexSize());
+	}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "IndirectBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+namespace test {
+
+	// Several polygon meshes share one vertex and one index buffer, and every
+	// object is one DrawElementsIndirectCommand whose base instance selects its
+	// transform, so the whole scene is a single MultiDrawIndirect.
+	class TestMultiDrawIndirect : public Test
+	{
+	private:
+		struct InstanceData
+		{
+			glm::mat4 Model;
+			glm::vec4 Color;
+		};
+
+		struct MeshRange
+		{
+			unsigned int IndexCount;
+			unsigned int FirstIndex;
+			int BaseVertex;
+		};
+
+		static const int s_MaxObjects = 20000;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<VertexBuffer> m_InstanceBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<IndirectBuffer> m_IndirectBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+
+		std::vector<MeshRange> m_Meshes;
+		std::vector<InstanceData> m_Instances;
+		std::vector<DrawElementsIndirectCommand> m_Commands;
+
+		glm::mat4 m_Proj;
+		float m_Time;
+		int m_ObjectCount;
+		bool m_ForceFallback;
+		float m_LastSubmitTime;
+
+	public:
+		TestMultiDrawIndirect();
+		~TestMultiDrawIndirect();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,225 @@
+#include "TestParallelRecording.h"
+
+#include "ThreadPool.h"
+#include "VertexBufferLayout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	static const glm::vec2 s_WorldSize(960.0f * 4.0f, 540.0f * 4.0f);
+
+	TestParallelRecording::TestParallelRecording()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Camera(0.0f, 0.0f), m_Time(0.0f),
+		  m_ObjectCount(100000), m_Threads((int)ThreadPool::Get().GetThreadCount() + 1),
+		  m_LastRecordTime(0.0f), m_LastRecorded(0), m_UseSIMD(Culling::GetUseSIMD()), m_BatchCulling(true)
+	{
+		m_Shaders.push_back(std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader"));
+		m_Shaders.push_back(std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Grayscale.shader"));
+		for (auto& shader : m_Shaders)
+		{
+			shader->Bind();
+			shader->SetUniform1i("u_Texture", 0);
+		}
+
+		CreateTestTextures(m_Textures, 8, 4);
+
+		const std::vector<std::vector<float>> shapes = {
+			{ 0.0f, 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 1.0f, 0.0f,  1.0f, 1.0f, 1.0f, 1.0f,  0.0f, 1.0f, 0.0f, 1.0f },
+			{ 0.0f, 0.25f, 0.0f, 0.0f,  1.0f, 0.25f, 1.0f, 0.0f,  1.0f, 0.75f, 1.0f, 1.0f,  0.0f, 0.75f, 0.0f, 1.0f },
+			{ 0.0f, 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 1.0f, 0.0f,  0.5f, 1.0f, 0.5f, 1.0f,  0.5f, 1.0f, 0.5f, 1.0f }
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		for (const auto& shape : shapes)
+		{
+			Mesh mesh;
+			mesh.VAO = std::make_unique<VertexArray>();
+			mesh.VBO = std::make_unique<VertexBuffer>(shape.data(), (unsigned int)(shape.size() * sizeof(float)));
+			VertexBufferLayout layout;
+			layout.Push<float>(2);
+			layout.Push<float>(2);
+			mesh.VAO->AddBuffer(*mesh.VBO, layout);
+			mesh.IBO = std::make_unique<IndexBuffer>(indices, 6);
+			m_Meshes.push_back(std::move(mesh));
+		}
+
+		m_WorkerBuffers.resize(ThreadPool::Get().GetThreadCount() + 1);
+		m_WorkerVisible.resize(m_WorkerBuffers.size());
+		GenerateObjects();
+	}
+
+	TestParallelRecording::~TestParallelRecording()
+	{
+	}
+
+	void TestParallelRecording::GenerateObjects()
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> x(0.0f, s_WorldSize.x), y(0.0f, s_WorldSize.y);
+		std::uniform_real_distribution<float> velocity(-40.0f, 40.0f), size(4.0f, 16.0f);
+
+		m_Objects.resize(m_ObjectCount);
+		for (Object& object : m_Objects)
+		{
+			object.Position = { x(rng), y(rng) };
+			object.Velocity = { velocity(rng), velocity(rng) };
+			object.Size = size(rng);
+			object.ShaderIndex = (unsigned char)(rng() % m_Shaders.size());
+			object.TextureIndex = (unsigned char)(rng() % m_Textures.size());
+			object.MeshIndex = (unsigned char)(rng() % m_Meshes.size());
+			object.Layer = (unsigned char)(rng() % 2);
+		}
+
+		m_Bounds.Resize(m_ObjectCount);
+		UpdateBounds();
+	}
+
+	void TestParallelRecording::UpdateBounds()
+	{
+		for (unsigned int i = 0; i < (unsigned int)m_Objects.size(); i++)
+		{
+			const Object& object = m_Objects[i];
+			m_Bounds.Set(i, object.Position, object.Position + glm::vec2(object.Size));
+		}
+	}
+
+	unsigned int TestParallelRecording::RecordCommands(unsigned int threads)
+	{
+		glm::mat4 viewProj = m_Proj * glm::translate(glm::mat4(1.0f), glm::vec3(-m_Camera.x, -m_Camera.y, 0.0f));
+		Frustum frustum(viewProj);
+
+		for (RenderCommandBuffer& buffer : m_WorkerBuffers)
+			buffer.Clear();
+
+		ThreadPool::Get().ParallelFor((unsigned int)m_Objects.size(), threads,
+			[&](unsigned int begin, unsigned int end, unsigned int worker) {
+				RenderCommandBuffer& buffer = m_WorkerBuffers[worker];
+
+				auto getModel = [](const Object& object) {
+					return glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(object.Position.x, object.Position.y, 0.0f)),
+						glm::vec3(object.Size, object.Size, 1.0f));
+				};
+
+				if (!m_BatchCulling)
+				{
+					// The culled Submit tests one object at a time, after its transform is made
+					for (unsigned int i = begin; i < end; i++)
+					{
+						const Object& object = m_Objects[i];
+						const Mesh& mesh = m_Meshes[object.MeshIndex];
+						bool translucent = object.ShaderIndex == 1;
+						buffer.Submit(frustum, glm::vec3(object.Position, 0.0f), glm::vec3(object.Position + glm::vec2(object.Size), 0.0f),
+							*mesh.VAO, *mesh.IBO, *m_Shaders[object.ShaderIndex], m_Textures[object.TextureIndex].get(),
+							viewProj * getModel(object), object.Layer, translucent, (float)i / (float)m_Objects.size());
+					}
+					return;
+				}
+
+				std::vector<unsigned int>& visible = m_WorkerVisible[worker];
+				visible.resize(end - begin);
+
+				// Cull the whole range first so only visible objects get transforms and sort keys
+				unsigned int visibleCount = Culling::CullAABBs2D(frustum, m_Bounds, begin, end, visible.data());
+				for (unsigned int v = 0; v < visibleCount; v++)
+				{
+					unsigned int i = visible[v];
+					const Object& object = m_Objects[i];
+					const Mesh& mesh = m_Meshes[object.MeshIndex];
+					bool translucent = object.ShaderIndex == 1;
+					buffer.Submit(*mesh.VAO, *mesh.IBO, *m_Shaders[object.ShaderIndex], m_Textures[object.TextureIndex].get(),
+						viewProj * getModel(object), object.Layer, translucent, (float)i / (float)m_Objects.size());
+				}
+			});
+
+		unsigned int recorded = 0;
+		for (const RenderCommandBuffer& buffer : m_WorkerBuffers)
+			recorded += buffer.GetCount();
+		return recorded;
+	}
+
+	void TestParallelRecording::RunScalingBenchmark()
+	{
+		const int iterations = 20;
+		unsigned int maxThreads = ThreadPool::Get().GetThreadCount() + 1;
+
+		m_ScalingResults.clear();
+		for (unsigned int threads = 1; threads <= maxThreads; threads++)
+		{
+			std::vector<float> times;
+			for (int i = 0; i < iterations; i++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				RecordCommands(threads);
+				auto end = std::chrono::high_resolution_clock::now();
+				times.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+			}
+
+			// The median is less sensitive to the odd descheduled run
+			std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+			m_ScalingResults.push_back({ threads, times[iterations / 2] });
+		}
+
+		std::cout << "Threads\tRecord (ms)\tSpeedup" << std::endl;
+		for (const ScalingResult& result : m_ScalingResults)
+		{
+			std::cout << result.Threads << "\t" << result.RecordTimeMs << "\t"
+				<< m_ScalingResults[0].RecordTimeMs / result.RecordTimeMs << std::endl;
+		}
+	}
+
+	void TestParallelRecording::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+		m_Camera = SweepCamera(s_WorldSize, m_Time, glm::vec2(0.2f, 0.13f));
+
+		for (Object& object : m_Objects)
+			MoveBouncing(object.Position, object.Velocity, s_WorldSize, deltaTime);
+		UpdateBounds();
+	}
+
+	void TestParallelRecording::OnRender()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		m_LastRecorded = RecordCommands(m_Threads);
+		auto end = std::chrono::high_resolution_clock::now();
+		m_LastRecordTime = std::chrono::duration<float, std::milli>(end - start).count();
+
+		m_Renderer.ResetStats();
+		for (const RenderCommandBuffer& buffer : m_WorkerBuffers)
+			m_Renderer.Submit(buffer);
+		m_Renderer.Flush();
+		m_LastStats = m_Renderer.GetStats();
+	}
+
+	void TestParallelRecording::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Objects", &m_ObjectCount, 1000, 500000))
+			GenerateObjects();
+		ImGui::SliderInt("Threads", &m_Threads, 1, (int)ThreadPool::Get().GetThreadCount() + 1);
+		if (ImGui::Checkbox("SIMD culling", &m_UseSIMD))
+			Culling::SetUseSIMD(m_UseSIMD);
+		ImGui::Checkbox("Cull in batches (off: culled Submit per object)", &m_BatchCulling);
+
+		ImGui::Text("Recorded %u of %d objects in %.3f ms (%s)", m_LastRecorded, m_ObjectCount, m_LastRecordTime, Culling::GetInstructionSet());
+		ImGui::Text("Draw calls: %u, shader binds: %u, texture binds: %u", m_LastStats.DrawCalls, m_LastStats.ShaderBinds, m_LastStats.TextureBinds);
+
+		if (ImGui::Button("Measure scaling"))
+			RunScalingBenchmark();
+
+		for (const ScalingResult& result : m_ScalingResults)
+		{
+			ImGui::Text("%2u threads: %.3f ms (%.2fx)", result.Threads, result.RecordTimeMs,
+				m_ScalingResults[0].RecordTimeMs / result.RecordTimeMs);
+		}
+	}
+
+}
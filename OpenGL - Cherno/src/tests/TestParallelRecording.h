@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+#include "Renderer.h"
+#include "Texture.h"
+
+namespace test {
+
+	// Moves up to a few hundred thousand objects around a world larger than the
+	// window, and records their draw commands (culling, transforms, sort keys) on
+	// the thread pool into one RenderCommandBuffer per worker before a single sorted
+	// Flush. Each worker culls its range against the frustum in SIMD batches first,
+	// or through the culled RenderCommandBuffer::Submit one object at a time.
+	// The scaling benchmark times the recording alone for 1..N threads.
+	class TestParallelRecording : public Test
+	{
+	private:
+		struct Object
+		{
+			glm::vec2 Position;
+			glm::vec2 Velocity;
+			float Size;
+			unsigned char ShaderIndex;
+			unsigned char TextureIndex;
+			unsigned char MeshIndex;
+			unsigned char Layer;
+		};
+
+		struct Mesh
+		{
+			std::unique_ptr<VertexArray> VAO;
+			std::unique_ptr<VertexBuffer> VBO;
+			std::unique_ptr<IndexBuffer> IBO;
+		};
+
+		struct ScalingResult
+		{
+			unsigned int Threads;
+			float RecordTimeMs;
+		};
+
+		Renderer m_Renderer;
+		std::vector<std::unique_ptr<Shader>> m_Shaders;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		std::vector<Mesh> m_Meshes;
+
+		std::vector<Object> m_Objects;
+		AABBList2D m_Bounds;
+		std::vector<RenderCommandBuffer> m_WorkerBuffers;
+		std::vector<std::vector<unsigned int>> m_WorkerVisible;
+
+		glm::mat4 m_Proj;
+		glm::vec2 m_Camera;
+		float m_Time;
+
+		int m_ObjectCount;
+		int m_Threads;
+		float m_LastRecordTime;
+		unsigned int m_LastRecorded;
+		bool m_UseSIMD;
+		bool m_BatchCulling;
+		RenderStats m_LastStats;
+		std::vector<ScalingResult> m_ScalingResults;
+
+		void GenerateObjects();
+		void UpdateBounds();
+		unsigned int RecordCommands(unsigned int threads);
+		void RunScalingBenchmark();
+
+	public:
+		TestParallelRecording();
+		~TestParallelRecording();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,182 @@
+#include "TestRenderQueue.h"
+
+#include "VertexBufferLayout.h"
+#include "VertexFormatCache.h"
+
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestRenderQueue::TestRenderQueue()
+		: m_VertexPool(GL_ARRAY_BUFFER, 4 * sizeof(float), 64 * 1024), m_IndexPool(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short), 64 * 1024),
+		  m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
+		  m_ObjectCount(2000), m_Deferred(true), m_Pooled(false), m_MeshesPooled(false),
+		  m_SharedFormats(false), m_MeshesShared(false), m_LastFormatCount(0)
+	{
+		m_Shaders.push_back(std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader"));
+		m_Shaders.push_back(std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Grayscale.shader"));
+		for (auto& shader : m_Shaders)
+		{
+			shader->Bind();
+			shader->SetUniform1i("u_Texture", 0);
+		}
+
+		CreateTestTextures(m_Textures, 8, 4);
+
+		CreateMeshes(m_Pooled, m_SharedFormats);
+		GenerateObjects();
+	}
+
+	TestRenderQueue::~TestRenderQueue()
+	{
+	}
+
+	void TestRenderQueue::CreateMeshes(bool pooled, bool sharedFormats)
+	{
+		m_Meshes.clear();
+		m_PooledVAO.reset();
+
+		// A square, a wide rectangle and a triangle, all in a unit box
+		const std::vector<std::vector<float>> shapes = {
+			{ 0.0f, 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 1.0f, 0.0f,  1.0f, 1.0f, 1.0f, 1.0f,  0.0f, 1.0f, 0.0f, 1.0f },
+			{ 0.0f, 0.25f, 0.0f, 0.0f,  1.0f, 0.25f, 1.0f, 0.0f,  1.0f, 0.75f, 1.0f, 1.0f,  0.0f, 0.75f, 0.0f, 1.0f },
+			{ 0.0f, 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 1.0f, 0.0f,  0.5f, 1.0f, 0.5f, 1.0f,  0.5f, 1.0f, 0.5f, 1.0f }
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+
+		for (const auto& shape : shapes)
+		{
+			Mesh mesh;
+			if (pooled)
+			{
+				// Every view lands in the first block, so one vertex array covers them all
+				mesh.VBO = std::make_unique<VertexBuffer>(m_VertexPool, shape.data(), (unsigned int)(shape.size() / 4));
+				mesh.IBO = std::make_unique<IndexBuffer>(m_IndexPool, indices, 6, mesh.VBO->GetBaseVertex());
+				if (!m_PooledVAO)
+				{
+					m_PooledVAO = std::make_unique<VertexArray>(sharedFormats);
+					m_PooledVAO->AddBuffer(*mesh.VBO, layout);
+				}
+			}
+			else
+			{
+				mesh.VAO = std::make_unique<VertexArray>(sharedFormats);
+				mesh.VBO = std::make_unique<VertexBuffer>(shape.data(), (unsigned int)(shape.size() * sizeof(float)));
+				mesh.VAO->AddBuffer(*mesh.VBO, layout);
+				mesh.IBO = std::make_unique<IndexBuffer>(indices, 6);
+			}
+			m_Meshes.push_back(std::move(mesh));
+		}
+
+		m_MeshesPooled = pooled;
+		m_MeshesShared = sharedFormats;
+	}
+
+	void TestRenderQueue::GenerateObjects()
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x(0.0f, 940.0f), y(0.0f, 520.0f), depth(0.0f, 1.0f), size(8.0f, 40.0f);
+
+		m_Objects.resize(m_ObjectCount);
+		for (Object& object : m_Objects)
+		{
+			object.Position = { x(rng), y(rng), depth(rng) };
+			object.Size = size(rng);
+			object.ShaderIndex = rng() % m_Shaders.size();
+			object.TextureIndex = rng() % m_Textures.size();
+			object.MeshIndex = rng() % m_Meshes.size();
+			object.Layer = rng() % 2;
+			// The grayscale shader is the translucent one
+			object.Translucent = object.ShaderIndex == 1;
+		}
+	}
+
+	void TestRenderQueue::OnRender()
+	{
+		if (m_Pooled != m_MeshesPooled || m_SharedFormats != m_MeshesShared)
+			CreateMeshes(m_Pooled, m_SharedFormats);
+
+		m_Renderer.ResetStats();
+
+		for (const Object& object : m_Objects)
+		{
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(object.Position.x, object.Position.y, 0.0f)),
+				glm::vec3(object.Size, object.Size, 1.0f));
+			glm::mat4 mvp = m_Proj * model;
+
+			Shader& shader = *m_Shaders[object.ShaderIndex];
+			const Texture& texture = *m_Textures[object.TextureIndex];
+			const Mesh& mesh = m_Meshes[object.MeshIndex];
+			const VertexArray& vao = mesh.VAO ? *mesh.VAO : *m_PooledVAO;
+
+			if (m_Deferred)
+			{
+				m_Renderer.Submit(vao, *mesh.IBO, shader, &texture, mvp, object.Layer, object.Translucent, object.Position.z);
+			}
+			else
+			{
+				texture.Bind();
+				shader.Bind();
+				shader.SetUniformMat4f("u_MVP", mvp);
+				m_Renderer.Draw(vao, *mesh.IBO, shader);
+			}
+		}
+
+		if (m_Deferred)
+		{
+			m_Renderer.Flush();
+			m_LastStats = m_Renderer.GetStats();
+		}
+		else
+		{
+			// Immediate drawing binds everything for every object
+			unsigned int count = (unsigned int)m_Objects.size();
+			m_LastStats = RenderStats();
+			m_LastStats.Submitted = m_LastStats.DrawCalls = count;
+			m_LastStats.ShaderBinds = m_LastStats.VertexArrayBinds = count;
+			m_LastStats.IndexBufferBinds = m_LastStats.TextureBinds = count;
+		}
+
+		m_LastFormatCount = VertexFormatCache::GetStats().Formats;
+		m_LastVertexPoolStats = m_VertexPool.GetStats();
+		m_LastIndexPoolStats = m_IndexPool.GetStats();
+	}
+
+	void TestRenderQueue::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Objects", &m_ObjectCount, 1, 50000))
+			GenerateObjects();
+		ImGui::Checkbox("Sorted submit queue", &m_Deferred);
+		ImGui::Checkbox("Pooled mesh buffers", &m_Pooled);
+		if (VertexFormatCache::IsSupported())
+			ImGui::Checkbox("Shared vertex formats", &m_SharedFormats);
+		else
+			ImGui::TextDisabled("Shared vertex formats need ARB_vertex_attrib_binding");
+		ImGui::Text("Cached vertex formats: %u", m_LastFormatCount);
+
+		ImGui::Text("Draw calls: %u", m_LastStats.DrawCalls);
+		ImGui::Text("Shader binds: %u (%u avoided)", m_LastStats.ShaderBinds, m_LastStats.GetShaderBindsAvoided());
+		ImGui::Text("Vertex array binds: %u (%u avoided)", m_LastStats.VertexArrayBinds, m_LastStats.GetVertexArrayBindsAvoided());
+		ImGui::Text("Index buffer binds: %u (%u avoided)", m_LastStats.IndexBufferBinds, m_LastStats.GetIndexBufferBindsAvoided());
+		ImGui::Text("Texture binds: %u (%u avoided)", m_LastStats.TextureBinds, m_LastStats.GetTextureBindsAvoided());
+
+		const BufferPool::Stats* pools[] = { &m_LastVertexPoolStats, &m_LastIndexPoolStats };
+		const char* poolNames[] = { "Vertex pool", "Index pool" };
+		for (int i = 0; i < 2; i++)
+		{
+			const BufferPool::Stats& stats = *pools[i];
+			ImGui::Text("%s: %u blocks, %u live (%u allocs, %u frees), %zu/%zu KB used, %u free ranges, fragmentation %.2f",
+				poolNames[i], stats.Blocks, stats.Allocations, stats.TotalAllocations, stats.TotalFrees,
+				stats.UsedBytes / 1024, stats.CapacityBytes / 1024, stats.FreeRanges, stats.GetFragmentation());
+		}
+	}
+
+}
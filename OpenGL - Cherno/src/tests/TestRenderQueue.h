@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "BufferPool.h"
+
+namespace test {
+
+	// Scatters objects that interleave shaders, textures and vertex arrays, and
+	// draws them either immediately in submission order or through the sorted
+	// Renderer::Submit queue to compare how many state changes each path makes.
+	// Meshes can also live in shared buffer pools, drawn through one vertex array,
+	// or share their vertex format through VertexFormatCache.
+	class TestRenderQueue : public Test
+	{
+	private:
+		struct Object
+		{
+			glm::vec3 Position;
+			float Size;
+			unsigned int ShaderIndex;
+			unsigned int TextureIndex;
+			unsigned int MeshIndex;
+			unsigned int Layer;
+			bool Translucent;
+		};
+
+		struct Mesh
+		{
+			// Null for pooled meshes, which all use m_PooledVAO. Shared format
+			// vertex arrays are separate objects but one GL vertex array.
+			std::unique_ptr<VertexArray> VAO;
+			std::unique_ptr<VertexBuffer> VBO;
+			std::unique_ptr<IndexBuffer> IBO;
+		};
+
+		Renderer m_Renderer;
+		std::vector<std::unique_ptr<Shader>> m_Shaders;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		// Declared before the meshes, whose views have to go first
+		BufferPool m_VertexPool;
+		BufferPool m_IndexPool;
+		std::unique_ptr<VertexArray> m_PooledVAO;
+		std::vector<Mesh> m_Meshes;
+		std::vector<Object> m_Objects;
+
+		glm::mat4 m_Proj;
+		int m_ObjectCount;
+		bool m_Deferred;
+		bool m_Pooled;
+		bool m_MeshesPooled;
+		bool m_SharedFormats;
+		bool m_MeshesShared;
+		RenderStats m_LastStats;
+		unsigned int m_LastFormatCount;
+		BufferPool::Stats m_LastVertexPoolStats;
+		BufferPool::Stats m_LastIndexPoolStats;
+
+		void CreateMeshes(bool pooled, bool sharedFormats);
+		void GenerateObjects();
+
+	public:
+		TestRenderQueue();
+		~TestRenderQueue();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,278 @@
+#include "TestSpatialIndex.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	static const glm::vec2 s_WorldSize(960.0f * 16.0f, 540.0f * 16.0f);
+
+	template<typename F>
+	static float TimeMs(F&& function)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	TestSpatialIndex::TestSpatialIndex()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Camera(0.0f, 0.0f), m_Time(0.0f),
+		  m_SpriteCount(200000), m_CellSize(64.0f), m_UseGrid(true), m_Hovered(-1),
+		  m_LastVisible(0), m_LastQueryTime(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer2D>();
+
+		CreateTestTextures(m_Textures, 16, 4);
+
+		GenerateSprites();
+	}
+
+	TestSpatialIndex::~TestSpatialIndex()
+	{
+	}
+
+	void TestSpatialIndex::GenerateSprites()
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> x(0.0f, s_WorldSize.x), y(0.0f, s_WorldSize.y);
+		std::uniform_real_distribution<float> velocity(-60.0f, 60.0f), size(4.0f, 24.0f);
+
+		m_Grid = std::make_unique<SpatialGrid>(m_CellSize);
+		m_Sprites.resize(m_SpriteCount);
+		for (unsigned int i = 0; i < (unsigned int)m_Sprites.size(); i++)
+		{
+			Sprite& sprite = m_Sprites[i];
+			sprite.Position = { x(rng), y(rng) };
+			sprite.Velocity = { velocity(rng), velocity(rng) };
+			sprite.Size = size(rng);
+			sprite.TextureIndex = rng() % (unsigned int)m_Textures.size();
+			sprite.Handle = m_Grid->Insert(sprite.Position, sprite.Position + glm::vec2(sprite.Size), i);
+		}
+		m_Hovered = -1;
+	}
+
+	void TestSpatialIndex::RunBenchmark()
+	{
+		const unsigned int queryCount = 1000;
+		const unsigned int pointCount = 100000;
+
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> x(0.0f, s_WorldSize.x), y(0.0f, s_WorldSize.y);
+
+		std::vector<glm::vec2> regions(queryCount), points(pointCount);
+		for (glm::vec2& region : regions)
+			region = { x(rng), y(rng) };
+		for (glm::vec2& point : points)
+			point = { x(rng), y(rng) };
+
+		// Bounds kept in a flat array are what a scan would test without an index, so
+		// for insert and move the scan column is the cost of keeping that array current
+		std::vector<glm::vec2> mins(m_Sprites.size()), maxs(m_Sprites.size());
+		for (unsigned int i = 0; i < (unsigned int)m_Sprites.size(); i++)
+		{
+			mins[i] = m_Sprites[i].Position;
+			maxs[i] = m_Sprites[i].Position + glm::vec2(m_Sprites[i].Size);
+		}
+
+		SpatialGrid grid(m_CellSize);
+		std::vector<SpatialGrid::Handle> handles(m_Sprites.size());
+		std::vector<unsigned int> results;
+		results.reserve(m_Sprites.size());
+		volatile unsigned int sink = 0;
+
+		m_BenchmarkResults.clear();
+
+		float insertTime = TimeMs([&]() {
+			for (unsigned int i = 0; i < (unsigned int)handles.size(); i++)
+				handles[i] = grid.Insert(mins[i], maxs[i], i);
+		});
+		float insertScanTime = TimeMs([&]() {
+			for (unsigned int i = 0; i < (unsigned int)handles.size(); i++)
+			{
+				mins[i] = m_Sprites[i].Position;
+				maxs[i] = m_Sprites[i].Position + glm::vec2(m_Sprites[i].Size);
+			}
+		});
+		m_BenchmarkResults.push_back({ "Insert", (unsigned int)handles.size(), insertTime, insertScanTime });
+
+		// One frame of movement at 60 Hz, the usual case of small steps
+		float moveScanTime = TimeMs([&]() {
+			for (unsigned int i = 0; i < (unsigned int)handles.size(); i++)
+			{
+				glm::vec2 step = m_Sprites[i].Velocity * (1.0f / 60.0f);
+				mins[i] += step;
+				maxs[i] += step;
+			}
+		});
+		float moveTime = TimeMs([&]() {
+			for (unsigned int i = 0; i < (unsigned int)handles.size(); i++)
+				grid.Move(handles[i], mins[i], maxs[i]);
+		});
+		m_BenchmarkResults.push_back({ "Move", (unsigned int)handles.size(), moveTime + moveScanTime, moveScanTime });
+
+		float regionTime = TimeMs([&]() {
+			for (const glm::vec2& region : regions)
+			{
+				results.clear();
+				grid.QueryRegion(region, region + glm::vec2(960.0f, 540.0f), results);
+				sink = sink + (unsigned int)results.size();
+			}
+		});
+		float regionScanTime = TimeMs([&]() {
+			for (const glm::vec2& region : regions)
+			{
+				results.clear();
+				glm::vec2 regionMax = region + glm::vec2(960.0f, 540.0f);
+				for (unsigned int i = 0; i < (unsigned int)mins.size(); i++)
+				{
+					if (maxs[i].x >= region.x && mins[i].x <= regionMax.x && maxs[i].y >= region.y && mins[i].y <= regionMax.y)
+						results.push_back(i);
+				}
+				sink = sink + (unsigned int)results.size();
+			}
+		});
+		m_BenchmarkResults.push_back({ "Region query", queryCount, regionTime, regionScanTime });
+
+		float pointTime = TimeMs([&]() {
+			for (const glm::vec2& point : points)
+			{
+				results.clear();
+				grid.QueryPoint(point, results);
+				sink = sink + (unsigned int)results.size();
+			}
+		});
+		// A full scan per point takes too long at this count, so scan a sample and scale it
+		const unsigned int pointScanSample = 100;
+		float pointScanTime = TimeMs([&]() {
+			for (unsigned int p = 0; p < pointScanSample; p++)
+			{
+				results.clear();
+				const glm::vec2& point = points[p];
+				for (unsigned int i = 0; i < (unsigned int)mins.size(); i++)
+				{
+					if (point.x >= mins[i].x && point.x <= maxs[i].x && point.y >= mins[i].y && point.y <= maxs[i].y)
+						results.push_back(i);
+				}
+				sink = sink + (unsigned int)results.size();
+			}
+		}) * (float)pointCount / (float)pointScanSample;
+		m_BenchmarkResults.push_back({ "Point query", pointCount, pointTime, pointScanTime });
+
+		std::cout << m_Sprites.size() << " sprites, " << m_CellSize << " unit cells" << std::endl;
+		std::cout << "Operation\tCount\tGrid (ms)\tGrid (Mops/s)\tScan (ms)" << std::endl;
+		for (const BenchmarkResult& result : m_BenchmarkResults)
+		{
+			std::cout << result.Name << "\t" << result.Operations << "\t" << result.GridTimeMs << "\t"
+				<< result.Operations / (result.GridTimeMs * 1000.0f) << "\t" << result.ScanTimeMs << std::endl;
+		}
+	}
+
+	void TestSpatialIndex::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+		m_Camera = SweepCamera(s_WorldSize, m_Time, glm::vec2(0.05f, 0.037f));
+
+		for (Sprite& sprite : m_Sprites)
+		{
+			MoveBouncing(sprite.Position, sprite.Velocity, s_WorldSize, deltaTime);
+
+			m_Grid->Move(sprite.Handle, sprite.Position, sprite.Position + glm::vec2(sprite.Size));
+		}
+	}
+
+	void TestSpatialIndex::OnRender()
+	{
+		glm::vec2 viewMin = m_Camera;
+		glm::vec2 viewMax = m_Camera + glm::vec2(960.0f, 540.0f);
+
+		m_Visible.clear();
+		m_LastQueryTime = TimeMs([&]() {
+			if (m_UseGrid)
+			{
+				m_Grid->QueryRegion(viewMin, viewMax, m_Visible);
+				return;
+			}
+
+			for (unsigned int i = 0; i < (unsigned int)m_Sprites.size(); i++)
+			{
+				const Sprite& sprite = m_Sprites[i];
+				if (sprite.Position.x + sprite.Size >= viewMin.x && sprite.Position.x <= viewMax.x &&
+					sprite.Position.y + sprite.Size >= viewMin.y && sprite.Position.y <= viewMax.y)
+					m_Visible.push_back(i);
+			}
+		});
+		m_LastVisible = (unsigned int)m_Visible.size();
+
+		glm::mat4 viewProj = m_Proj * glm::translate(glm::mat4(1.0f), glm::vec3(-m_Camera.x, -m_Camera.y, 0.0f));
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginScene(viewProj);
+		for (unsigned int index : m_Visible)
+		{
+			const Sprite& sprite = m_Sprites[index];
+			glm::vec4 tint = (int)index == m_Hovered ? glm::vec4(1.0f, 1.0f, 0.2f, 1.0f) : glm::vec4(1.0f);
+			m_BatchRenderer->DrawQuad(sprite.Position, glm::vec2(sprite.Size), *m_Textures[sprite.TextureIndex], tint);
+		}
+		m_BatchRenderer->EndScene();
+	}
+
+	void TestSpatialIndex::OnImGuiRender()
+	{
+		// Mouse picking, window coordinates have y pointing down
+		ImGuiIO& io = ImGui::GetIO();
+		m_Hovered = -1;
+		if (!io.WantCaptureMouse && ImGui::IsMousePosValid())
+		{
+			glm::vec2 world(m_Camera.x + io.MousePos.x * 960.0f / io.DisplaySize.x,
+				m_Camera.y + (io.DisplaySize.y - io.MousePos.y) * 540.0f / io.DisplaySize.y);
+
+			std::vector<unsigned int> picked;
+			m_Grid->QueryPoint(world, picked);
+			if (!picked.empty())
+				m_Hovered = (int)picked.back();
+		}
+
+		if (ImGui::SliderInt("Sprites", &m_SpriteCount, 1000, 1000000))
+			GenerateSprites();
+		if (ImGui::SliderFloat("Cell size", &m_CellSize, 16.0f, 512.0f, "%.0f"))
+			GenerateSprites();
+		ImGui::Checkbox("Query grid (off: scan all sprites)", &m_UseGrid);
+
+		ImGui::Text("Visible: %u of %d, found in %.3f ms", m_LastVisible, m_SpriteCount, m_LastQueryTime);
+		ImGui::Text("Occupied cells: %u", m_Grid->GetCellCount());
+		if (m_Hovered >= 0)
+			ImGui::Text("Hovered sprite: %d", m_Hovered);
+		else
+			ImGui::Text("Hovered sprite: none");
+
+		if (ImGui::Button("Run benchmark"))
+			RunBenchmark();
+
+		if (!m_BenchmarkResults.empty() && ImGui::BeginTable("Benchmark", 4, ImGuiTableFlags_Borders))
+		{
+			ImGui::TableSetupColumn("Operation");
+			ImGui::TableSetupColumn("Count");
+			ImGui::TableSetupColumn("Grid (Mops/s)");
+			ImGui::TableSetupColumn("Grid / scan (ms)");
+			ImGui::TableHeadersRow();
+
+			for (const BenchmarkResult& result : m_BenchmarkResults)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::TextUnformatted(result.Name);
+				ImGui::TableNextColumn(); ImGui::Text("%u", result.Operations);
+				ImGui::TableNextColumn(); ImGui::Text("%.2f", result.Operations / (result.GridTimeMs * 1000.0f));
+				ImGui::TableNextColumn(); ImGui::Text("%.3f / %.3f", result.GridTimeMs, result.ScanTimeMs);
+			}
+			ImGui::EndTable();
+		}
+	}
+
+}
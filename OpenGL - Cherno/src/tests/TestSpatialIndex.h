@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BatchRenderer2D.h"
+#include "SpatialGrid.h"
+
+namespace test {
+
+	// Sprites wander around a world much larger than the window while the camera
+	// pans over it. Each frame only the sprites the grid reports near the camera
+	// are drawn, and the sprite under the mouse is picked with a point query. The
+	// benchmark times insert, move and query throughput against a linear scan.
+	class TestSpatialIndex : public Test
+	{
+	private:
+		struct Sprite
+		{
+			glm::vec2 Position;
+			glm::vec2 Velocity;
+			float Size;
+			unsigned int TextureIndex;
+			SpatialGrid::Handle Handle;
+		};
+
+		struct BenchmarkResult
+		{
+			const char* Name;
+			unsigned int Operations;
+			float GridTimeMs;
+			float ScanTimeMs;
+		};
+
+		std::unique_ptr<BatchRenderer2D> m_BatchRenderer;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+
+		std::unique_ptr<SpatialGrid> m_Grid;
+		std::vector<Sprite> m_Sprites;
+		std::vector<unsigned int> m_Visible;
+
+		glm::mat4 m_Proj;
+		glm::vec2 m_Camera;
+		float m_Time;
+
+		int m_SpriteCount;
+		float m_CellSize;
+		bool m_UseGrid;
+		int m_Hovered;
+
+		unsigned int m_LastVisible;
+		float m_LastQueryTime;
+		std::vector<BenchmarkResult> m_BenchmarkResults;
+
+		void GenerateSprites();
+		void RunBenchmark();
+
+	public:
+		TestSpatialIndex();
+		~TestSpatialIndex();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}
@@ -0,0 +1,117 @@
+#include "TestTexture2D.h"
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "provided/imgui/imgui.h"
+
+namespace test {
+
+	TestTexture2D::TestTexture2D()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
+		  m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0))),
+		  m_TranslationA(200, 200, 0), m_Color(0.8f, 0.3f, 0.8f, 1.0f), m_Increment(0.05f),
+		  m_Grid(128.0f), m_Hovered(-1)
+	{
+		float positions[] = {
+			-50.0f, -50.0f, 0.0f, 0.0f,
+			 50.0f, -50.0f, 1.0f, 0.0f,
+			 50.0f,  50.0f, 1.0f, 1.0f,
+			-50.0f,  50.0f, 0.0f, 1.0f,
+
+			 50.0f,  50.0f, 0.0f, 0.0f,
+			150.0f,  50.0f, 1.0f, 0.0f,
+			150.0f, 150.0f, 1.0f, 1.0f,
+			 50.0f, 150.0f, 0.0f, 1.0f,
+		};
+
+		unsigned int indices[] = {
+			0, 1, 2, 2, 3, 0,
+			4, 5, 6, 6, 7, 4
+		};
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VertexBuffer = std::make_unique<VertexBuffer>(positions, 8 * 4 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices, 12);
+
+		m_Shader = std::make_unique<Shader>("OpenGL - Cherno/res/shaders/Basic.shader");
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", m_Color);
+
+		m_Texture = std::make_unique<Texture>("OpenGL - Cherno/res/textures/wood.jpg");
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		glm::vec2 translation(m_TranslationA.x, m_TranslationA.y);
+		m_QuadHandles[0] = m_Grid.Insert(translation + glm::vec2(-50.0f), translation + glm::vec2(50.0f), 0);
+		m_QuadHandles[1] = m_Grid.Insert(translation + glm::vec2(50.0f), translation + glm::vec2(150.0f), 1);
+	}
+
+	TestTexture2D::~TestTexture2D()
+	{
+	}
+
+	void TestTexture2D::UpdateBounds()
+	{
+		glm::vec2 translation(m_TranslationA.x, m_TranslationA.y);
+		m_Grid.Move(m_QuadHandles[0], translation + glm::vec2(-50.0f), translation + glm::vec2(50.0f));
+		m_Grid.Move(m_QuadHandles[1], translation + glm::vec2(50.0f), translation + glm::vec2(150.0f));
+	}
+
+	void TestTexture2D::OnUpdate(float deltaTime)
+	{
+		if (m_Color.r > 1.0f)
+			m_Increment = -0.05f;
+		else if (m_Color.r < 0.0f)
+			m_Increment = 0.05f;
+
+		m_Color.r += m_Increment;
+	}
+
+	void TestTexture2D::OnRender()
+	{
+		Renderer renderer;
+
+		m_Texture->Bind();
+
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", m_Color);
+
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
+			glm::mat4 mvp = m_Proj * m_View * model;
+			m_Shader->SetUniformMat4f("u_MVP", mvp);
+			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+		}
+	}
+
+	void TestTexture2D::OnImGuiRender()
+	{
+		if (ImGui::SliderFloat3("Translation A", &m_TranslationA.x, 0.0f, 500.0f))
+			UpdateBounds();
+
+		// Window coordinates have y pointing down, the projection has it pointing up
+		ImGuiIO& io = ImGui::GetIO();
+		m_Hovered = -1;
+		if (ImGui::IsMousePosValid())
+		{
+			std::vector<unsigned int> picked;
+			m_Grid.QueryPoint(glm::vec2(io.MousePos.x * 960.0f / io.DisplaySize.x,
+				(io.DisplaySize.y - io.MousePos.y) * 540.0f / io.DisplaySize.y), picked);
+			if (!picked.empty())
+				m_Hovered = (int)picked.back();
+		}
+
+		if (m_Hovered >= 0)
+			ImGui::Text("Mouse over quad %d", m_Hovered);
+		else
+			ImGui::Text("Mouse over nothing");
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "SpatialGrid.h"
+
+namespace test {
+
+	class TestTexture2D : public Test
+	{
+	private:
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+
+		glm::mat4 m_Proj, m_View;
+		glm::vec3 m_TranslationA;
+		glm::vec4 m_Color;
+		float m_Increment;
+
+		// The two quads are indexed for mouse picking
+		SpatialGrid m_Grid;
+		SpatialGrid::Handle m_QuadHandles[2];
+		int m_Hovered;
+
+		void UpdateBounds();
+
+	public:
+		TestTexture2D();
+		~TestTexture2D();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+
+}